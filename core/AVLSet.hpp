@@ -9,34 +9,169 @@
 // with a bool parameter able to be passed to the constructor to explicitly
 // turn the balancing on or off (on is default).  If the balancing is off,
 // the AVL tree acts like a binary search tree (e.g., it will become
-// degenerate if elements are added in ascending order).
+// degenerate if elements are added in ascending order).  Elements can also
+// be removed, which rebalances the tree on the way back up in the same way.
 //
 // You are not permitted to use the containers in the C++ Standard Library
 // (such as std::set, std::map, or std::vector) to store the information
 // in your data structure.  Instead, you'll need to implement your AVL tree
 // using your own dynamically-allocated nodes, with pointers connecting them,
 // and with your own balancing algorithms used.
+//
+// The nodes are allocated from a NodePool, so that building a large tree
+// doesn't make one heap allocation per element, and so that destroying it
+// doesn't require recursively deleting every node.
+//
+// How elements are ordered is decided by a comparison policy (see
+// Comparison.hpp), which is the second template parameter.  The policy
+// compares two keys once and says whether the first is less than, equal
+// to, or greater than the second, so each level of a search costs one
+// comparison rather than separate ones for == and <.  Looking an element
+// up never allocates anything, and a key of another type that the policy
+// can compare to an ElementType (such as a std::string_view in an
+// AVLSet<std::string>) can be looked up without building an ElementType.
+//
+// An AVLSet can be iterated, in ascending order, with begin() and end(), or
+// in descending order with rbegin() and rend(), so it can be used in a
+// range-based for loop or with the standard algorithms.  Its iterators
+// follow the nodes' parent pointers rather than keeping a stack.  Its
+// preorder, inorder, and postorder traversals don't recurse: a balanced
+// tree is short enough that they can keep the path from the root in a
+// small fixed-size array, and an unbalanced one, which can be arbitrarily
+// tall, is traversed by following parent pointers instead, so even a
+// degenerate tree can't run them out of stack space.
+//
+// An AVLSet can also be built all at once from a range of elements.  When
+// they're already sorted, as a dictionary usually is, a perfectly balanced
+// tree is built directly in O(n) time, rather than adding the elements one
+// at a time, each of which descends the tree and may rotate on its way back
+// up.  (Unsorted elements are sorted into a temporary std::vector first;
+// the tree itself still stores them in its own nodes.)
+//
+// Each node also keeps the size of the subtree rooted at it, maintained
+// as elements are added and removed and as rotations move nodes around,
+// so that an element's position in ascending order (its rank), the element
+// at a given position, and the number of elements in a range can all be
+// found in O(log n) time, rather than by walking the tree inorder.
+//
+// Finding where a key belongs in ascending order is also what lowerBound()
+// and upperBound() do, and range() and forEachInRange() start there and
+// walk forward only through the elements in a range, such as all of the
+// words with a given prefix, rather than through the whole tree.
+//
+// Once a set has been built and will only be looked up in from then on,
+// freeze() copies its elements into a FrozenAVLSet (see FrozenAVLSet.hpp),
+// which keeps them in one array, laid out so that lookups don't follow
+// pointers and miss the cache far less often.
 
 #ifndef AVLSET_HPP
 #define AVLSET_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Comparison.hpp"
+#include "FrozenAVLSet.hpp"
+#include "NodePool.hpp"
 #include "Set.hpp"
 
 using namespace std;
 
-template <typename ElementType>
+
+
+namespace impl_
+{
+    // A Key can be looked up in an AVLSet<ElementType, Comparison> without
+    // converting it to an ElementType when the comparison policy can compare
+    // the two (e.g., std::string_view and std::string).
+    template <typename ElementType, typename Comparison, typename Key, typename = void>
+    struct AVLSet__isComparable : std::false_type
+    {
+    };
+
+    template <typename ElementType, typename Comparison, typename Key>
+    struct AVLSet__isComparable<ElementType, Comparison, Key, std::void_t<
+        decltype(Comparison::compare(std::declval<const Key&>(), std::declval<const ElementType&>()))>>
+        : std::true_type
+    {
+    };
+
+
+    template <typename ElementType, typename Comparison, typename Key>
+    using AVLSet__enableHeterogeneous = std::enable_if_t<
+        AVLSet__isComparable<ElementType, Comparison, Key>::value
+        && !std::is_same<Key, ElementType>::value>;
+}
+
+template <typename ElementType, typename Comparison = ThreeWayComparison>
 class AVLSet : public Set<ElementType>
 {
+private:
+    struct AVLTreeNode;
+
 public:
     // A VisitFunction is a function that takes a reference to a const
     // ElementType and returns no value.
     using VisitFunction = std::function<void(const ElementType&)>;
 
+    // An Iterator visits the elements of an AVLSet in ascending order, or
+    // in descending order when it's decremented.  Elements can't be changed
+    // through an Iterator, since that could break the ordering of the tree.
+    // Adding or removing elements invalidates every Iterator.
+    class Iterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = ElementType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ElementType*;
+        using reference = const ElementType&;
+
+        // Initializes an Iterator that refers to no element.
+        Iterator() noexcept;
+
+        reference operator*() const noexcept;
+        pointer operator->() const noexcept;
+
+        Iterator& operator++() noexcept;
+        Iterator operator++(int) noexcept;
+
+        Iterator& operator--() noexcept;
+        Iterator operator--(int) noexcept;
+
+        bool operator==(const Iterator& other) const noexcept;
+        bool operator!=(const Iterator& other) const noexcept;
+
+    private:
+        friend class AVLSet;
+        Iterator(const AVLSet* set, const AVLTreeNode* node) noexcept;
+
+        // The set is only needed to step back from the end, which refers
+        // to no node, to the largest element.
+        const AVLSet* set;
+        const AVLTreeNode* node;
+    };
+
+    using ReverseIterator = std::reverse_iterator<Iterator>;
+
 public:
     // Initializes an AVLSet to be empty, with or without balancing.
     explicit AVLSet(bool shouldBalance = true);
 
+    // Initializes an AVLSet to contain the elements in the range [first,
+    // last).  If the range can be traversed more than once and is already
+    // in ascending order with no duplicates, such as a sorted dictionary,
+    // the tree is built directly in O(n) time, as assignSorted() does.
+    // Otherwise, the elements are copied, sorted, and stripped of
+    // duplicates first, which takes O(n log n) time.
+    template <typename InputIterator>
+    AVLSet(InputIterator first, InputIterator last, bool shouldBalance = true);
+
     // Cleans up the AVLSet so that it leaks no memory.
     virtual ~AVLSet() noexcept;
 
@@ -54,6 +189,16 @@ public:
     AVLSet& operator=(AVLSet&& s) noexcept;
 
 
+    // assignSorted() replaces the elements of the set with the ones in the
+    // range [first, last), which must be in strictly ascending order, as
+    // decided by the comparison policy; if they aren't, the set will not
+    // find its elements reliably.  Rather than adding the elements one at
+    // a time, it builds a perfectly balanced tree directly, with no
+    // comparisons or rotations, in O(n) time.
+    template <typename ForwardIterator>
+    void assignSorted(ForwardIterator first, ForwardIterator last);
+
+
     // isImplemented() should be modified to return true if you've
     // decided to implement an AVLSet, false otherwise.
     virtual bool isImplemented() const noexcept override;
@@ -71,31 +216,140 @@ public:
     virtual bool contains(const ElementType& element) const override;
 
 
+    // contains() can also look up a key of some other type that the
+    // comparison policy can compare to an ElementType, such as a
+    // std::string_view in an AVLSet<std::string>, without building an
+    // ElementType first.
+    template <typename Key, typename = impl_::AVLSet__enableHeterogeneous<ElementType, Comparison, Key>>
+    bool contains(const Key& key) const;
+
+
+    // remove() removes an element from the set.  If the element isn't in
+    // the set, this function has no effect.  This function always runs in
+    // O(log n) time when there are n elements in the AVL tree.
+    void remove(const ElementType& element);
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const noexcept override;
 
 
+    // begin() returns an Iterator referring to the smallest element, and
+    // end() returns one referring to the position just after the largest.
+    // Walking from begin() to end() takes O(n) time altogether, though a
+    // single step can take O(log n).
+    Iterator begin() const noexcept;
+    Iterator end() const noexcept;
+
+
+    // rbegin() and rend() are like begin() and end(), but they visit the
+    // elements in descending order.
+    ReverseIterator rbegin() const noexcept;
+    ReverseIterator rend() const noexcept;
+
+
+    // lowerBound() returns an Iterator referring to the smallest element
+    // that is not less than the given key, and upperBound() returns one
+    // referring to the smallest element that is greater than it; either
+    // returns end() if there's no such element.  The key can be an
+    // ElementType or anything else the comparison policy can compare to
+    // one.  These functions always run in O(log n) time when the tree is
+    // balanced.
+    template <typename Key>
+    Iterator lowerBound(const Key& key) const;
+
+    template <typename Key>
+    Iterator upperBound(const Key& key) const;
+
+
+    // range() returns the pair of Iterators that refer to the elements e
+    // such that lo <= e <= hi, in ascending order: the first refers to the
+    // smallest of them and the second to the position just after the
+    // largest.  (If hi is less than lo, the two are equal.)
+    template <typename LowKey, typename HighKey>
+    std::pair<Iterator, Iterator> range(const LowKey& lo, const HighKey& hi) const;
+
+
+    // forEachInRange() calls the given "visit" function for each element e
+    // such that lo <= e <= hi, in ascending order.  Only the nodes on the
+    // path to lo and the k nodes in the range are visited, so it runs in
+    // O(log n + k) time when the tree is balanced.
+    template <typename LowKey, typename HighKey, typename Visit>
+    void forEachInRange(const LowKey& lo, const HighKey& hi, Visit&& visit) const;
+
+
+    // unionWith() adds every element of the other set to this one,
+    // intersectWith() removes every element that isn't also in the other
+    // set, and differenceWith() removes every element that is.  Rather
+    // than adding or removing the elements one at a time, they split this
+    // tree around the other's root and join the pieces back together, so
+    // that with m elements in the smaller set and n in the larger, they do
+    // O(m log(n/m + 1)) work.  The two halves of each split are handled
+    // independently, so when threads is more than 1, they are handled on
+    // separate threads, up to that many at once; the comparison policy
+    // must then be safe to call concurrently.  When either set is not
+    // being balanced, the balance factors that joining relies on aren't
+    // kept, so the elements are added or removed one at a time instead.
+    void unionWith(const AVLSet& other, unsigned int threads = 1);
+    void intersectWith(const AVLSet& other, unsigned int threads = 1);
+    void differenceWith(const AVLSet& other, unsigned int threads = 1);
+
+
+    // freeze() returns a FrozenAVLSet containing a copy of each of the
+    // elements in the set, which is unaffected by later changes to this
+    // one.  It takes O(n) time, since the elements are already in order.
+    FrozenAVLSet<ElementType, Comparison> freeze() const;
+
+
     // height() returns the height of the AVL tree.  Note that, by definition,
     // the height of an empty tree is -1.
     int height() const;
 
 
+    // rank() returns the number of elements in the set that are less than
+    // the given key, which is the position the key has (or would have) in
+    // ascending order.  The key can be an ElementType or anything else the
+    // comparison policy can compare to one.  This function always runs in
+    // O(log n) time when the tree is balanced.
+    template <typename Key>
+    unsigned int rank(const Key& key) const;
+
+
+    // select() returns the element at the given position in ascending
+    // order, counting from 0, so that select(rank(e)) is e for every
+    // element e.  The position must be less than size().  This function
+    // always runs in O(log n) time when the tree is balanced.
+    const ElementType& select(unsigned int index) const;
+
+
+    // countInRange() returns the number of elements e in the set such that
+    // lo <= e <= hi, or 0 if hi is less than lo.  This function always runs
+    // in O(log n) time when the tree is balanced.
+    template <typename LowKey, typename HighKey>
+    unsigned int countInRange(const LowKey& lo, const HighKey& hi) const;
+
+
     // preorder() calls the given "visit" function for each of the elements
     // in the set, in the order determined by a preorder traversal of the AVL
-    // tree.
-    void preorder(VisitFunction visit) const;
+    // tree.  The "visit" function can be anything that can be called with a
+    // reference to a const ElementType, such as a lambda, a function object,
+    // or a VisitFunction; anything but a VisitFunction can be inlined.
+    template <typename Visit>
+    void preorder(Visit&& visit) const;
 
 
     // inorder() calls the given "visit" function for each of the elements
     // in the set, in the order determined by an inorder traversal of the AVL
     // tree.
-    void inorder(VisitFunction visit) const;
+    template <typename Visit>
+    void inorder(Visit&& visit) const;
 
 
     // postorder() calls the given "visit" function for each of the elements
     // in the set, in the order determined by a postorder traversal of the AVL
     // tree.
-    void postorder(VisitFunction visit) const;
+    template <typename Visit>
+    void postorder(Visit&& visit) const;
 
 
 private:
@@ -107,50 +361,179 @@ private:
         AVLTreeNode *right = nullptr;
         AVLTreeNode *parent = nullptr;
         char balanceFactor='=';
+
+        // The number of nodes in the subtree rooted here, including this
+        // one, which is what makes rank() and select() O(log n).
+        unsigned int size = 1;
         AVLTreeNode(){};
         AVLTreeNode(const ElementType& element)
         {
             key = element;
 
         }
+        AVLTreeNode(ElementType&& element)
+            : key{std::move(element)}
+        {
+        }
 
 
 
 
     };
 
+    // No AVL tree with fewer than 2^32 nodes is 48 levels tall, so this
+    // many entries are always enough to hold a path from the root when the
+    // tree is being balanced.
+    static constexpr unsigned int MAX_BALANCED_HEIGHT = 64;
+
     AVLTreeNode *root;
     int elementNumber;
     bool balance;
-
-    void restoreAVL(AVLTreeNode *ancestor, AVLTreeNode *newNode);
-
-    void adjustBalanceFactors(AVLTreeNode *end, AVLTreeNode *start);
+    NodePool<AVLTreeNode> nodes;
+
+    // restoreAVL() walks up from a newly-added node, updating balance
+    // factors until a subtree's height stops changing, and performs the
+    // single or double rotation needed at the first node that has become
+    // unbalanced.
+    void restoreAVL(AVLTreeNode *newNode);
+
+    // restoreAVLAfterRemove() walks up from the parent of a removed node,
+    // whose left or right subtree has just become shorter, rotating where
+    // a subtree has become unbalanced, until a subtree's height stops
+    // changing.  Unlike adding, removing can require a rotation at every
+    // level on the way up.
+    void restoreAVLAfterRemove(AVLTreeNode *parent, bool leftShrank);
+
+    // Returns the node whose element is equivalent to the given key, or
+    // nullptr if there isn't one, comparing the key once per level.
+    template <typename Key>
+    AVLTreeNode* find(const Key& key) const;
+
+    // countLess() returns the number of elements less than the given key,
+    // or, if orEqual is true, less than or equivalent to it.
+    template <typename Key>
+    unsigned int countLess(const Key& key, bool orEqual) const;
+
+    // bound() returns the smallest node whose element is greater than the
+    // given key, or, if orEqual is true, not less than it, or nullptr if
+    // there isn't one.
+    template <typename Key>
+    const AVLTreeNode* bound(const Key& key, bool orEqual) const;
+
+    // adjustSizes() adds the given change to the subtree size of the given
+    // node and of each of its ancestors.
+    static void adjustSizes(AVLTreeNode* node, int change) noexcept;
+
+    static unsigned int sizeOf(const AVLTreeNode* node) noexcept;
 
     void rotateLeft(AVLTreeNode *n);
 
     void rotateRight(AVLTreeNode *n);
 
-    void adjustLeftRight(AVLTreeNode *end, AVLTreeNode *start);
-
-    void adjustRightLeft(AVLTreeNode *end, AVLTreeNode *start);
-
     int findHeight(AVLTreeNode* aNode) const ;
 
     bool checkContain(AVLTreeNode *root, const ElementType n) const;
 
     void ClearTree(AVLTreeNode *n);
 
-    void copy(AVLTreeNode * new_root, AVLTreeNode * root);
-
-    bool isIn(const ElementType& element, AVLTreeNode* current) const;
-
-    void inorder_traverse(AVLTreeNode* node,VisitFunction visit) const;
+    AVLTreeNode* copy(const AVLTreeNode* src, AVLTreeNode* parent);
 
-    void preorder_traverse(AVLTreeNode* node,VisitFunction visit) const;
+    // buildSorted() builds a perfectly balanced subtree from the next
+    // "count" elements, which are in ascending order, leaving "next" just
+    // past them.  It returns the subtree's root and stores its height.
+    template <typename ForwardIterator>
+    AVLTreeNode* buildSorted(ForwardIterator& next, unsigned int count, AVLTreeNode* parent, int& height);
 
+    bool isIn(const ElementType& element, AVLTreeNode* current) const;
 
-    void postorder_traverse(AVLTreeNode* node,VisitFunction visit) const;
+    // The smallest and largest nodes in the subtree rooted at the given
+    // node, which must not be nullptr.
+    static const AVLTreeNode* leftmost(const AVLTreeNode* node) noexcept;
+    static const AVLTreeNode* rightmost(const AVLTreeNode* node) noexcept;
+
+    // The node that comes after or before the given one in an inorder
+    // traversal, or nullptr if there isn't one.
+    static const AVLTreeNode* successor(const AVLTreeNode* node) noexcept;
+    static const AVLTreeNode* predecessor(const AVLTreeNode* node) noexcept;
+
+    // The first node in a postorder traversal of the subtree rooted at
+    // the given node, which must not be nullptr.
+    static const AVLTreeNode* firstInPostorder(const AVLTreeNode* node) noexcept;
+
+    // Splitting and joining work on detached subtrees and keep track of
+    // their heights as they go, since the balance factors only give the
+    // difference between the heights of a node's subtrees.
+
+    // Below this many elements in the two trees together, the two halves
+    // of a set operation aren't worth starting another thread for.
+    static constexpr unsigned int PARALLEL_CUTOFF = 16384;
+
+    // The height of a subtree, found by following balance factors down
+    // its taller side, and the heights of a node's two subtrees, given
+    // the node's height.
+    static int heightOf(const AVLTreeNode* node) noexcept;
+    static int leftHeight(const AVLTreeNode* node, int height) noexcept;
+    static int rightHeight(const AVLTreeNode* node, int height) noexcept;
+
+    // link() makes the given subtrees, whose heights differ by at most
+    // one, the children of a node, fixing its size and balance factor,
+    // and returns its new height.
+    static int link(AVLTreeNode* node, AVLTreeNode* left, int lh, AVLTreeNode* right, int rh) noexcept;
+
+    // join() returns a balanced tree containing the left subtree, then the
+    // middle node, then the right subtree, whose heights can differ by any
+    // amount, storing its height.  join2() does the same with no middle.
+    static AVLTreeNode* join(
+        AVLTreeNode* left, int lh, AVLTreeNode* middle, AVLTreeNode* right, int rh, int& height) noexcept;
+    static AVLTreeNode* joinRight(
+        AVLTreeNode* left, int lh, AVLTreeNode* middle, AVLTreeNode* right, int rh, int& height) noexcept;
+    static AVLTreeNode* joinLeft(
+        AVLTreeNode* left, int lh, AVLTreeNode* middle, AVLTreeNode* right, int rh, int& height) noexcept;
+    static AVLTreeNode* join2(AVLTreeNode* left, int lh, AVLTreeNode* right, int rh, int& height) noexcept;
+
+    // splitLast() detaches the largest node of a non-empty subtree and
+    // returns it, storing what's left of the subtree and its height.
+    static AVLTreeNode* splitLast(AVLTreeNode* node, int height, AVLTreeNode*& rest, int& restHeight) noexcept;
+
+    // split() takes a subtree apart into the elements less than the key
+    // and the ones greater than it, storing both and their heights, and
+    // returns the detached node whose element is equivalent to the key,
+    // or nullptr if there isn't one.
+    static AVLTreeNode* split(
+        AVLTreeNode* node, int height, const ElementType& key,
+        AVLTreeNode*& less, int& lessHeight, AVLTreeNode*& greater, int& greaterHeight);
+
+    // The recursive halves of unionWith(), intersectWith() and
+    // differenceWith().  Each returns the resulting subtree and stores its
+    // height.  The nodes they leave out, each of which is the root of a
+    // detached subtree, are added to "garbage", so that they can be
+    // destroyed once no other threads are running, since the NodePool
+    // isn't safe to use from more than one at a time.
+    static AVLTreeNode* uniteTrees(
+        AVLTreeNode* t1, int h1, AVLTreeNode* t2, int h2, int& height,
+        unsigned int threads, std::vector<AVLTreeNode*>& garbage);
+    static AVLTreeNode* intersectTrees(
+        AVLTreeNode* t1, int h1, const AVLTreeNode* t2, int& height,
+        unsigned int threads, std::vector<AVLTreeNode*>& garbage);
+    static AVLTreeNode* subtractTrees(
+        AVLTreeNode* t1, int h1, const AVLTreeNode* t2, int& height,
+        unsigned int threads, std::vector<AVLTreeNode*>& garbage);
+
+    // fork() calls left and right, each with a number of threads and a
+    // list of garbage, on separate threads if more than one is available
+    // and there are at least PARALLEL_CUTOFF elements involved, or one
+    // after the other otherwise.
+    template <typename Left, typename Right>
+    static void fork(
+        unsigned int threads, unsigned int work, std::vector<AVLTreeNode*>& garbage,
+        Left&& left, Right&& right);
+
+    // setRoot() makes the given subtree the whole tree.
+    void setRoot(AVLTreeNode* node) noexcept;
+
+    // destroySubtrees() gives every node in each of the given subtrees
+    // back to the NodePool.
+    void destroySubtrees(const std::vector<AVLTreeNode*>& subtrees) noexcept;
 
 
 
@@ -161,8 +544,8 @@ private:
 
 
 
-template <typename ElementType>
-AVLSet<ElementType>::AVLSet(bool shouldBalance)
+template <typename ElementType, typename Comparison>
+AVLSet<ElementType, Comparison>::AVLSet(bool shouldBalance)
 {
     root = nullptr;
     elementNumber =0;
@@ -170,122 +553,261 @@ AVLSet<ElementType>::AVLSet(bool shouldBalance)
 }
 
 
-template <typename ElementType>
-AVLSet<ElementType>::~AVLSet() noexcept
+template <typename ElementType, typename Comparison>
+AVLSet<ElementType, Comparison>::~AVLSet() noexcept
 {
     ClearTree(root);
 }
 
-template <typename ElementType>
-void AVLSet<ElementType>::ClearTree(AVLTreeNode *n)
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::ClearTree(AVLTreeNode *n)
 {
-    if(n != nullptr)
+    if (NodePool<AVLTreeNode>::NEEDS_DISCARD)
     {
-        ClearTree(n->left);   // Recursively clear the left sub-tree
-        ClearTree(n->right);   // Recursively clear the right sub-tree
-        delete n;         // Delete this node
+        // Rotating each left child up until there isn't one leaves every
+        // node with nothing to its left, so the tree can be torn down in
+        // order without recursion or a stack.
+        while (n != nullptr)
+        {
+            if (n->left != nullptr)
+            {
+                AVLTreeNode *l = n->left;
+                n->left = l->right;
+                l->right = n;
+                n = l;
+            }
+            else
+            {
+                AVLTreeNode *next = n->right;
+                nodes.discard(n);
+                n = next;
+            }
+        }
     }
+
+    nodes.release();
 }
 
-template <typename ElementType>
-AVLSet<ElementType>::AVLSet(const AVLSet& s)
+template <typename ElementType, typename Comparison>
+AVLSet<ElementType, Comparison>::AVLSet(const AVLSet& s)
 {
-    if (s.root) {
-        this->root = new AVLTreeNode;
-        copy(this->root, s.root);
-    } else{
-        this->root = nullptr;
-    }
+    root = copy(s.root, nullptr);
+    elementNumber = s.elementNumber;
+    balance = s.balance;
 }
 
-template <typename ElementType>
-void AVLSet<ElementType>::copy(AVLTreeNode * dst, AVLTreeNode * src)
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::copy(const AVLTreeNode* src, AVLTreeNode* parent)
 {
-    if (dst && src)
+    if (src == nullptr)
+        return nullptr;
+
+    auto copyNode = [this](const AVLTreeNode* from, AVLTreeNode* to)
+    {
+        AVLTreeNode *node = nodes.create(from->key);
+        node->parent = to;
+        node->balanceFactor = from->balanceFactor;
+        node->size = from->size;
+        return node;
+    };
+
+    // The copy is built in the same order a preorder traversal would visit
+    // the nodes, following parent pointers back up in both trees instead
+    // of recursing, so that an unbalanced tree can't overflow the stack.
+    // A child of "s" whose copy hasn't been made yet is one that hasn't
+    // been visited.
+    AVLTreeNode *dst = copyNode(src, parent);
+    const AVLTreeNode *s = src;
+    AVLTreeNode *d = dst;
+
+    while (true)
     {
-        dst->key = src->key;
-        if (src->left) {
-            dst->left = new AVLTreeNode;
-            copy(dst->left, src->left);
+        if (s->left != nullptr && d->left == nullptr)
+        {
+            d->left = copyNode(s->left, d);
+            s = s->left;
+            d = d->left;
+        }
+        else if (s->right != nullptr && d->right == nullptr)
+        {
+            d->right = copyNode(s->right, d);
+            s = s->right;
+            d = d->right;
+        }
+        else if (s == src)
+        {
+            return dst;
         }
-        if (src->right) {
-            dst->right = new AVLTreeNode;
-            copy(dst->right, src->right);
+        else
+        {
+            s = s->parent;
+            d = d->parent;
         }
     }
-    return;
 }
 
 
-template <typename ElementType>
-AVLSet<ElementType>::AVLSet(AVLSet&& s) noexcept
+template <typename ElementType, typename Comparison>
+AVLSet<ElementType, Comparison>::AVLSet(AVLSet&& s) noexcept
+    : nodes{std::move(s.nodes)}
 {
-    this->root = s.root;
+    root = s.root;
+    elementNumber = s.elementNumber;
+    balance = s.balance;
+
     s.root = nullptr;
+    s.elementNumber = 0;
 }
 
-template <typename ElementType>
-AVLSet<ElementType>& AVLSet<ElementType>::operator=(const AVLSet& s)
+template <typename ElementType, typename Comparison>
+AVLSet<ElementType, Comparison>& AVLSet<ElementType, Comparison>::operator=(const AVLSet& s)
 {
-    ClearTree(this->root);
-    if (s.root) {
-        this->root = new AVLTreeNode;
-        copy(this->root, s.root);
-    } else{
-        this->root = nullptr;
+    if (this != &s)
+    {
+        ClearTree(root);
+        root = copy(s.root, nullptr);
+        elementNumber = s.elementNumber;
+        balance = s.balance;
     }
     return *this;
 }
  
 
-template <typename ElementType>
-AVLSet<ElementType>& AVLSet<ElementType>::operator=(AVLSet&& s) noexcept
+template <typename ElementType, typename Comparison>
+AVLSet<ElementType, Comparison>& AVLSet<ElementType, Comparison>::operator=(AVLSet&& s) noexcept
 {
-   AVLTreeNode *copy = this->root;
-   root = s.root;
-   s.root = copy;
+   std::swap(root, s.root);
+   std::swap(elementNumber, s.elementNumber);
+   std::swap(balance, s.balance);
+   std::swap(nodes, s.nodes);
    return *this;
 }
 
 
-template <typename ElementType>
-bool AVLSet<ElementType>::isImplemented() const noexcept
+template <typename ElementType, typename Comparison>
+template <typename InputIterator>
+AVLSet<ElementType, Comparison>::AVLSet(InputIterator first, InputIterator last, bool shouldBalance)
+    : AVLSet{shouldBalance}
 {
+    using Category = typename std::iterator_traits<InputIterator>::iterator_category;
 
-    return true;
+    // Checking the order takes one pass over the range, so it's only
+    // possible when the range can be traversed again afterward.
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value)
+    {
+        auto outOfOrder = std::adjacent_find(first, last,
+            [](const ElementType& a, const ElementType& b) { return Comparison::compare(a, b) >= 0; });
+
+        if (outOfOrder == last)
+        {
+            assignSorted(first, last);
+            return;
+        }
+    }
+
+    std::vector<ElementType> sorted{first, last};
+    std::sort(sorted.begin(), sorted.end(),
+        [](const ElementType& a, const ElementType& b) { return Comparison::compare(a, b) < 0; });
+
+    auto unique = std::unique(sorted.begin(), sorted.end(),
+        [](const ElementType& a, const ElementType& b) { return Comparison::compare(a, b) == 0; });
+
+    assignSorted(std::make_move_iterator(sorted.begin()), std::make_move_iterator(unique));
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename ForwardIterator>
+void AVLSet<ElementType, Comparison>::assignSorted(ForwardIterator first, ForwardIterator last)
+{
+    ClearTree(root);
+
+    unsigned int count = static_cast<unsigned int>(std::distance(first, last));
+    int height;
+    root = buildSorted(first, count, nullptr, height);
+    elementNumber = count;
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename ForwardIterator>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::buildSorted(
+    ForwardIterator& next, unsigned int count, AVLTreeNode* parent, int& height)
+{
+    if (count == 0)
+    {
+        height = -1;
+        return nullptr;
+    }
+
+    // The middle element becomes the root, so the two subtrees' sizes
+    // differ by at most one, and so do their heights.  The recursion is
+    // only as deep as the tree is tall.
+    unsigned int leftCount = (count - 1) / 2;
+
+    int leftHeight;
+    AVLTreeNode *left = buildSorted(next, leftCount, nullptr, leftHeight);
+
+    AVLTreeNode *n = nodes.create(*next);
+    ++next;
+
+    int rightHeight;
+    AVLTreeNode *right = buildSorted(next, count - 1 - leftCount, n, rightHeight);
+
+    n->parent = parent;
+    n->left = left;
+    n->right = right;
+    n->size = count;
+
+    if (left != nullptr)
+        left->parent = n;
+
+    if (leftHeight > rightHeight)
+        n->balanceFactor = 'L';
+    else if (rightHeight > leftHeight)
+        n->balanceFactor = 'R';
+    else
+        n->balanceFactor = '=';
+
+    height = std::max(leftHeight, rightHeight) + 1;
+    return n;
 }
 
 
-template <typename ElementType>
-void AVLSet<ElementType>::add(const ElementType& element)
+template <typename ElementType, typename Comparison>
+bool AVLSet<ElementType, Comparison>::isImplemented() const noexcept
 {
 
-    AVLTreeNode * newNode = new AVLTreeNode(element);
+    return true;
+}
+
+
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::add(const ElementType& element)
+{
 
-    newNode->balanceFactor = '=';
-    AVLTreeNode *temp, *back, *ancestor;
+    AVLTreeNode *temp, *back;
     temp=root;
     back = nullptr;
-    ancestor = nullptr;
     if(root == nullptr)
     {
-        root = newNode;
+        root = nodes.create(element);
         elementNumber=elementNumber+1;
         return;
     }
+    int order = 0;
     while(temp != nullptr) // Loop till temp falls out of the tree
     {
         back = temp;
-        if(temp->balanceFactor != '=')
-            ancestor = temp;
+        order = Comparison::compare(element, temp->key);
 
-        if(newNode->key == temp->key)
+        if(order == 0)
         {
             return;
         }
 
 
-        if(newNode->key < temp->key)
+        if(order < 0)
         {
             temp = temp->left;
         }
@@ -298,8 +820,10 @@ void AVLSet<ElementType>::add(const ElementType& element)
 
     }
 
+    // The node is only created once we know the element isn't a duplicate.
+    AVLTreeNode * newNode = nodes.create(element);
     newNode->parent = back;   // Set parent
-    if(newNode->key < back->key)  // Insert at left
+    if(order < 0)  // Insert at left
     {
         back->left = newNode;
         elementNumber=elementNumber+1;
@@ -309,87 +833,98 @@ void AVLSet<ElementType>::add(const ElementType& element)
         back->right = newNode;
         elementNumber=elementNumber+1;
     }
+
+    // Sizes have to be right before rotating, since rotations recompute
+    // the sizes of the nodes they move from their children's.
+    adjustSizes(back, 1);
+
     if(this->balance)
-        restoreAVL(ancestor, newNode);
+        restoreAVL(newNode);
     else
         return;
 
 
 }
 
-template <typename ElementType>
-void AVLSet<ElementType>::restoreAVL(AVLTreeNode *ancestor, AVLTreeNode *newNode)
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::restoreAVL(AVLTreeNode *newNode)
 {
-    if(ancestor == nullptr)
-    {
-        if(newNode->key < this->root->key)   // newNode inserted to left of root
-            root->balanceFactor = 'L';
-        else
-            root->balanceFactor = 'R';   // newNode inserted to right of root
-        adjustBalanceFactors(this->root, newNode);
-    }
-
-
-    else if(((ancestor->balanceFactor == 'L') && (newNode->key > ancestor->key)) ||
-            ((ancestor->balanceFactor == 'R') && (newNode->key < ancestor->key)))
-    {
-        ancestor->balanceFactor = '=';
-        adjustBalanceFactors(ancestor, newNode);
-    }
-
-    else if((ancestor->balanceFactor == 'R') && (newNode->key > ancestor->right->key))
-    {
-        ancestor->balanceFactor = '='; // Reset ancestor's balanceFactor
-        rotateLeft(ancestor);       // Do single left rotation about ancestor
-        adjustBalanceFactors(ancestor->parent, newNode);
-    }
-
-
-    else if((ancestor->balanceFactor == 'L') && (newNode->key < ancestor->left->key))
-    {
-        ancestor->balanceFactor = '='; // Reset ancestor's balanceFactor
-        rotateRight(ancestor);       // Do single right rotation about ancestor
-        adjustBalanceFactors(ancestor->parent, newNode);
-    }
-
+    AVLTreeNode *child = newNode;
+    AVLTreeNode *ancestor = newNode->parent;
 
-    else if((ancestor->balanceFactor == 'L') && (newNode->key > ancestor->left->key))
+    while(ancestor != nullptr)
     {
-        rotateLeft(ancestor->left);
-        rotateRight(ancestor);
-        adjustLeftRight(ancestor, newNode);
-    }
-
-    else
-    {
-        rotateRight(ancestor->right);
-        rotateLeft(ancestor);
-        adjustRightLeft(ancestor, newNode);
+        if(child == ancestor->left)
+        {
+            if(ancestor->balanceFactor == 'R')      // Now evenly balanced
+            {
+                ancestor->balanceFactor = '=';
+                return;
+            }
+            if(ancestor->balanceFactor == '=')      // Taller, keep going up
+            {
+                ancestor->balanceFactor = 'L';
+                child = ancestor;
+                ancestor = ancestor->parent;
+                continue;
+            }
+
+            if(child->balanceFactor == 'L')         // Left-left: single rotation
+            {
+                rotateRight(ancestor);
+                ancestor->balanceFactor = '=';
+                child->balanceFactor = '=';
+            }
+            else                                    // Left-right: double rotation
+            {
+                AVLTreeNode *grandchild = child->right;
+                rotateLeft(child);
+                rotateRight(ancestor);
+                ancestor->balanceFactor = grandchild->balanceFactor == 'L' ? 'R' : '=';
+                child->balanceFactor = grandchild->balanceFactor == 'R' ? 'L' : '=';
+                grandchild->balanceFactor = '=';
+            }
+            return;
+        }
+        else
+        {
+            if(ancestor->balanceFactor == 'L')
+            {
+                ancestor->balanceFactor = '=';
+                return;
+            }
+            if(ancestor->balanceFactor == '=')
+            {
+                ancestor->balanceFactor = 'R';
+                child = ancestor;
+                ancestor = ancestor->parent;
+                continue;
+            }
+
+            if(child->balanceFactor == 'R')         // Right-right: single rotation
+            {
+                rotateLeft(ancestor);
+                ancestor->balanceFactor = '=';
+                child->balanceFactor = '=';
+            }
+            else                                    // Right-left: double rotation
+            {
+                AVLTreeNode *grandchild = child->left;
+                rotateRight(child);
+                rotateLeft(ancestor);
+                ancestor->balanceFactor = grandchild->balanceFactor == 'R' ? 'L' : '=';
+                child->balanceFactor = grandchild->balanceFactor == 'L' ? 'R' : '=';
+                grandchild->balanceFactor = '=';
+            }
+            return;
+        }
     }
 }
 
 
 
-
-template <typename ElementType>
-void AVLSet<ElementType>::adjustBalanceFactors(AVLTreeNode *end, AVLTreeNode *start)
-{
-
-    AVLTreeNode *temp = start->parent; // Set starting point at start's parent
-    while(temp!= nullptr && temp->key != end->key )
-    {
-        if(start->key < temp->key){
-            temp->balanceFactor = 'L';}
-        else{
-            temp->balanceFactor = 'R';}
-        temp = temp->parent;
-    } // end while
-}
-
-
-
-template <typename ElementType>
-void AVLSet<ElementType>::AVLSet<ElementType>::rotateLeft(AVLTreeNode *n)
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::rotateLeft(AVLTreeNode *n)
 {
     AVLTreeNode *temp = n->right;   //Hold pointer to n's right child
     n->right = temp->left;      // Move temp 's left child to right child of n
@@ -416,11 +951,14 @@ void AVLSet<ElementType>::AVLSet<ElementType>::rotateLeft(AVLTreeNode *n)
 
     temp->left = n;         // Move n to left child of temp
     n->parent = temp;         // Reset n's parent
+
+    temp->size = n->size;   // temp now roots the same subtree n did
+    n->size = sizeOf(n->left) + sizeOf(n->right) + 1;
 }
 
 
-template <typename ElementType>
-void AVLSet<ElementType>::rotateRight(AVLTreeNode *n)
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::rotateRight(AVLTreeNode *n)
 {
     AVLTreeNode *temp = n->left;   //Hold pointer to temp
     n->left = temp->right;      // Move temp's right child to left child of n
@@ -445,172 +983,1301 @@ void AVLSet<ElementType>::rotateRight(AVLTreeNode *n)
 
     temp->right = n;         // Move n to right child of temp
     n->parent = temp;         // Reset n's parent
+
+    temp->size = n->size;   // temp now roots the same subtree n did
+    n->size = sizeOf(n->left) + sizeOf(n->right) + 1;
 }
 
 
-template <typename ElementType>
-void AVLSet<ElementType>::adjustLeftRight(AVLTreeNode *end, AVLTreeNode *start)
+template <typename ElementType, typename Comparison>
+int AVLSet<ElementType, Comparison>::findHeight(AVLTreeNode* aNode) const
 {
-    if(end->key == root->key)
-        end->balanceFactor = '=';
-    else if(start->key < end->parent->key)
-    {
-        end->balanceFactor = 'R';
-        adjustBalanceFactors(end->parent->left, start);
-    }
-    else
-    {
-        end->balanceFactor = '=';
-        end->parent->left->balanceFactor = 'L';
-        adjustBalanceFactors(end, start);
-    }
-}
+    if (aNode == nullptr) return -1;
 
+    // Every node is visited by following child and parent pointers, the
+    // node we just came from telling us which way to go next, so the
+    // deepest level is found without recursion even in an unbalanced tree.
+    AVLTreeNode *n = aNode;
+    AVLTreeNode *previous = aNode->parent;
+    int depth = 0;
+    int height = 0;
 
-template <typename ElementType>
-void AVLSet<ElementType>::adjustRightLeft(AVLTreeNode *end, AVLTreeNode *start)
-{
-    if(end->key == root->key)
-        end->balanceFactor = '=';
-    else if(start->key > end->parent->key)
-    {
-        end->balanceFactor = 'L';
-        adjustBalanceFactors(end->parent->right, start);
-    }
-    else
+    while (true)
     {
+        AVLTreeNode *next;
+        if (previous == n->parent)
+            next = n->left != nullptr ? n->left : n->right != nullptr ? n->right : n->parent;
+        else if (previous == n->left)
+            next = n->right != nullptr ? n->right : n->parent;
+        else
+            next = n->parent;
+
+        if (next == n->parent)
+        {
+            if (n == aNode)
+                return height;
 
-        end->balanceFactor = '=';
-        if( end->parent->right != nullptr)
+            --depth;
+        }
+        else
         {
-            end->parent->right->balanceFactor = 'R';
+            height = std::max(height, ++depth);
         }
 
-        adjustBalanceFactors(end, start);
+        previous = n;
+        n = next;
     }
 }
 
 
 
 
-template <typename ElementType>
-int AVLSet<ElementType>::findHeight(AVLTreeNode* aNode) const
+
+template <typename ElementType, typename Comparison>
+bool AVLSet<ElementType, Comparison>::contains(const ElementType& element) const
 {
-    if (aNode == nullptr) return -1;
-    return  1+max(findHeight(aNode->left), findHeight(aNode->right));
+    return find(element) != nullptr;
 }
 
 
 
+template <typename ElementType, typename Comparison>
+template <typename Key, typename>
+bool AVLSet<ElementType, Comparison>::contains(const Key& key) const
+{
+    return find(key) != nullptr;
+}
 
 
-template <typename ElementType>
-bool AVLSet<ElementType>::contains(const ElementType& element) const
+template <typename ElementType, typename Comparison>
+template <typename Key>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::find(const Key& key) const
 {
-    AVLTreeNode * target = new AVLTreeNode(element);
-    AVLTreeNode *temp;
-    temp=root;
-    if(root == nullptr)
+    AVLTreeNode *temp = root;
+
+    if constexpr (impl_::Comparison__isArithmetic<Comparison, Key, ElementType>::value)
     {
-        delete target;
-        temp =nullptr;
-        return false;
-    }
+        // Comparing two numbers is a single instruction, so it's cheaper
+        // to compare them twice, which the compiler turns into a
+        // conditional move, than to branch three ways on one comparison,
+        // which mispredicts at about half of the levels of a large tree.
+        while (temp != nullptr)
+        {
+            if (key == temp->key)
+                return temp;
 
-    while(temp != nullptr) // Loop till temp falls out of the tree
+            if (key < temp->key)
+                temp = temp->left;
+            else
+                temp = temp->right;
+        }
+    }
+    else
     {
-        if (target->key == temp->key)
+        while (temp != nullptr)
         {
-            delete target;
-            temp =nullptr;
-            return true;
+            int order = Comparison::compare(key, temp->key);
+            if (order == 0)
+                return temp;
+
+            temp = order < 0 ? temp->left : temp->right;
         }
+    }
 
-        if (target->key < temp->key)
-            temp = temp->left;
-        else
-            temp = temp->right;
+    return nullptr;
+}
+
+
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::remove(const ElementType& element)
+{
+    AVLTreeNode *target = find(element);
+    if (target == nullptr)
+        return;
+
+    // A node with two children takes its successor's element, and the
+    // successor, which has no left child, is removed instead.
+    if (target->left != nullptr && target->right != nullptr)
+    {
+        AVLTreeNode *successor = target->right;
+        while (successor->left != nullptr)
+            successor = successor->left;
+
+        target->key = std::move(successor->key);
+        target = successor;
     }
-    delete target;
-    temp = nullptr;
-    return false;
+
+    AVLTreeNode *child = target->left != nullptr ? target->left : target->right;
+    AVLTreeNode *parent = target->parent;
+    bool leftShrank = parent != nullptr && parent->left == target;
+
+    if (child != nullptr)
+        child->parent = parent;
+
+    if (parent == nullptr)
+        root = child;
+    else if (leftShrank)
+        parent->left = child;
+    else
+        parent->right = child;
+
+    nodes.destroy(target);
+    elementNumber = elementNumber - 1;
+    adjustSizes(parent, -1);
+
+    if (this->balance && parent != nullptr)
+        restoreAVLAfterRemove(parent, leftShrank);
 }
 
 
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::restoreAVLAfterRemove(AVLTreeNode *parent, bool leftShrank)
+{
+    while (parent != nullptr)
+    {
+        if (leftShrank)
+        {
+            if (parent->balanceFactor == '=')       // Now leaning right, same height
+            {
+                parent->balanceFactor = 'R';
+                return;
+            }
+            if (parent->balanceFactor == 'L')       // Now even, but shorter
+            {
+                parent->balanceFactor = '=';
+            }
+            else
+            {
+                AVLTreeNode *sibling = parent->right;
+
+                if (sibling->balanceFactor == '=')  // Single rotation, same height
+                {
+                    rotateLeft(parent);
+                    parent->balanceFactor = 'R';
+                    sibling->balanceFactor = 'L';
+                    return;
+                }
+                if (sibling->balanceFactor == 'R')  // Single rotation, shorter
+                {
+                    rotateLeft(parent);
+                    parent->balanceFactor = '=';
+                    sibling->balanceFactor = '=';
+                    parent = sibling;
+                }
+                else                                // Double rotation, shorter
+                {
+                    AVLTreeNode *grandchild = sibling->left;
+                    rotateRight(sibling);
+                    rotateLeft(parent);
+                    parent->balanceFactor = grandchild->balanceFactor == 'R' ? 'L' : '=';
+                    sibling->balanceFactor = grandchild->balanceFactor == 'L' ? 'R' : '=';
+                    grandchild->balanceFactor = '=';
+                    parent = grandchild;
+                }
+            }
+        }
+        else
+        {
+            if (parent->balanceFactor == '=')
+            {
+                parent->balanceFactor = 'L';
+                return;
+            }
+            if (parent->balanceFactor == 'R')
+            {
+                parent->balanceFactor = '=';
+            }
+            else
+            {
+                AVLTreeNode *sibling = parent->left;
+
+                if (sibling->balanceFactor == '=')
+                {
+                    rotateRight(parent);
+                    parent->balanceFactor = 'L';
+                    sibling->balanceFactor = 'R';
+                    return;
+                }
+                if (sibling->balanceFactor == 'L')
+                {
+                    rotateRight(parent);
+                    parent->balanceFactor = '=';
+                    sibling->balanceFactor = '=';
+                    parent = sibling;
+                }
+                else
+                {
+                    AVLTreeNode *grandchild = sibling->right;
+                    rotateLeft(sibling);
+                    rotateRight(parent);
+                    parent->balanceFactor = grandchild->balanceFactor == 'L' ? 'R' : '=';
+                    sibling->balanceFactor = grandchild->balanceFactor == 'R' ? 'L' : '=';
+                    grandchild->balanceFactor = '=';
+                    parent = grandchild;
+                }
+            }
+        }
+
+        // This subtree got shorter, so its parent's balance changes, too.
+        AVLTreeNode *child = parent;
+        parent = parent->parent;
+        leftShrank = parent != nullptr && parent->left == child;
+    }
+}
+
 
-template <typename ElementType>
-unsigned int AVLSet<ElementType>::size() const noexcept
+template <typename ElementType, typename Comparison>
+unsigned int AVLSet<ElementType, Comparison>::size() const noexcept
 {
     return elementNumber;
 }
 
 
-template <typename ElementType>
-int AVLSet<ElementType>::height() const
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::Iterator AVLSet<ElementType, Comparison>::begin() const noexcept
 {
-    return findHeight(root);
+    return Iterator{this, root == nullptr ? nullptr : leftmost(root)};
 }
 
 
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::Iterator AVLSet<ElementType, Comparison>::end() const noexcept
+{
+    return Iterator{this, nullptr};
+}
 
 
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::ReverseIterator AVLSet<ElementType, Comparison>::rbegin() const noexcept
+{
+    return ReverseIterator{end()};
+}
 
 
-
-template <typename ElementType>
-void AVLSet<ElementType>::preorder(VisitFunction visit) const
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::ReverseIterator AVLSet<ElementType, Comparison>::rend() const noexcept
 {
-    preorder_traverse(root,visit);
+    return ReverseIterator{begin()};
 }
 
-template <typename ElementType>
-void AVLSet<ElementType>::preorder_traverse(AVLTreeNode* node,VisitFunction visit) const
+
+template <typename ElementType, typename Comparison>
+template <typename Key>
+typename AVLSet<ElementType, Comparison>::Iterator AVLSet<ElementType, Comparison>::lowerBound(const Key& key) const
 {
-    if (node == nullptr)
-        return;
-    visit(node->key);
-    preorder_traverse(node->left,visit);
-    preorder_traverse(node->right,visit);
+    return Iterator{this, bound(key, true)};
 }
 
 
-
-template <typename ElementType>
-void AVLSet<ElementType>::inorder(VisitFunction visit) const {
-    inorder_traverse(root,visit);
+template <typename ElementType, typename Comparison>
+template <typename Key>
+typename AVLSet<ElementType, Comparison>::Iterator AVLSet<ElementType, Comparison>::upperBound(const Key& key) const
+{
+    return Iterator{this, bound(key, false)};
 }
 
-template <typename ElementType>
-void AVLSet<ElementType>::inorder_traverse(AVLTreeNode* node,VisitFunction visit) const
+
+template <typename ElementType, typename Comparison>
+template <typename LowKey, typename HighKey>
+std::pair<typename AVLSet<ElementType, Comparison>::Iterator, typename AVLSet<ElementType, Comparison>::Iterator>
+    AVLSet<ElementType, Comparison>::range(const LowKey& lo, const HighKey& hi) const
 {
-    if (node == nullptr)
-        return;
-    inorder_traverse(node->left,visit);
-    visit(node->key);
-    inorder_traverse(node->right,visit);
+    Iterator first = lowerBound(lo);
 
+    // When nothing is in the range, which is always the case when hi is
+    // less than lo, the upper bound of hi could come before first.
+    if (first == end() || Comparison::compare(hi, *first) < 0)
+        return {first, first};
 
+    return {first, upperBound(hi)};
 }
 
 
-
-template <typename ElementType>
-void AVLSet<ElementType>::postorder(VisitFunction visit) const
+template <typename ElementType, typename Comparison>
+template <typename LowKey, typename HighKey, typename Visit>
+void AVLSet<ElementType, Comparison>::forEachInRange(const LowKey& lo, const HighKey& hi, Visit&& visit) const
 {
-    postorder_traverse(root,visit);
+    for (const AVLTreeNode *n = bound(lo, true); n != nullptr && Comparison::compare(hi, n->key) >= 0; n = successor(n))
+        visit(n->key);
 }
 
-template <typename ElementType>
-void AVLSet<ElementType>::postorder_traverse(AVLTreeNode* node,VisitFunction visit) const
+
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::unionWith(const AVLSet& other, unsigned int threads)
 {
+    if (this == &other || other.root == nullptr)
+        return;
+
+    if (!balance || !other.balance)
+    {
+        for (const ElementType& element : other)
+            add(element);
 
-    if (node == nullptr)
         return;
-    postorder_traverse(node->left,visit);
-    postorder_traverse(node->right,visit);
-    visit(node->key);
+    }
 
+    // The other set's nodes are copied first, so that no nodes have to be
+    // allocated while other threads might be running.  Copies of elements
+    // this set already has are thrown away afterward.
+    AVLTreeNode *copied = copy(other.root, nullptr);
 
+    std::vector<AVLTreeNode*> garbage;
+    int height;
+    setRoot(uniteTrees(root, heightOf(root), copied, heightOf(copied), height, threads, garbage));
+    destroySubtrees(garbage);
 }
+
+
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::intersectWith(const AVLSet& other, unsigned int threads)
+{
+    if (this == &other)
+        return;
+
+    if (!balance || !other.balance)
+    {
+        std::vector<ElementType> missing;
+        for (const ElementType& element : *this)
+        {
+            if (!other.contains(element))
+                missing.push_back(element);
+        }
+
+        for (const ElementType& element : missing)
+            remove(element);
+
+        return;
+    }
+
+    std::vector<AVLTreeNode*> garbage;
+    int height;
+    setRoot(intersectTrees(root, heightOf(root), other.root, height, threads, garbage));
+    destroySubtrees(garbage);
+}
+
+
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::differenceWith(const AVLSet& other, unsigned int threads)
+{
+    if (this == &other)
+    {
+        ClearTree(root);
+        root = nullptr;
+        elementNumber = 0;
+        return;
+    }
+
+    if (!balance || !other.balance)
+    {
+        for (const ElementType& element : other)
+            remove(element);
+
+        return;
+    }
+
+    std::vector<AVLTreeNode*> garbage;
+    int height;
+    setRoot(subtractTrees(root, heightOf(root), other.root, height, threads, garbage));
+    destroySubtrees(garbage);
+}
+
+
+template <typename ElementType, typename Comparison>
+FrozenAVLSet<ElementType, Comparison> AVLSet<ElementType, Comparison>::freeze() const
+{
+    return FrozenAVLSet<ElementType, Comparison>{begin(), size()};
+}
+
+
+template <typename ElementType, typename Comparison>
+int AVLSet<ElementType, Comparison>::height() const
+{
+    return findHeight(root);
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename Key>
+unsigned int AVLSet<ElementType, Comparison>::rank(const Key& key) const
+{
+    return countLess(key, false);
+}
+
+
+template <typename ElementType, typename Comparison>
+const ElementType& AVLSet<ElementType, Comparison>::select(unsigned int index) const
+{
+    const AVLTreeNode *n = root;
+    while (true)
+    {
+        unsigned int leftSize = sizeOf(n->left);
+        if (index < leftSize)
+        {
+            n = n->left;
+        }
+        else if (index == leftSize)
+        {
+            return n->key;
+        }
+        else
+        {
+            index -= leftSize + 1;
+            n = n->right;
+        }
+    }
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename LowKey, typename HighKey>
+unsigned int AVLSet<ElementType, Comparison>::countInRange(const LowKey& lo, const HighKey& hi) const
+{
+    unsigned int atMostHi = countLess(hi, true);
+    unsigned int belowLo = countLess(lo, false);
+    return atMostHi > belowLo ? atMostHi - belowLo : 0;
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename Key>
+unsigned int AVLSet<ElementType, Comparison>::countLess(const Key& key, bool orEqual) const
+{
+    // Each time the search goes right, the node it leaves and everything
+    // to that node's left are less than the key.
+    unsigned int count = 0;
+    const AVLTreeNode *n = root;
+    while (n != nullptr)
+    {
+        int order = Comparison::compare(key, n->key);
+        if (order > 0 || (order == 0 && orEqual))
+        {
+            count += sizeOf(n->left) + 1;
+            n = n->right;
+        }
+        else
+        {
+            n = n->left;
+        }
+    }
+
+    return count;
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename Key>
+const typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::bound(const Key& key, bool orEqual) const
+{
+    // Each time the search goes left, the node it leaves is the best
+    // candidate so far; going right rules the node out.
+    const AVLTreeNode *candidate = nullptr;
+    const AVLTreeNode *n = root;
+    while (n != nullptr)
+    {
+        int order = Comparison::compare(key, n->key);
+        if (order < 0 || (order == 0 && orEqual))
+        {
+            candidate = n;
+            n = n->left;
+        }
+        else
+        {
+            n = n->right;
+        }
+    }
+
+    return candidate;
+}
+
+
+template <typename ElementType, typename Comparison>
+int AVLSet<ElementType, Comparison>::heightOf(const AVLTreeNode* node) noexcept
+{
+    int height = -1;
+    while (node != nullptr)
+    {
+        ++height;
+        node = node->balanceFactor == 'L' ? node->left : node->right;
+    }
+
+    return height;
+}
+
+
+template <typename ElementType, typename Comparison>
+int AVLSet<ElementType, Comparison>::leftHeight(const AVLTreeNode* node, int height) noexcept
+{
+    return node->balanceFactor == 'R' ? height - 2 : height - 1;
+}
+
+
+template <typename ElementType, typename Comparison>
+int AVLSet<ElementType, Comparison>::rightHeight(const AVLTreeNode* node, int height) noexcept
+{
+    return node->balanceFactor == 'L' ? height - 2 : height - 1;
+}
+
+
+template <typename ElementType, typename Comparison>
+int AVLSet<ElementType, Comparison>::link(
+    AVLTreeNode* node, AVLTreeNode* left, int lh, AVLTreeNode* right, int rh) noexcept
+{
+    node->left = left;
+    node->right = right;
+
+    if (left != nullptr)
+        left->parent = node;
+
+    if (right != nullptr)
+        right->parent = node;
+
+    node->size = sizeOf(left) + sizeOf(right) + 1;
+
+    if (lh > rh)
+        node->balanceFactor = 'L';
+    else if (rh > lh)
+        node->balanceFactor = 'R';
+    else
+        node->balanceFactor = '=';
+
+    return std::max(lh, rh) + 1;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::join(
+    AVLTreeNode* left, int lh, AVLTreeNode* middle, AVLTreeNode* right, int rh, int& height) noexcept
+{
+    AVLTreeNode *joined;
+    if (lh > rh + 1)
+    {
+        joined = joinRight(left, lh, middle, right, rh, height);
+    }
+    else if (rh > lh + 1)
+    {
+        joined = joinLeft(left, lh, middle, right, rh, height);
+    }
+    else
+    {
+        height = link(middle, left, lh, right, rh);
+        joined = middle;
+    }
+
+    joined->parent = nullptr;
+    return joined;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::joinRight(
+    AVLTreeNode* left, int lh, AVLTreeNode* middle, AVLTreeNode* right, int rh, int& height) noexcept
+{
+    // The left tree is the taller one, so the middle node and the right
+    // tree are attached somewhere down its right side, where a subtree is
+    // about as tall as the right tree.  At most one rotation, single or
+    // double, is needed on the way back up.
+    AVLTreeNode *l = left->left;
+    AVLTreeNode *c = left->right;
+    int hl = leftHeight(left, lh);
+    int hc = rightHeight(left, lh);
+
+    if (hc <= rh + 1)
+    {
+        int hm = link(middle, c, hc, right, rh);
+        if (hm <= hl + 1)
+        {
+            height = link(left, l, hl, middle, hm);
+            return left;
+        }
+
+        // The middle node's new subtree is too tall, which can only happen
+        // when c is as tall as it can be, so c moves up to the top.
+        AVLTreeNode *cl = c->left;
+        AVLTreeNode *cr = c->right;
+        int hcl = leftHeight(c, hc);
+        int hcr = rightHeight(c, hc);
+
+        int h1 = link(left, l, hl, cl, hcl);
+        int h2 = link(middle, cr, hcr, right, rh);
+        height = link(c, left, h1, middle, h2);
+        return c;
+    }
+
+    int hj;
+    AVLTreeNode *joined = joinRight(c, hc, middle, right, rh, hj);
+    if (hj <= hl + 1)
+    {
+        height = link(left, l, hl, joined, hj);
+        return left;
+    }
+
+    AVLTreeNode *a = joined->left;
+    AVLTreeNode *b = joined->right;
+    int ha = leftHeight(joined, hj);
+    int hb = rightHeight(joined, hj);
+
+    int h1 = link(left, l, hl, a, ha);
+    height = link(joined, left, h1, b, hb);
+    return joined;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::joinLeft(
+    AVLTreeNode* left, int lh, AVLTreeNode* middle, AVLTreeNode* right, int rh, int& height) noexcept
+{
+    // The mirror image of joinRight(), for when the right tree is taller.
+    AVLTreeNode *c = right->left;
+    AVLTreeNode *r = right->right;
+    int hc = leftHeight(right, rh);
+    int hr = rightHeight(right, rh);
+
+    if (hc <= lh + 1)
+    {
+        int hm = link(middle, left, lh, c, hc);
+        if (hm <= hr + 1)
+        {
+            height = link(right, middle, hm, r, hr);
+            return right;
+        }
+
+        AVLTreeNode *cl = c->left;
+        AVLTreeNode *cr = c->right;
+        int hcl = leftHeight(c, hc);
+        int hcr = rightHeight(c, hc);
+
+        int h1 = link(middle, left, lh, cl, hcl);
+        int h2 = link(right, cr, hcr, r, hr);
+        height = link(c, middle, h1, right, h2);
+        return c;
+    }
+
+    int hj;
+    AVLTreeNode *joined = joinLeft(left, lh, middle, c, hc, hj);
+    if (hj <= hr + 1)
+    {
+        height = link(right, joined, hj, r, hr);
+        return right;
+    }
+
+    AVLTreeNode *a = joined->left;
+    AVLTreeNode *b = joined->right;
+    int ha = leftHeight(joined, hj);
+    int hb = rightHeight(joined, hj);
+
+    int h2 = link(right, b, hb, r, hr);
+    height = link(joined, a, ha, right, h2);
+    return joined;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::join2(
+    AVLTreeNode* left, int lh, AVLTreeNode* right, int rh, int& height) noexcept
+{
+    if (left == nullptr)
+    {
+        height = rh;
+        return right;
+    }
+
+    AVLTreeNode *rest;
+    int restHeight;
+    AVLTreeNode *last = splitLast(left, lh, rest, restHeight);
+    return join(rest, restHeight, last, right, rh, height);
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::splitLast(
+    AVLTreeNode* node, int height, AVLTreeNode*& rest, int& restHeight) noexcept
+{
+    if (node->right == nullptr)
+    {
+        rest = node->left;
+        restHeight = leftHeight(node, height);
+
+        if (rest != nullptr)
+            rest->parent = nullptr;
+
+        return node;
+    }
+
+    AVLTreeNode *rightRest;
+    int rightRestHeight;
+    AVLTreeNode *last = splitLast(node->right, rightHeight(node, height), rightRest, rightRestHeight);
+    rest = join(node->left, leftHeight(node, height), node, rightRest, rightRestHeight, restHeight);
+    return last;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::split(
+    AVLTreeNode* node, int height, const ElementType& key,
+    AVLTreeNode*& less, int& lessHeight, AVLTreeNode*& greater, int& greaterHeight)
+{
+    if (node == nullptr)
+    {
+        less = greater = nullptr;
+        lessHeight = greaterHeight = -1;
+        return nullptr;
+    }
+
+    AVLTreeNode *l = node->left;
+    AVLTreeNode *r = node->right;
+    int hl = leftHeight(node, height);
+    int hr = rightHeight(node, height);
+
+    if (l != nullptr)
+        l->parent = nullptr;
+
+    if (r != nullptr)
+        r->parent = nullptr;
+
+    int order = Comparison::compare(key, node->key);
+    if (order == 0)
+    {
+        less = l;
+        lessHeight = hl;
+        greater = r;
+        greaterHeight = hr;
+
+        node->left = node->right = nullptr;
+        node->size = 1;
+        node->balanceFactor = '=';
+        return node;
+    }
+
+    AVLTreeNode *found;
+    if (order < 0)
+    {
+        AVLTreeNode *between;
+        int betweenHeight;
+        found = split(l, hl, key, less, lessHeight, between, betweenHeight);
+        greater = join(between, betweenHeight, node, r, hr, greaterHeight);
+    }
+    else
+    {
+        AVLTreeNode *between;
+        int betweenHeight;
+        found = split(r, hr, key, between, betweenHeight, greater, greaterHeight);
+        less = join(l, hl, node, between, betweenHeight, lessHeight);
+    }
+
+    return found;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::uniteTrees(
+    AVLTreeNode* t1, int h1, AVLTreeNode* t2, int h2, int& height,
+    unsigned int threads, std::vector<AVLTreeNode*>& garbage)
+{
+    if (t1 == nullptr)
+    {
+        height = h2;
+        return t2;
+    }
+
+    if (t2 == nullptr)
+    {
+        height = h1;
+        return t1;
+    }
+
+    AVLTreeNode *l2 = t2->left;
+    AVLTreeNode *r2 = t2->right;
+    int hl2 = leftHeight(t2, h2);
+    int hr2 = rightHeight(t2, h2);
+
+    if (l2 != nullptr)
+        l2->parent = nullptr;
+
+    if (r2 != nullptr)
+        r2->parent = nullptr;
+
+    unsigned int work = t1->size + t2->size;
+
+    AVLTreeNode *l1;
+    AVLTreeNode *r1;
+    int hl1;
+    int hr1;
+    AVLTreeNode *duplicate = split(t1, h1, t2->key, l1, hl1, r1, hr1);
+
+    if (duplicate != nullptr)
+        garbage.push_back(duplicate);
+
+    AVLTreeNode *left;
+    AVLTreeNode *right;
+    int lh;
+    int rh;
+    fork(threads, work, garbage,
+        [&](unsigned int t, std::vector<AVLTreeNode*>& g) { left = uniteTrees(l1, hl1, l2, hl2, lh, t, g); },
+        [&](unsigned int t, std::vector<AVLTreeNode*>& g) { right = uniteTrees(r1, hr1, r2, hr2, rh, t, g); });
+
+    return join(left, lh, t2, right, rh, height);
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::intersectTrees(
+    AVLTreeNode* t1, int h1, const AVLTreeNode* t2, int& height,
+    unsigned int threads, std::vector<AVLTreeNode*>& garbage)
+{
+    if (t1 == nullptr)
+    {
+        height = -1;
+        return nullptr;
+    }
+
+    if (t2 == nullptr)
+    {
+        garbage.push_back(t1);
+        height = -1;
+        return nullptr;
+    }
+
+    unsigned int work = t1->size + t2->size;
+
+    AVLTreeNode *l1;
+    AVLTreeNode *r1;
+    int hl1;
+    int hr1;
+    AVLTreeNode *found = split(t1, h1, t2->key, l1, hl1, r1, hr1);
+
+    AVLTreeNode *left;
+    AVLTreeNode *right;
+    int lh;
+    int rh;
+    fork(threads, work, garbage,
+        [&](unsigned int t, std::vector<AVLTreeNode*>& g) { left = intersectTrees(l1, hl1, t2->left, lh, t, g); },
+        [&](unsigned int t, std::vector<AVLTreeNode*>& g) { right = intersectTrees(r1, hr1, t2->right, rh, t, g); });
+
+    if (found != nullptr)
+        return join(left, lh, found, right, rh, height);
+    else
+        return join2(left, lh, right, rh, height);
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::subtractTrees(
+    AVLTreeNode* t1, int h1, const AVLTreeNode* t2, int& height,
+    unsigned int threads, std::vector<AVLTreeNode*>& garbage)
+{
+    if (t1 == nullptr || t2 == nullptr)
+    {
+        height = h1;
+        return t1;
+    }
+
+    unsigned int work = t1->size + t2->size;
+
+    AVLTreeNode *l1;
+    AVLTreeNode *r1;
+    int hl1;
+    int hr1;
+    AVLTreeNode *found = split(t1, h1, t2->key, l1, hl1, r1, hr1);
+
+    if (found != nullptr)
+        garbage.push_back(found);
+
+    AVLTreeNode *left;
+    AVLTreeNode *right;
+    int lh;
+    int rh;
+    fork(threads, work, garbage,
+        [&](unsigned int t, std::vector<AVLTreeNode*>& g) { left = subtractTrees(l1, hl1, t2->left, lh, t, g); },
+        [&](unsigned int t, std::vector<AVLTreeNode*>& g) { right = subtractTrees(r1, hr1, t2->right, rh, t, g); });
+
+    return join2(left, lh, right, rh, height);
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename Left, typename Right>
+void AVLSet<ElementType, Comparison>::fork(
+    unsigned int threads, unsigned int work, std::vector<AVLTreeNode*>& garbage,
+    Left&& left, Right&& right)
+{
+    if (threads <= 1 || work < PARALLEL_CUTOFF)
+    {
+        left(1, garbage);
+        right(1, garbage);
+        return;
+    }
+
+    unsigned int leftThreads = threads / 2;
+    std::vector<AVLTreeNode*> leftGarbage;
+
+    std::thread leftThread{[&] { left(leftThreads, leftGarbage); }};
+    right(threads - leftThreads, garbage);
+    leftThread.join();
+
+    garbage.insert(garbage.end(), leftGarbage.begin(), leftGarbage.end());
+}
+
+
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::setRoot(AVLTreeNode* node) noexcept
+{
+    root = node;
+    if (root != nullptr)
+        root->parent = nullptr;
+
+    elementNumber = sizeOf(root);
+}
+
+
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::destroySubtrees(const std::vector<AVLTreeNode*>& subtrees) noexcept
+{
+    // The same rotations ClearTree() uses flatten each subtree into a list
+    // down its right side, so it can be destroyed without a stack.
+    for (AVLTreeNode *n : subtrees)
+    {
+        while (n != nullptr)
+        {
+            if (n->left != nullptr)
+            {
+                AVLTreeNode *l = n->left;
+                n->left = l->right;
+                l->right = n;
+                n = l;
+            }
+            else
+            {
+                AVLTreeNode *next = n->right;
+                nodes.destroy(n);
+                n = next;
+            }
+        }
+    }
+}
+
+
+template <typename ElementType, typename Comparison>
+void AVLSet<ElementType, Comparison>::adjustSizes(AVLTreeNode* node, int change) noexcept
+{
+    for (; node != nullptr; node = node->parent)
+        node->size += change;
+}
+
+
+template <typename ElementType, typename Comparison>
+unsigned int AVLSet<ElementType, Comparison>::sizeOf(const AVLTreeNode* node) noexcept
+{
+    return node != nullptr ? node->size : 0;
+}
+
+
+
+
+
+
+
+template <typename ElementType, typename Comparison>
+template <typename Visit>
+void AVLSet<ElementType, Comparison>::preorder(Visit&& visit) const
+{
+    if (balance)
+    {
+        // Each right subtree waits in "pending" while its sibling on the
+        // left is visited.
+        const AVLTreeNode* pending[MAX_BALANCED_HEIGHT];
+        unsigned int pendingCount = 0;
+
+        const AVLTreeNode* node = root;
+        while (node != nullptr)
+        {
+            visit(node->key);
+
+            if (node->left != nullptr)
+            {
+                if (node->right != nullptr)
+                    pending[pendingCount++] = node->right;
+
+                node = node->left;
+            }
+            else if (node->right != nullptr)
+            {
+                node = node->right;
+            }
+            else
+            {
+                node = pendingCount == 0 ? nullptr : pending[--pendingCount];
+            }
+        }
+
+        return;
+    }
+
+    const AVLTreeNode* node = root;
+    while (node != nullptr)
+    {
+        visit(node->key);
+
+        if (node->left != nullptr)
+        {
+            node = node->left;
+        }
+        else if (node->right != nullptr)
+        {
+            node = node->right;
+        }
+        else
+        {
+            // Having finished a subtree, go back up to the nearest ancestor
+            // whose right subtree hasn't been visited yet.
+            const AVLTreeNode* child = node;
+            node = node->parent;
+            while (node != nullptr && (node->right == child || node->right == nullptr))
+            {
+                child = node;
+                node = node->parent;
+            }
+
+            if (node != nullptr)
+                node = node->right;
+        }
+    }
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename Visit>
+void AVLSet<ElementType, Comparison>::inorder(Visit&& visit) const
+{
+    if (balance)
+    {
+        // Following parent pointers back up makes every step wait on
+        // another node; keeping the path instead lets the processor go
+        // ahead and fetch the next node while the visit is still running.
+        const AVLTreeNode* path[MAX_BALANCED_HEIGHT];
+        unsigned int depth = 0;
+
+        const AVLTreeNode* node = root;
+        while (true)
+        {
+            for (; node != nullptr; node = node->left)
+                path[depth++] = node;
+
+            if (depth == 0)
+                return;
+
+            node = path[--depth];
+            visit(node->key);
+            node = node->right;
+        }
+    }
+
+    if (root == nullptr)
+        return;
+
+    for (const AVLTreeNode* node = leftmost(root); node != nullptr; node = successor(node))
+        visit(node->key);
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename Visit>
+void AVLSet<ElementType, Comparison>::postorder(Visit&& visit) const
+{
+    if (balance)
+    {
+        // A node on the path is visited once its right subtree is done,
+        // which is when that subtree was the last thing visited.
+        const AVLTreeNode* path[MAX_BALANCED_HEIGHT];
+        unsigned int depth = 0;
+
+        const AVLTreeNode* node = root;
+        const AVLTreeNode* visited = nullptr;
+        while (node != nullptr || depth > 0)
+        {
+            if (node != nullptr)
+            {
+                path[depth++] = node;
+                node = node->left;
+            }
+            else if (path[depth - 1]->right != nullptr && path[depth - 1]->right != visited)
+            {
+                node = path[depth - 1]->right;
+            }
+            else
+            {
+                visited = path[--depth];
+                visit(visited->key);
+            }
+        }
+
+        return;
+    }
+
+    if (root == nullptr)
+        return;
+
+    const AVLTreeNode* node = firstInPostorder(root);
+    while (node != nullptr)
+    {
+        visit(node->key);
+
+        // A left child is followed by its sibling's subtree, if it has a
+        // sibling; otherwise, a node is followed by its parent.
+        const AVLTreeNode* parent = node->parent;
+        if (parent != nullptr && parent->left == node && parent->right != nullptr)
+            node = firstInPostorder(parent->right);
+        else
+            node = parent;
+    }
+}
+
+
+template <typename ElementType, typename Comparison>
+const typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::leftmost(const AVLTreeNode* node) noexcept
+{
+    while (node->left != nullptr)
+        node = node->left;
+
+    return node;
+}
+
+
+template <typename ElementType, typename Comparison>
+const typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::rightmost(const AVLTreeNode* node) noexcept
+{
+    while (node->right != nullptr)
+        node = node->right;
+
+    return node;
+}
+
+
+template <typename ElementType, typename Comparison>
+const typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::successor(const AVLTreeNode* node) noexcept
+{
+    // The next element is the smallest one in the right subtree, if there
+    // is one; otherwise, it's the nearest ancestor whose left subtree this
+    // node is in.
+    if (node->right != nullptr)
+        return leftmost(node->right);
+
+    const AVLTreeNode* child = node;
+    node = node->parent;
+    while (node != nullptr && node->right == child)
+    {
+        child = node;
+        node = node->parent;
+    }
+
+    return node;
+}
+
+
+template <typename ElementType, typename Comparison>
+const typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::predecessor(const AVLTreeNode* node) noexcept
+{
+    if (node->left != nullptr)
+        return rightmost(node->left);
+
+    const AVLTreeNode* child = node;
+    node = node->parent;
+    while (node != nullptr && node->left == child)
+    {
+        child = node;
+        node = node->parent;
+    }
+
+    return node;
+}
+
+
+template <typename ElementType, typename Comparison>
+const typename AVLSet<ElementType, Comparison>::AVLTreeNode* AVLSet<ElementType, Comparison>::firstInPostorder(const AVLTreeNode* node) noexcept
+{
+    while (node->left != nullptr || node->right != nullptr)
+        node = node->left != nullptr ? node->left : node->right;
+
+    return node;
+}
+
+
+
+template <typename ElementType, typename Comparison>
+AVLSet<ElementType, Comparison>::Iterator::Iterator() noexcept
+    : set{nullptr}, node{nullptr}
+{
+}
+
+
+template <typename ElementType, typename Comparison>
+AVLSet<ElementType, Comparison>::Iterator::Iterator(const AVLSet* set, const AVLTreeNode* node) noexcept
+    : set{set}, node{node}
+{
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::Iterator::reference AVLSet<ElementType, Comparison>::Iterator::operator*() const noexcept
+{
+    return node->key;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::Iterator::pointer AVLSet<ElementType, Comparison>::Iterator::operator->() const noexcept
+{
+    return &node->key;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::Iterator& AVLSet<ElementType, Comparison>::Iterator::operator++() noexcept
+{
+    node = successor(node);
+    return *this;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::Iterator AVLSet<ElementType, Comparison>::Iterator::operator++(int) noexcept
+{
+    Iterator old = *this;
+    ++*this;
+    return old;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::Iterator& AVLSet<ElementType, Comparison>::Iterator::operator--() noexcept
+{
+    node = node == nullptr ? rightmost(set->root) : predecessor(node);
+    return *this;
+}
+
+
+template <typename ElementType, typename Comparison>
+typename AVLSet<ElementType, Comparison>::Iterator AVLSet<ElementType, Comparison>::Iterator::operator--(int) noexcept
+{
+    Iterator old = *this;
+    --*this;
+    return old;
+}
+
+
+template <typename ElementType, typename Comparison>
+bool AVLSet<ElementType, Comparison>::Iterator::operator==(const Iterator& other) const noexcept
+{
+    return node == other.node;
+}
+
+
+template <typename ElementType, typename Comparison>
+bool AVLSet<ElementType, Comparison>::Iterator::operator!=(const Iterator& other) const noexcept
+{
+    return node != other.node;
+}
+
+
+
 #endif // AVLSET_HPP
 
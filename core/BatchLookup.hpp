@@ -0,0 +1,33 @@
+// BatchLookup.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// BatchLookup is an interface for sets that can look up many keys at once
+// faster than they could look them up one at a time, usually by starting
+// the memory accesses for every key in the batch before waiting on any of
+// them.  A set implements it alongside Set, so code that only knows it has
+// a Set (such as the WordChecker) can ask whether batches are supported
+// with dynamic_cast and fall back on contains() if they aren't.
+
+#ifndef BATCHLOOKUP_HPP
+#define BATCHLOOKUP_HPP
+
+
+
+template <typename ElementType>
+class BatchLookup
+{
+public:
+    virtual ~BatchLookup() noexcept = default;
+
+
+    // containsMany() looks up each of the count keys in the given array,
+    // storing into results[i] whether keys[i] is in the set, exactly as
+    // though contains() had been called on each one.
+    virtual void containsMany(const ElementType* keys, unsigned int count, bool* results) const = 0;
+};
+
+
+
+#endif // BATCHLOOKUP_HPP
@@ -0,0 +1,125 @@
+// BloomFilter.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Implementation of the BloomFilter.
+
+#include <algorithm>
+#include <utility>
+#include "BloomFilter.hpp"
+#include "FastHash.hpp"
+
+
+
+namespace
+{
+    // Odd constants, one per word of a block.  Multiplying the hash by
+    // each one and keeping the top six bits gives eight different bit
+    // positions from one hash.
+    constexpr std::uint64_t SALTS[8] = {
+        0x47b6137b44974d91ull, 0x8824ad5ba2b7289dull,
+        0x705495c72df1424bull, 0x9efc49475c6bfb31ull,
+        0x2df1424b705495c7ull, 0x5c6bfb319efc4947ull,
+        0xa2b7289d8824ad5bull, 0x44974d9147b6137bull
+    };
+
+
+    inline std::uint64_t bitFor(std::uint64_t hash, unsigned int word) noexcept
+    {
+        return std::uint64_t{1} << ((hash * SALTS[word]) >> 58);
+    }
+}
+
+
+
+BloomFilter::BloomFilter(unsigned int expectedElements, unsigned int bitsPerElement)
+{
+    std::uint64_t bits = std::uint64_t{expectedElements} * bitsPerElement;
+    blockCount = static_cast<unsigned int>(std::max<std::uint64_t>(1, (bits + 511) / 512));
+    blocks = new Block[blockCount]();
+}
+
+
+BloomFilter::~BloomFilter() noexcept
+{
+    delete[] blocks;
+}
+
+
+BloomFilter::BloomFilter(const BloomFilter& f)
+    : blocks{new Block[f.blockCount]}, blockCount{f.blockCount}
+{
+    std::copy(f.blocks, f.blocks + f.blockCount, blocks);
+}
+
+
+BloomFilter::BloomFilter(BloomFilter&& f) noexcept
+    : blocks{nullptr}, blockCount{0}
+{
+    std::swap(blocks, f.blocks);
+    std::swap(blockCount, f.blockCount);
+}
+
+
+BloomFilter& BloomFilter::operator=(const BloomFilter& f)
+{
+    if (this != &f)
+    {
+        Block* newBlocks = new Block[f.blockCount];
+        std::copy(f.blocks, f.blocks + f.blockCount, newBlocks);
+
+        delete[] blocks;
+        blocks = newBlocks;
+        blockCount = f.blockCount;
+    }
+
+    return *this;
+}
+
+
+BloomFilter& BloomFilter::operator=(BloomFilter&& f) noexcept
+{
+    std::swap(blocks, f.blocks);
+    std::swap(blockCount, f.blockCount);
+    return *this;
+}
+
+
+void BloomFilter::add(std::string_view element) noexcept
+{
+    std::uint64_t hash = fastHash64(element.data(), element.size());
+    Block& block = blocks[blockFor(hash)];
+
+    for (unsigned int word = 0; word < 8; ++word)
+        block.words[word] |= bitFor(hash, word);
+}
+
+
+bool BloomFilter::mightContain(std::string_view element) const noexcept
+{
+    std::uint64_t hash = fastHash64(element.data(), element.size());
+    const Block& block = blocks[blockFor(hash)];
+
+    // Checking every word without stopping early lets the compiler do
+    // them all at once, which is faster than a branch per word.
+    std::uint64_t missing = 0;
+    for (unsigned int word = 0; word < 8; ++word)
+        missing |= ~block.words[word] & bitFor(hash, word);
+
+    return missing == 0;
+}
+
+
+std::size_t BloomFilter::memoryUsage() const noexcept
+{
+    return sizeof(Block) * blockCount;
+}
+
+
+unsigned int BloomFilter::blockFor(std::uint64_t hash) const noexcept
+{
+    // The block comes from the low half of the hash and the bits from
+    // multiplying all of it, so the two are nearly independent.
+    return static_cast<unsigned int>(((hash & 0xffffffffull) * blockCount) >> 32);
+}
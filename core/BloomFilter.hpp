@@ -0,0 +1,102 @@
+// BloomFilter.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A BloomFilter is a compact, approximate set of strings.  It can't list
+// its strings, and it occasionally says that it might contain a string
+// that was never added (a "false positive"), but it never says that it
+// doesn't contain one that was.  In exchange, it takes only a few bits
+// per string, and a string that was never added is usually rejected
+// after touching a single cache line, which makes it a cheap way to rule
+// out lookups in a larger Set before doing them.
+//
+// This is a "blocked" Bloom filter: its bits are divided into 64-byte
+// blocks, each of which fits in one cache line, and all of a string's
+// bits are in the same block.  A string's hash picks its block, and then
+// sets (or checks) one bit in each of the block's eight 64-bit words.
+// Keeping the bits together costs a little in the false positive rate,
+// compared to spreading them over the whole filter, but a lookup never
+// has more than one cache miss.  With the default of 12 bits per string,
+// about 0.5% of the strings that were never added are false positives.
+
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+
+
+class BloomFilter
+{
+public:
+    static constexpr unsigned int DEFAULT_BITS_PER_ELEMENT = 12;
+
+public:
+    // Initializes an empty BloomFilter that's sized to hold the given
+    // number of strings with the given number of bits for each.  Any
+    // number of strings can be added, but the false positive rate rises
+    // quickly once there are more than it was sized for.
+    explicit BloomFilter(
+        unsigned int expectedElements, unsigned int bitsPerElement = DEFAULT_BITS_PER_ELEMENT);
+
+    // Initializes a BloomFilter containing the strings in the range
+    // [first, last), sized for exactly that many.
+    template <typename ForwardIterator>
+    BloomFilter(
+        ForwardIterator first, ForwardIterator last,
+        unsigned int bitsPerElement = DEFAULT_BITS_PER_ELEMENT);
+
+    ~BloomFilter() noexcept;
+
+    // A BloomFilter can be copied and moved; one that has been moved from
+    // can only be assigned to or destroyed.
+    BloomFilter(const BloomFilter& f);
+    BloomFilter(BloomFilter&& f) noexcept;
+    BloomFilter& operator=(const BloomFilter& f);
+    BloomFilter& operator=(BloomFilter&& f) noexcept;
+
+
+    // add() adds a string to the filter.
+    void add(std::string_view element) noexcept;
+
+
+    // mightContain() returns false if the given string was never added
+    // to the filter, and true if it was added or is a false positive.
+    bool mightContain(std::string_view element) const noexcept;
+
+
+    // memoryUsage() returns the number of bytes the filter's bits take.
+    std::size_t memoryUsage() const noexcept;
+
+
+private:
+    struct alignas(64) Block
+    {
+        std::uint64_t words[8];
+    };
+
+    // Returns the index of the block a string with the given hash
+    // belongs in.
+    unsigned int blockFor(std::uint64_t hash) const noexcept;
+
+    Block* blocks;
+    unsigned int blockCount;
+};
+
+
+
+template <typename ForwardIterator>
+BloomFilter::BloomFilter(ForwardIterator first, ForwardIterator last, unsigned int bitsPerElement)
+    : BloomFilter{static_cast<unsigned int>(std::distance(first, last)), bitsPerElement}
+{
+    for (; first != last; ++first)
+        add(*first);
+}
+
+
+
+#endif // BLOOMFILTER_HPP
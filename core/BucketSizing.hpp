@@ -0,0 +1,116 @@
+// BucketSizing.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A bucket sizing policy decides two things for a HashSet: which array
+// capacities are allowed, and how a hash is reduced to an index into an
+// array of a given capacity.  The two decisions go together, since each
+// way of reducing a hash only works well with certain capacities.
+//
+// A policy is a type with two static member functions:
+//
+//     // Returns the smallest capacity this policy allows that is at
+//     // least the given one.
+//     static unsigned int capacityAtLeast(unsigned int capacity) noexcept;
+//
+//     // Returns the index (less than capacity) for the given hash.
+//     static unsigned int indexFor(unsigned int hash, unsigned int capacity) noexcept;
+//
+// The policies here are:
+//
+//   * ModuloSizing, which allows any capacity and takes the hash modulo
+//     the capacity.  This is what a HashSet does by default.
+//   * PowerOfTwoSizing, which only allows powers of two, so the index is
+//     just the low bits of the hash; this is the cheapest, but it ignores
+//     the high bits, so it needs a hash whose low bits are good.
+//   * FastRangeSizing, which allows any capacity and multiplies the hash by
+//     the capacity, keeping the high 32 bits of the product.  That avoids
+//     a division, but it uses the high bits of the hash, so small hashes
+//     (such as integers hashed to themselves) all land in the first cell.
+//   * PrimeSizing, which only allows primes, roughly doubling, that aren't
+//     near a power of two, and takes the hash modulo the capacity.  This is
+//     the most forgiving of weak hashes, at the cost of a division.
+
+#ifndef BUCKETSIZING_HPP
+#define BUCKETSIZING_HPP
+
+#include <cstdint>
+
+
+
+struct ModuloSizing
+{
+    static unsigned int capacityAtLeast(unsigned int capacity) noexcept
+    {
+        return capacity;
+    }
+
+    static unsigned int indexFor(unsigned int hash, unsigned int capacity) noexcept
+    {
+        return hash % capacity;
+    }
+};
+
+
+struct PowerOfTwoSizing
+{
+    static unsigned int capacityAtLeast(unsigned int capacity) noexcept
+    {
+        unsigned int powerOfTwo = 1;
+        while (powerOfTwo < capacity && powerOfTwo < 0x80000000u)
+            powerOfTwo = powerOfTwo * 2;
+
+        return powerOfTwo;
+    }
+
+    static unsigned int indexFor(unsigned int hash, unsigned int capacity) noexcept
+    {
+        return hash & (capacity - 1);
+    }
+};
+
+
+struct FastRangeSizing
+{
+    static unsigned int capacityAtLeast(unsigned int capacity) noexcept
+    {
+        return capacity;
+    }
+
+    static unsigned int indexFor(unsigned int hash, unsigned int capacity) noexcept
+    {
+        return static_cast<unsigned int>((static_cast<std::uint64_t>(hash) * capacity) >> 32);
+    }
+};
+
+
+struct PrimeSizing
+{
+    static unsigned int capacityAtLeast(unsigned int capacity) noexcept
+    {
+        static constexpr unsigned int PRIMES[] = {
+            11u, 23u, 53u, 97u, 193u, 389u, 769u, 1543u, 3079u, 6151u, 12289u,
+            24593u, 49157u, 98317u, 196613u, 393241u, 786433u, 1572869u,
+            3145739u, 6291469u, 12582917u, 25165843u, 50331653u, 100663319u,
+            201326611u, 402653189u, 805306457u, 1610612741u, 3221225473u
+        };
+
+        for (unsigned int prime : PRIMES)
+        {
+            if (prime >= capacity)
+                return prime;
+        }
+
+        return PRIMES[sizeof(PRIMES) / sizeof(PRIMES[0]) - 1];
+    }
+
+    static unsigned int indexFor(unsigned int hash, unsigned int capacity) noexcept
+    {
+        return hash % capacity;
+    }
+};
+
+
+
+#endif // BUCKETSIZING_HPP
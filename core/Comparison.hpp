@@ -0,0 +1,108 @@
+// Comparison.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A comparison policy decides how an ordered set (such as an AVLSet)
+// compares two keys.  Rather than answering "is a less than b?" and then,
+// separately, "is a equal to b?", which takes two comparisons every time
+// a search descends a level, a policy answers both at once with a single
+// three-way comparison.  For strings, whose comparisons walk through their
+// characters, that halves the work of each step of a search.
+//
+// A policy is a type with one static member function template:
+//
+//     // Returns a negative number if a comes before b, 0 if they're
+//     // equivalent, and a positive number if a comes after b.
+//     template <typename A, typename B>
+//     static int compare(const A& a, const B& b);
+//
+// The function has to accept an ElementType for both a and b.  A policy
+// that also accepts other types (e.g., std::string_view for std::string
+// elements) allows those to be looked up without building an ElementType.
+//
+// The policy here is ThreeWayComparison, which is what an AVLSet uses by
+// default.  It calls a.compare(b) when there is such a member function
+// (as there is for std::string and std::string_view), subtracts the
+// results of > and < for arithmetic types, which doesn't branch, and
+// otherwise falls back on calling < in both directions.
+
+#ifndef COMPARISON_HPP
+#define COMPARISON_HPP
+
+#include <type_traits>
+#include <utility>
+
+
+
+namespace impl_
+{
+    template <typename A, typename B, typename = void>
+    struct Comparison__hasCompare : std::false_type
+    {
+    };
+
+    template <typename A, typename B>
+    struct Comparison__hasCompare<A, B, std::void_t<
+        decltype(static_cast<int>(std::declval<const A&>().compare(std::declval<const B&>())))>>
+        : std::true_type
+    {
+    };
+
+
+    template <typename A, typename B, typename = void>
+    struct Comparison__hasLess : std::false_type
+    {
+    };
+
+    template <typename A, typename B>
+    struct Comparison__hasLess<A, B, std::void_t<
+        decltype(std::declval<const A&>() < std::declval<const B&>()),
+        decltype(std::declval<const B&>() < std::declval<const A&>())>>
+        : std::true_type
+    {
+    };
+
+
+    // ThreeWayComparison::compare() only exists for the types it can
+    // actually compare, so that whether a key can be looked up can be
+    // decided by asking whether the comparison compiles.
+    template <typename A, typename B>
+    using Comparison__enableThreeWay = std::enable_if_t<
+        Comparison__hasCompare<A, B>::value || Comparison__hasLess<A, B>::value>;
+}
+
+
+struct ThreeWayComparison;
+
+
+namespace impl_
+{
+    // Whether a policy compares two numbers the usual way, in which case
+    // a search can use == and < directly, since each is one instruction.
+    template <typename Comparison, typename A, typename B>
+    struct Comparison__isArithmetic : std::bool_constant<
+        std::is_same<Comparison, ThreeWayComparison>::value
+        && std::is_arithmetic<A>::value && std::is_arithmetic<B>::value>
+    {
+    };
+}
+
+
+struct ThreeWayComparison
+{
+    template <typename A, typename B, typename = impl_::Comparison__enableThreeWay<A, B>>
+    static int compare(const A& a, const B& b)
+    {
+        if constexpr (impl_::Comparison__hasCompare<A, B>::value)
+            return a.compare(b);
+        else if constexpr (std::is_arithmetic<A>::value && std::is_arithmetic<B>::value)
+            return (a > b) - (a < b);
+        else
+            return a < b ? -1 : (b < a ? 1 : 0);
+    }
+};
+
+
+
+#endif // COMPARISON_HPP
@@ -0,0 +1,344 @@
+// ConcurrentHashSet.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A ConcurrentHashSet is a separately-chained hash table, like a HashSet,
+// that can safely be used by many threads at once.  Rather than one lock
+// protecting the whole table, the cells of the array are divided among a
+// fixed number of "stripes," each with its own reader/writer lock: cell i
+// belongs to stripe (i % STRIPE_COUNT).  Since the capacity is always a
+// multiple of STRIPE_COUNT, an element's stripe depends only on its hash,
+// never on the capacity, so it stays the same across resizes.
+//
+// contains() takes its stripe's lock in shared mode, so lookups of
+// different elements -- and even of the same element -- proceed in
+// parallel; add() takes its stripe's lock exclusively, so only additions
+// that land on the same stripe wait for one another.
+//
+// When the number of elements exceeds 0.8 times the capacity, the array
+// is doubled.  The thread that notices this acquires every stripe's lock
+// exclusively (always in the same order, so two resizing threads can't
+// deadlock), checks that no other thread already did the resize, and then
+// relinks every node into the new array.  Each stripe allocates its nodes
+// from its own NodePool; since a node never changes stripes, it never
+// changes pools either.
+
+#ifndef CONCURRENTHASHSET_HPP
+#define CONCURRENTHASHSET_HPP
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include "NodePool.hpp"
+#include "Set.hpp"
+
+
+
+template <typename ElementType, typename Hash = std::function<unsigned int(const ElementType&)>>
+class ConcurrentHashSet : public Set<ElementType>
+{
+public:
+    // The number of independently-locked stripes.
+    static constexpr unsigned int STRIPE_COUNT = 64;
+
+    // The default capacity of the ConcurrentHashSet before anything has
+    // been added to it.
+    static constexpr unsigned int DEFAULT_CAPACITY = STRIPE_COUNT;
+
+    // A HashFunction is a function that takes a reference to a const
+    // ElementType and returns an unsigned int.  It may be called from
+    // several threads at once.
+    using HashFunction = Hash;
+
+public:
+    // Initializes a ConcurrentHashSet to be empty, so that it will use the
+    // given hash function whenever it needs to hash an element.
+    explicit ConcurrentHashSet(HashFunction hashFunction);
+
+    // Cleans up the ConcurrentHashSet so that it leaks no memory.  No
+    // other thread may be using it at the time.
+    virtual ~ConcurrentHashSet() noexcept;
+
+    // Initializes a new ConcurrentHashSet to be a copy of an existing one,
+    // which other threads may continue to use while it's being copied.
+    ConcurrentHashSet(const ConcurrentHashSet& s);
+
+    // A ConcurrentHashSet can't be moved or assigned, since there's no
+    // way to do that while other threads might be using either one.
+    ConcurrentHashSet(ConcurrentHashSet&& s) = delete;
+    ConcurrentHashSet& operator=(const ConcurrentHashSet& s) = delete;
+    ConcurrentHashSet& operator=(ConcurrentHashSet&& s) = delete;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  It can be called by any number of
+    // threads at once, concurrently with calls to contains().
+    virtual void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  It can be called by any number of threads at once.
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // capacity() returns the number of cells in the array.
+    unsigned int capacity() const;
+
+
+    // elementsAtIndex() returns the number of elements that hashed to a
+    // particular index in the array.  If the index is out of the boundaries
+    // of the array, this function returns 0.
+    unsigned int elementsAtIndex(unsigned int index) const;
+
+
+    // isElementAtIndex() returns true if the given element hashed to a
+    // particular index in the array, false otherwise.  If the index is
+    // out of the boundaries of the array, this functions returns false.
+    bool isElementAtIndex(const ElementType& element, unsigned int index) const;
+
+
+private:
+    struct ListNode
+    {
+        ElementType key;
+        unsigned int hashCode;
+        ListNode* next;
+
+        ListNode(const ElementType& key, unsigned int hashCode, ListNode* next)
+            : key{key}, hashCode{hashCode}, next{next}
+        {
+        }
+    };
+
+    // Each stripe sits on its own cache line, so that threads locking
+    // different stripes don't contend for the same line.
+    struct alignas(64) Stripe
+    {
+        mutable std::shared_mutex lock;
+        NodePool<ListNode> nodes;
+    };
+
+    // findNode() returns the node containing the given element, or nullptr
+    // if there isn't one.  The caller must hold the element's stripe lock.
+    ListNode* findNode(const ElementType& element, unsigned int elementHash) const;
+
+    // resize() doubles the array, unless another thread already resized
+    // it after the caller saw the given capacity.  The caller must not
+    // hold any stripe locks.
+    void resize(unsigned int observedCapacity);
+
+    HashFunction hashFunction;
+    Stripe* stripes;
+
+    // The array and its capacity only change while every stripe lock is
+    // held exclusively, so holding any one stripe lock is enough to read
+    // them safely.
+    ListNode** hash;
+    unsigned int hash_capacity;
+
+    std::atomic<unsigned int> elementNumber;
+};
+
+
+
+template <typename ElementType, typename Hash>
+ConcurrentHashSet<ElementType, Hash>::ConcurrentHashSet(HashFunction hashFunction)
+    : hashFunction{hashFunction}, stripes{new Stripe[STRIPE_COUNT]},
+      hash{new ListNode*[DEFAULT_CAPACITY]()}, hash_capacity{DEFAULT_CAPACITY},
+      elementNumber{0}
+{
+}
+
+
+template <typename ElementType, typename Hash>
+ConcurrentHashSet<ElementType, Hash>::~ConcurrentHashSet() noexcept
+{
+    if (NodePool<ListNode>::NEEDS_DISCARD)
+    {
+        for (unsigned int i = 0; i < hash_capacity; ++i)
+        {
+            for (ListNode* node = hash[i]; node != nullptr; )
+            {
+                ListNode* next = node->next;
+                stripes[i % STRIPE_COUNT].nodes.discard(node);
+                node = next;
+            }
+        }
+    }
+
+    delete[] hash;
+    delete[] stripes;
+}
+
+
+template <typename ElementType, typename Hash>
+ConcurrentHashSet<ElementType, Hash>::ConcurrentHashSet(const ConcurrentHashSet& s)
+    : hashFunction{s.hashFunction}, stripes{new Stripe[STRIPE_COUNT]},
+      hash{nullptr}, hash_capacity{0}, elementNumber{0}
+{
+    for (unsigned int i = 0; i < STRIPE_COUNT; ++i)
+        s.stripes[i].lock.lock_shared();
+
+    hash_capacity = s.hash_capacity;
+    hash = new ListNode*[hash_capacity]();
+
+    for (unsigned int i = 0; i < hash_capacity; ++i)
+    {
+        NodePool<ListNode>& pool = stripes[i % STRIPE_COUNT].nodes;
+        for (ListNode* node = s.hash[i]; node != nullptr; node = node->next)
+            hash[i] = pool.create(node->key, node->hashCode, hash[i]);
+    }
+
+    elementNumber.store(s.elementNumber.load());
+
+    for (unsigned int i = 0; i < STRIPE_COUNT; ++i)
+        s.stripes[i].lock.unlock_shared();
+}
+
+
+template <typename ElementType, typename Hash>
+bool ConcurrentHashSet<ElementType, Hash>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType, typename Hash>
+void ConcurrentHashSet<ElementType, Hash>::add(const ElementType& element)
+{
+    unsigned int elementHash = hashFunction(element);
+    Stripe& stripe = stripes[elementHash % STRIPE_COUNT];
+    unsigned int observedCapacity;
+    unsigned int newSize;
+
+    {
+        std::unique_lock<std::shared_mutex> guard{stripe.lock};
+
+        if (findNode(element, elementHash) != nullptr)
+            return;
+
+        ListNode*& head = hash[elementHash % hash_capacity];
+        head = stripe.nodes.create(element, elementHash, head);
+
+        observedCapacity = hash_capacity;
+        newSize = elementNumber.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    if (newSize * 5 > observedCapacity * 4)
+        resize(observedCapacity);
+}
+
+
+template <typename ElementType, typename Hash>
+bool ConcurrentHashSet<ElementType, Hash>::contains(const ElementType& element) const
+{
+    unsigned int elementHash = hashFunction(element);
+    std::shared_lock<std::shared_mutex> guard{stripes[elementHash % STRIPE_COUNT].lock};
+    return findNode(element, elementHash) != nullptr;
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int ConcurrentHashSet<ElementType, Hash>::size() const noexcept
+{
+    return elementNumber.load(std::memory_order_relaxed);
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int ConcurrentHashSet<ElementType, Hash>::capacity() const
+{
+    std::shared_lock<std::shared_mutex> guard{stripes[0].lock};
+    return hash_capacity;
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int ConcurrentHashSet<ElementType, Hash>::elementsAtIndex(unsigned int index) const
+{
+    std::shared_lock<std::shared_mutex> guard{stripes[index % STRIPE_COUNT].lock};
+
+    if (index >= hash_capacity)
+        return 0;
+
+    unsigned int counter = 0;
+    for (ListNode* node = hash[index]; node != nullptr; node = node->next)
+        counter = counter + 1;
+
+    return counter;
+}
+
+
+template <typename ElementType, typename Hash>
+bool ConcurrentHashSet<ElementType, Hash>::isElementAtIndex(const ElementType& element, unsigned int index) const
+{
+    unsigned int elementHash = hashFunction(element);
+    std::shared_lock<std::shared_mutex> guard{stripes[elementHash % STRIPE_COUNT].lock};
+
+    return index < hash_capacity
+        && elementHash % hash_capacity == index
+        && findNode(element, elementHash) != nullptr;
+}
+
+
+template <typename ElementType, typename Hash>
+typename ConcurrentHashSet<ElementType, Hash>::ListNode* ConcurrentHashSet<ElementType, Hash>::findNode(
+    const ElementType& element, unsigned int elementHash) const
+{
+    for (ListNode* node = hash[elementHash % hash_capacity]; node != nullptr; node = node->next)
+    {
+        if (node->hashCode == elementHash && node->key == element)
+            return node;
+    }
+
+    return nullptr;
+}
+
+
+template <typename ElementType, typename Hash>
+void ConcurrentHashSet<ElementType, Hash>::resize(unsigned int observedCapacity)
+{
+    for (unsigned int i = 0; i < STRIPE_COUNT; ++i)
+        stripes[i].lock.lock();
+
+    // Some other thread may have gotten all of the locks first and done
+    // the resize already.
+    if (hash_capacity == observedCapacity)
+    {
+        unsigned int newCapacity = hash_capacity * 2;
+        ListNode** newHash = new ListNode*[newCapacity]();
+
+        for (unsigned int i = 0; i < hash_capacity; ++i)
+        {
+            while (hash[i] != nullptr)
+            {
+                ListNode* node = hash[i];
+                hash[i] = node->next;
+
+                ListNode*& head = newHash[node->hashCode % newCapacity];
+                node->next = head;
+                head = node;
+            }
+        }
+
+        delete[] hash;
+        hash = newHash;
+        hash_capacity = newCapacity;
+    }
+
+    for (unsigned int i = STRIPE_COUNT; i > 0; --i)
+        stripes[i - 1].lock.unlock();
+}
+
+
+
+#endif // CONCURRENTHASHSET_HPP
@@ -0,0 +1,173 @@
+// EpochReclaimer.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Implementation of the EpochReclaimer.
+
+#include "EpochReclaimer.hpp"
+
+
+
+namespace
+{
+    // Each reclaimer gets a distinct id, so that a thread's cached record
+    // can't be mistaken for one belonging to a different reclaimer that
+    // happens to live at the same address as a destroyed one.
+    std::atomic<unsigned long long> nextReclaimerId{1};
+}
+
+
+
+EpochReclaimer::Guard::Guard(ThreadRecord* record) noexcept
+    : record{record}
+{
+}
+
+
+EpochReclaimer::Guard::~Guard() noexcept
+{
+    record->depth = record->depth - 1;
+    if (record->depth == 0)
+        record->state.store(0, std::memory_order_release);
+}
+
+
+
+EpochReclaimer::EpochReclaimer()
+    : id{nextReclaimerId.fetch_add(1)}, globalEpoch{0}, records{nullptr},
+      retired{nullptr, nullptr, nullptr}, pending{0}
+{
+}
+
+
+EpochReclaimer::~EpochReclaimer() noexcept
+{
+    for (Retired* list : retired)
+        deleteAll(list);
+
+    Guard::ThreadRecord* record = records.load();
+    while (record != nullptr)
+    {
+        Guard::ThreadRecord* next = record->next;
+        delete record;
+        record = next;
+    }
+}
+
+
+EpochReclaimer::Guard EpochReclaimer::pin() const
+{
+    Guard::ThreadRecord* record = localRecord();
+
+    if (record->depth == 0)
+    {
+        unsigned long long epoch = globalEpoch.load(std::memory_order_acquire);
+        record->state.store((epoch << 1) | 1, std::memory_order_relaxed);
+
+        // The announcement has to be visible to writers before this thread
+        // reads any pointers out of the shared structure.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    record->depth = record->depth + 1;
+    return Guard{record};
+}
+
+
+void EpochReclaimer::retire(void* object, Deleter deleter)
+{
+    unsigned long long epoch = globalEpoch.load(std::memory_order_relaxed);
+    retired[epoch % 3] = new Retired{object, deleter, retired[epoch % 3]};
+    pending = pending + 1;
+
+    collect();
+}
+
+
+void EpochReclaimer::collect()
+{
+    if (tryAdvance())
+    {
+        // Everything retired two epochs ago is now unreachable.
+        unsigned long long epoch = globalEpoch.load(std::memory_order_relaxed);
+        Retired*& safe = retired[(epoch + 1) % 3];
+
+        for (Retired* r = safe; r != nullptr; r = r->next)
+            pending = pending - 1;
+
+        deleteAll(safe);
+        safe = nullptr;
+    }
+}
+
+
+unsigned int EpochReclaimer::pendingCount() const noexcept
+{
+    return pending;
+}
+
+
+EpochReclaimer::Guard::ThreadRecord* EpochReclaimer::localRecord() const
+{
+    thread_local unsigned long long cachedId = 0;
+    thread_local Guard::ThreadRecord* cachedRecord = nullptr;
+
+    if (cachedId == id)
+        return cachedRecord;
+
+    std::thread::id self = std::this_thread::get_id();
+    Guard::ThreadRecord* record = records.load(std::memory_order_acquire);
+    while (record != nullptr && record->owner != self)
+        record = record->next;
+
+    if (record == nullptr)
+    {
+        record = new Guard::ThreadRecord;
+        record->owner = self;
+
+        Guard::ThreadRecord* head = records.load(std::memory_order_relaxed);
+        do
+        {
+            record->next = head;
+        }
+        while (!records.compare_exchange_weak(head, record,
+                   std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    cachedId = id;
+    cachedRecord = record;
+    return record;
+}
+
+
+bool EpochReclaimer::tryAdvance()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    unsigned long long epoch = globalEpoch.load(std::memory_order_relaxed);
+    unsigned long long current = (epoch << 1) | 1;
+
+    for (Guard::ThreadRecord* record = records.load(std::memory_order_acquire);
+         record != nullptr; record = record->next)
+    {
+        unsigned long long state = record->state.load(std::memory_order_acquire);
+        if (state != 0 && state != current)
+            return false;
+    }
+
+    globalEpoch.store(epoch + 1, std::memory_order_release);
+    return true;
+}
+
+
+void EpochReclaimer::deleteAll(Retired* list) noexcept
+{
+    while (list != nullptr)
+    {
+        Retired* next = list->next;
+        list->deleter(list->object);
+        delete list;
+        list = next;
+    }
+}
@@ -0,0 +1,129 @@
+// EpochReclaimer.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// An EpochReclaimer decides when memory that has been unlinked from a
+// shared data structure can safely be deleted, even though reader threads
+// might have been in the middle of using it when it was unlinked, and even
+// though those readers never take any locks.  This is "epoch-based
+// reclamation."
+//
+// There is a global epoch counter.  A reader "pins" the reclaimer before
+// it touches the shared structure, which announces the current epoch in a
+// record that belongs only to that reader's thread, and unpins it when
+// it's done.  A writer that unlinks something "retires" it rather than
+// deleting it; the object is remembered along with the epoch in which it
+// was retired.  The global epoch can only advance once every pinned reader
+// has announced the current epoch, so once it has advanced twice past the
+// epoch an object was retired in, no reader can still be holding a pointer
+// to that object, and it is deleted.
+//
+// Readers may pin the reclaimer from any number of threads at once; each
+// thread writes only to its own record, which sits on its own cache line.
+// retire() and collect() must only be called by one thread at a time
+// (typically, a writer that holds the shared structure's write lock).
+
+#ifndef EPOCHRECLAIMER_HPP
+#define EPOCHRECLAIMER_HPP
+
+#include <atomic>
+#include <thread>
+
+
+
+class EpochReclaimer
+{
+public:
+    // A Deleter deletes one retired object.
+    using Deleter = void (*)(void*);
+
+    // A Guard keeps the reclaimer pinned by the current thread for as long
+    // as it exists; nothing retired while it exists will be deleted until
+    // it's gone.  Guards on the same thread can be nested.
+    class Guard
+    {
+    public:
+        ~Guard() noexcept;
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        friend class EpochReclaimer;
+        struct ThreadRecord;
+        explicit Guard(ThreadRecord* record) noexcept;
+
+        ThreadRecord* record;
+    };
+
+public:
+    // Initializes an EpochReclaimer with nothing retired.
+    EpochReclaimer();
+
+    // Deletes everything that has been retired.  No thread may have the
+    // reclaimer pinned at the time.
+    ~EpochReclaimer() noexcept;
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+
+    // pin() pins the reclaimer on the current thread, returning a Guard
+    // that unpins it when destroyed.
+    Guard pin() const;
+
+
+    // retire() arranges for the given object to be deleted, using the given
+    // deleter, once no reader could still be using it.  It also tries to
+    // advance the epoch and delete anything that has become safe to delete.
+    void retire(void* object, Deleter deleter);
+
+
+    // collect() tries to advance the epoch and deletes anything that has
+    // become safe to delete.
+    void collect();
+
+
+    // pendingCount() returns the number of objects that have been retired
+    // but not yet deleted.
+    unsigned int pendingCount() const noexcept;
+
+
+private:
+    struct Retired
+    {
+        void* object;
+        Deleter deleter;
+        Retired* next;
+    };
+
+    Guard::ThreadRecord* localRecord() const;
+    bool tryAdvance();
+    static void deleteAll(Retired* list) noexcept;
+
+    const unsigned long long id;
+    std::atomic<unsigned long long> globalEpoch;
+    mutable std::atomic<Guard::ThreadRecord*> records;
+
+    // Objects retired in epoch e are kept in retired[e % 3].
+    Retired* retired[3];
+    unsigned int pending;
+};
+
+
+
+// Each thread that pins a reclaimer gets a ThreadRecord in it, which is
+// kept until the reclaimer is destroyed.  Only the owning thread writes
+// "state"; the writer reads it when deciding whether to advance the epoch.
+struct alignas(64) EpochReclaimer::Guard::ThreadRecord
+{
+    // 0 when the thread isn't pinned; otherwise, (epoch << 1) | 1.
+    std::atomic<unsigned long long> state{0};
+    unsigned int depth = 0;
+    std::thread::id owner;
+    ThreadRecord* next = nullptr;
+};
+
+
+
+#endif // EPOCHRECLAIMER_HPP
@@ -0,0 +1,161 @@
+// FastHash.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Implementation of the FastHash functions.
+
+#include <cstring>
+#include "FastHash.hpp"
+
+
+
+namespace
+{
+    // Odd constants with roughly half of their bits set, chosen so that
+    // multiplying by them mixes well.
+    constexpr std::uint64_t SECRET0 = 0xa0761d6478bd642full;
+    constexpr std::uint64_t SECRET1 = 0xe7037ed1a0b428dbull;
+    constexpr std::uint64_t SECRET2 = 0x8ebc6af09c88c6e3ull;
+    constexpr std::uint64_t SECRET3 = 0x589965cc75374cc3ull;
+
+
+    // Replaces a and b with the low and high halves of their 128-bit
+    // product.
+    inline void multiply(std::uint64_t& a, std::uint64_t& b) noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        a = static_cast<std::uint64_t>(product);
+        b = static_cast<std::uint64_t>(product >> 64);
+#else
+        std::uint64_t aHigh = a >> 32, aLow = static_cast<std::uint32_t>(a);
+        std::uint64_t bHigh = b >> 32, bLow = static_cast<std::uint32_t>(b);
+        std::uint64_t high = aHigh * bHigh, middle0 = aHigh * bLow;
+        std::uint64_t middle1 = aLow * bHigh, low = aLow * bLow;
+        std::uint64_t t = low + (middle0 << 32);
+        std::uint64_t carry = t < low;
+        std::uint64_t lo = t + (middle1 << 32);
+        carry += lo < t;
+        a = lo;
+        b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+    }
+
+
+    // Multiplies a and b and folds the high half of the product into the
+    // low half.
+    inline std::uint64_t mix(std::uint64_t a, std::uint64_t b) noexcept
+    {
+        multiply(a, b);
+        return a ^ b;
+    }
+
+
+    // Reads eight or four bytes as one little-endian word; memcpy() is how
+    // to do that without caring whether the address is aligned.
+    inline std::uint64_t read8(const unsigned char* p) noexcept
+    {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+
+    inline std::uint64_t read4(const unsigned char* p) noexcept
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+
+    // Packs one to three bytes into a word, touching each byte only once.
+    inline std::uint64_t read3(const unsigned char* p, std::size_t k) noexcept
+    {
+        return (static_cast<std::uint64_t>(p[0]) << 16)
+            | (static_cast<std::uint64_t>(p[k >> 1]) << 8)
+            | p[k - 1];
+    }
+}
+
+
+
+std::uint64_t fastHash64(const void* data, std::size_t length, std::uint64_t seed) noexcept
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= mix(seed ^ SECRET0, SECRET1);
+
+    std::uint64_t a;
+    std::uint64_t b;
+
+    if (length <= 16)
+    {
+        // Short keys, which are nearly all of the words in a dictionary,
+        // are covered by two (possibly overlapping) reads from each end.
+        if (length >= 4)
+        {
+            std::size_t offset = (length >> 3) << 2;
+            a = (read4(p) << 32) | read4(p + offset);
+            b = (read4(p + length - 4) << 32) | read4(p + length - 4 - offset);
+        }
+        else if (length > 0)
+        {
+            a = read3(p, length);
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+    }
+    else
+    {
+        std::size_t remaining = length;
+
+        if (remaining > 48)
+        {
+            // Three independent lanes, so that the multiplications don't
+            // have to wait on one another.
+            std::uint64_t lane1 = seed;
+            std::uint64_t lane2 = seed;
+
+            do
+            {
+                seed = mix(read8(p) ^ SECRET1, read8(p + 8) ^ seed);
+                lane1 = mix(read8(p + 16) ^ SECRET2, read8(p + 24) ^ lane1);
+                lane2 = mix(read8(p + 32) ^ SECRET3, read8(p + 40) ^ lane2);
+                p += 48;
+                remaining -= 48;
+            }
+            while (remaining > 48);
+
+            seed ^= lane1 ^ lane2;
+        }
+
+        while (remaining > 16)
+        {
+            seed = mix(read8(p) ^ SECRET1, read8(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+
+        a = read8(p + remaining - 16);
+        b = read8(p + remaining - 8);
+    }
+
+    a ^= SECRET1;
+    b ^= seed;
+    multiply(a, b);
+    return mix(a ^ SECRET0 ^ length, b ^ SECRET1);
+}
+
+
+std::uint64_t fastHash64(std::uint64_t value, std::uint64_t seed) noexcept
+{
+    std::uint64_t a = value ^ SECRET0;
+    std::uint64_t b = seed ^ SECRET1;
+    multiply(a, b);
+    return mix(a ^ SECRET0, b ^ SECRET1);
+}
@@ -0,0 +1,92 @@
+// FastHash.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// FastHash is a family of seedable hash functions for the hash-based sets,
+// in the style of wyhash.  Rather than mixing one byte at a time, it reads
+// its input eight bytes at a time and mixes each pair of words with one
+// 64x64-bit multiplication, folding the high half of the 128-bit product
+// back into the low half.  That is fast, and it spreads every input bit
+// across all 64 bits of the result, so the low bits that a hash table
+// actually uses to pick a cell are as good as the high ones.
+//
+// fastHash64() computes the full 64-bit hash of a sequence of bytes or of
+// one integer.  FastHash<T> is a function object that hashes a T and folds
+// the result into an unsigned int, which is what the sets expect from a
+// hash function; it's defined for std::string (and, since it's transparent,
+// std::string_view) and for the integral types.  Two FastHash objects with
+// different seeds hash the same key to unrelated values.
+
+#ifndef FASTHASH_HPP
+#define FASTHASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+
+// fastHash64() returns the 64-bit hash of the given number of bytes
+// starting at the given address, using the given seed.
+std::uint64_t fastHash64(const void* data, std::size_t length, std::uint64_t seed = 0) noexcept;
+
+
+// fastHash64() returns the 64-bit hash of one 64-bit value, using the
+// given seed.  This is much cheaper than hashing the value's bytes.
+std::uint64_t fastHash64(std::uint64_t value, std::uint64_t seed) noexcept;
+
+
+// foldHash() reduces a 64-bit hash to an unsigned int, keeping some
+// influence from every bit of it.
+inline unsigned int foldHash(std::uint64_t hash) noexcept
+{
+    return static_cast<unsigned int>(hash ^ (hash >> 32));
+}
+
+
+
+template <typename T, typename = void>
+struct FastHash;
+
+
+template <>
+struct FastHash<std::string>
+{
+    using is_transparent = void;
+
+    explicit FastHash(std::uint64_t seed = 0) noexcept
+        : seed{seed}
+    {
+    }
+
+    unsigned int operator()(std::string_view s) const noexcept
+    {
+        return foldHash(fastHash64(s.data(), s.size(), seed));
+    }
+
+    std::uint64_t seed;
+};
+
+
+template <typename T>
+struct FastHash<T, std::enable_if_t<std::is_integral<T>::value>>
+{
+    explicit FastHash(std::uint64_t seed = 0) noexcept
+        : seed{seed}
+    {
+    }
+
+    unsigned int operator()(const T& value) const noexcept
+    {
+        return foldHash(fastHash64(static_cast<std::uint64_t>(value), seed));
+    }
+
+    std::uint64_t seed;
+};
+
+
+
+#endif // FASTHASH_HPP
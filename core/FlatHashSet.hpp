@@ -0,0 +1,454 @@
+// FlatHashSet.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A FlatHashSet is an implementation of a Set that is an open-addressing
+// hash table in the style of a "Swiss table."  Rather than hanging a linked
+// list off of each cell, the elements are stored directly in one contiguous
+// array of slots, alongside a parallel array of one-byte "control" values.
+// Each control byte is either EMPTY or holds the low 7 bits of the hash of
+// the element stored in the corresponding slot.
+//
+// The slots are divided into groups of GROUP_WIDTH consecutive slots.  The
+// remaining bits of an element's hash choose the group where a search for
+// it begins (its "home" group).  A search compares all of the control bytes
+// in a group at once -- using SSE2 instructions when they're available --
+// and only looks at the slots whose control byte matches, so nearly every
+// lookup is resolved by one pass over one group.  If the group is full and
+// the element wasn't found, the search moves on to other groups, stopping
+// as soon as it sees a group with an EMPTY slot in it.
+//
+// The table doubles in size whenever adding an element would make it more
+// than 7/8 full.
+
+#ifndef FLATHASHSET_HPP
+#define FLATHASHSET_HPP
+
+#include <functional>
+#include <utility>
+#include "Set.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+
+template <typename ElementType, typename Hash = std::function<unsigned int(const ElementType&)>>
+class FlatHashSet : public Set<ElementType>
+{
+public:
+    // The number of slots whose control bytes are compared at once.
+    static constexpr unsigned int GROUP_WIDTH = 16;
+
+    // The default capacity of the FlatHashSet before anything has been
+    // added to it.  The capacity is always a power of two and a multiple
+    // of GROUP_WIDTH.
+    static constexpr unsigned int DEFAULT_CAPACITY = 16;
+
+    // A HashFunction is a function that takes a reference to a const
+    // ElementType and returns an unsigned int.  By default, it can be any
+    // such function, but a FlatHashSet whose Hash is a particular function
+    // object type calls it directly, so the compiler can inline it.
+    using HashFunction = Hash;
+
+public:
+    // Initializes a FlatHashSet to be empty, so that it will use the given
+    // hash function whenever it needs to hash an element.
+    explicit FlatHashSet(HashFunction hashFunction);
+
+    // Cleans up the FlatHashSet so that it leaks no memory.
+    virtual ~FlatHashSet() noexcept;
+
+    // Initializes a new FlatHashSet to be a copy of an existing one.
+    FlatHashSet(const FlatHashSet& s);
+
+    // Initializes a new FlatHashSet whose contents are moved from an
+    // expiring one.
+    FlatHashSet(FlatHashSet&& s) noexcept;
+
+    // Assigns an existing FlatHashSet into another.
+    FlatHashSet& operator=(const FlatHashSet& s);
+
+    // Assigns an expiring FlatHashSet into another.
+    FlatHashSet& operator=(FlatHashSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the set,
+    // this function has no effect.  This function triggers a doubling of the
+    // table when it would otherwise become more than 7/8 full, in which case
+    // it runs in linear time; otherwise, it runs in constant time (assuming
+    // a good hash function).
+    virtual void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function runs in constant time (assuming a
+    // good hash function).
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // capacity() returns the number of slots in the table.
+    unsigned int capacity() const noexcept;
+
+
+    // elementsAtIndex() returns the number of elements whose home group is
+    // the group with the given index, regardless of which group they were
+    // ultimately stored in.  If the index is out of the boundaries of the
+    // array of groups, this function returns 0.
+    unsigned int elementsAtIndex(unsigned int index) const;
+
+
+    // isElementAtIndex() returns true if the given element is in the set
+    // and its home group is the group with the given index, false
+    // otherwise.  If the index is out of the boundaries of the array of
+    // groups, this function returns false.
+    bool isElementAtIndex(const ElementType& element, unsigned int index) const;
+
+
+private:
+    static constexpr signed char EMPTY = -128;
+
+    // A Group is a view of GROUP_WIDTH consecutive control bytes, which
+    // can be searched for a particular value all at once.  The results
+    // are bitmasks with bit i set when control byte i matched.
+    struct Group
+    {
+        const signed char* control;
+
+        unsigned int match(signed char h2) const noexcept
+        {
+#if defined(__SSE2__)
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+            return static_cast<unsigned int>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+#else
+            unsigned int mask = 0;
+            for (unsigned int i = 0; i < GROUP_WIDTH; ++i)
+            {
+                if (control[i] == h2)
+                    mask |= 1u << i;
+            }
+            return mask;
+#endif
+        }
+
+        unsigned int matchEmpty() const noexcept
+        {
+            return match(EMPTY);
+        }
+    };
+
+    static unsigned int lowestBit(unsigned int mask) noexcept
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#else
+        unsigned int i = 0;
+        while ((mask & 1u) == 0)
+        {
+            mask >>= 1;
+            ++i;
+        }
+        return i;
+#endif
+    }
+
+    // The high bits of a hash choose the home group; the low 7 bits are
+    // what gets stored in the control byte.
+    static unsigned int h1(unsigned int hash) noexcept { return hash >> 7; }
+    static signed char h2(unsigned int hash) noexcept { return static_cast<signed char>(hash & 0x7F); }
+
+    unsigned int groupCount() const noexcept { return slotCapacity / GROUP_WIDTH; }
+
+    // findSlot() returns the index of the slot holding the given element,
+    // or -1 if it isn't in the table.
+    int findSlot(const ElementType& element, unsigned int hash) const;
+
+    // insertNew() stores an element known not to be in the table already
+    // into the first EMPTY slot on its probe sequence.
+    void insertNew(ElementType&& element, unsigned int hash);
+
+    void allocate(unsigned int newCapacity);
+    void rehash(unsigned int newCapacity);
+    void copyFrom(const FlatHashSet& s);
+
+    HashFunction hashFunction;
+    signed char* control;
+    ElementType* slots;
+    unsigned int slotCapacity;
+    unsigned int elementNumber;
+};
+
+
+
+template <typename ElementType, typename Hash>
+FlatHashSet<ElementType, Hash>::FlatHashSet(HashFunction hashFunction)
+    : hashFunction{hashFunction}, control{nullptr}, slots{nullptr},
+      slotCapacity{0}, elementNumber{0}
+{
+    allocate(DEFAULT_CAPACITY);
+}
+
+
+template <typename ElementType, typename Hash>
+FlatHashSet<ElementType, Hash>::~FlatHashSet() noexcept
+{
+    delete[] control;
+    delete[] slots;
+}
+
+
+template <typename ElementType, typename Hash>
+FlatHashSet<ElementType, Hash>::FlatHashSet(const FlatHashSet& s)
+    : hashFunction{s.hashFunction}, control{nullptr}, slots{nullptr},
+      slotCapacity{0}, elementNumber{0}
+{
+    copyFrom(s);
+}
+
+
+template <typename ElementType, typename Hash>
+FlatHashSet<ElementType, Hash>::FlatHashSet(FlatHashSet&& s) noexcept
+    : hashFunction{std::move(s.hashFunction)}, control{s.control}, slots{s.slots},
+      slotCapacity{s.slotCapacity}, elementNumber{s.elementNumber}
+{
+    s.control = nullptr;
+    s.slots = nullptr;
+    s.slotCapacity = 0;
+    s.elementNumber = 0;
+}
+
+
+template <typename ElementType, typename Hash>
+FlatHashSet<ElementType, Hash>& FlatHashSet<ElementType, Hash>::operator=(const FlatHashSet& s)
+{
+    if (this != &s)
+    {
+        delete[] control;
+        delete[] slots;
+        control = nullptr;
+        slots = nullptr;
+        slotCapacity = 0;
+        elementNumber = 0;
+
+        hashFunction = s.hashFunction;
+        copyFrom(s);
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType, typename Hash>
+FlatHashSet<ElementType, Hash>& FlatHashSet<ElementType, Hash>::operator=(FlatHashSet&& s) noexcept
+{
+    std::swap(hashFunction, s.hashFunction);
+    std::swap(control, s.control);
+    std::swap(slots, s.slots);
+    std::swap(slotCapacity, s.slotCapacity);
+    std::swap(elementNumber, s.elementNumber);
+    return *this;
+}
+
+
+template <typename ElementType, typename Hash>
+bool FlatHashSet<ElementType, Hash>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType, typename Hash>
+void FlatHashSet<ElementType, Hash>::add(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    if (findSlot(element, hash) >= 0)
+        return;
+
+    // A moved-from set has no table at all, so it grows like any other.
+    if (slotCapacity == 0)
+        rehash(DEFAULT_CAPACITY);
+    else if ((elementNumber + 1) * 8 > slotCapacity * 7)
+        rehash(slotCapacity * 2);
+
+    ElementType copyElement = element;
+    insertNew(std::move(copyElement), hash);
+}
+
+
+template <typename ElementType, typename Hash>
+bool FlatHashSet<ElementType, Hash>::contains(const ElementType& element) const
+{
+    return findSlot(element, hashFunction(element)) >= 0;
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int FlatHashSet<ElementType, Hash>::size() const noexcept
+{
+    return elementNumber;
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int FlatHashSet<ElementType, Hash>::capacity() const noexcept
+{
+    return slotCapacity;
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int FlatHashSet<ElementType, Hash>::elementsAtIndex(unsigned int index) const
+{
+    if (index >= groupCount())
+        return 0;
+
+    unsigned int counter = 0;
+    for (unsigned int i = 0; i < slotCapacity; ++i)
+    {
+        if (control[i] != EMPTY
+            && (h1(hashFunction(slots[i])) & (groupCount() - 1)) == index)
+        {
+            counter = counter + 1;
+        }
+    }
+    return counter;
+}
+
+
+template <typename ElementType, typename Hash>
+bool FlatHashSet<ElementType, Hash>::isElementAtIndex(const ElementType& element, unsigned int index) const
+{
+    if (index >= groupCount())
+        return false;
+
+    unsigned int hash = hashFunction(element);
+    return (h1(hash) & (groupCount() - 1)) == index && findSlot(element, hash) >= 0;
+}
+
+
+template <typename ElementType, typename Hash>
+int FlatHashSet<ElementType, Hash>::findSlot(const ElementType& element, unsigned int hash) const
+{
+    if (slotCapacity == 0)
+        return -1;
+
+    unsigned int groupMask = groupCount() - 1;
+    unsigned int group = h1(hash) & groupMask;
+    signed char tag = h2(hash);
+
+    // Triangular probing over a power-of-two number of groups visits
+    // every group exactly once before repeating.
+    for (unsigned int step = 1; step <= groupCount(); ++step)
+    {
+        Group g{control + group * GROUP_WIDTH};
+
+        for (unsigned int mask = g.match(tag); mask != 0; mask &= mask - 1)
+        {
+            unsigned int slot = group * GROUP_WIDTH + lowestBit(mask);
+            if (slots[slot] == element)
+                return static_cast<int>(slot);
+        }
+
+        if (g.matchEmpty() != 0)
+            return -1;
+
+        group = (group + step) & groupMask;
+    }
+
+    return -1;
+}
+
+
+template <typename ElementType, typename Hash>
+void FlatHashSet<ElementType, Hash>::insertNew(ElementType&& element, unsigned int hash)
+{
+    unsigned int groupMask = groupCount() - 1;
+    unsigned int group = h1(hash) & groupMask;
+
+    for (unsigned int step = 1; ; ++step)
+    {
+        unsigned int empty = Group{control + group * GROUP_WIDTH}.matchEmpty();
+        if (empty != 0)
+        {
+            unsigned int slot = group * GROUP_WIDTH + lowestBit(empty);
+            control[slot] = h2(hash);
+            slots[slot] = std::move(element);
+            elementNumber = elementNumber + 1;
+            return;
+        }
+
+        group = (group + step) & groupMask;
+    }
+}
+
+
+template <typename ElementType, typename Hash>
+void FlatHashSet<ElementType, Hash>::allocate(unsigned int newCapacity)
+{
+    control = new signed char[newCapacity];
+    slots = new ElementType[newCapacity];
+    slotCapacity = newCapacity;
+    elementNumber = 0;
+
+    for (unsigned int i = 0; i < newCapacity; ++i)
+        control[i] = EMPTY;
+}
+
+
+template <typename ElementType, typename Hash>
+void FlatHashSet<ElementType, Hash>::rehash(unsigned int newCapacity)
+{
+    signed char* oldControl = control;
+    ElementType* oldSlots = slots;
+    unsigned int oldCapacity = slotCapacity;
+
+    allocate(newCapacity);
+
+    for (unsigned int i = 0; i < oldCapacity; ++i)
+    {
+        if (oldControl[i] != EMPTY)
+        {
+            unsigned int hash = hashFunction(oldSlots[i]);
+            insertNew(std::move(oldSlots[i]), hash);
+        }
+    }
+
+    delete[] oldControl;
+    delete[] oldSlots;
+}
+
+
+template <typename ElementType, typename Hash>
+void FlatHashSet<ElementType, Hash>::copyFrom(const FlatHashSet& s)
+{
+    if (s.slotCapacity == 0)
+    {
+        allocate(DEFAULT_CAPACITY);
+        return;
+    }
+
+    allocate(s.slotCapacity);
+
+    for (unsigned int i = 0; i < slotCapacity; ++i)
+    {
+        control[i] = s.control[i];
+        if (control[i] != EMPTY)
+            slots[i] = s.slots[i];
+    }
+
+    elementNumber = s.elementNumber;
+}
+
+
+
+#endif // FLATHASHSET_HPP
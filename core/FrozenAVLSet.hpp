@@ -0,0 +1,443 @@
+// FrozenAVLSet.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A FrozenAVLSet is a snapshot of an AVLSet's elements, usually made by
+// calling the AVLSet's freeze() function, that never changes afterward;
+// add() throws a std::logic_error.  It's meant for sets that are built
+// once and then looked up in many times, like a dictionary.
+//
+// An AVLSet's nodes are allocated separately, and each holds three pointers
+// besides its element, so looking an element up in a large one takes a
+// cache miss at almost every level of the tree.  A FrozenAVLSet has no
+// nodes and no pointers.  Its elements are stored in one array, in the
+// order that a breadth-first traversal of a perfectly balanced binary
+// search tree would visit them (sometimes called "Eytzinger order," after
+// the way family trees are numbered): the root is at index 0, and the
+// children of the element at index i are at indexes 2i + 1 and 2i + 2.
+// A search starts at the root and moves to one child or the other, so
+// finding the next index is arithmetic rather than a pointer that has to
+// be loaded first.
+//
+// Because the loop that descends the tree runs the same number of times
+// (give or take one) for every key and only chooses an index, it doesn't
+// branch on the comparisons; which element was the answer is worked out
+// from the final index at the end.  The descendants of an element a few
+// levels down are next to one another in the array, so each step
+// prefetches all of them, in one to four cache lines, well before the
+// search gets there; the array is placed in memory so that those groups
+// start on a cache line boundary.
+
+#ifndef FROZENAVLSET_HPP
+#define FROZENAVLSET_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "Comparison.hpp"
+#include "Set.hpp"
+
+
+
+namespace impl_
+{
+    // A Key can be looked up in a FrozenAVLSet<ElementType, Comparison>
+    // without converting it to an ElementType when the comparison policy
+    // can compare the two (e.g., std::string_view and std::string).
+    template <typename ElementType, typename Comparison, typename Key, typename = void>
+    struct FrozenAVLSet__isComparable : std::false_type
+    {
+    };
+
+    template <typename ElementType, typename Comparison, typename Key>
+    struct FrozenAVLSet__isComparable<ElementType, Comparison, Key, std::void_t<
+        decltype(Comparison::compare(std::declval<const Key&>(), std::declval<const ElementType&>()))>>
+        : std::true_type
+    {
+    };
+
+
+    template <typename ElementType, typename Comparison, typename Key>
+    using FrozenAVLSet__enableHeterogeneous = std::enable_if_t<
+        FrozenAVLSet__isComparable<ElementType, Comparison, Key>::value
+        && !std::is_same<Key, ElementType>::value>;
+}
+
+
+
+template <typename ElementType, typename Comparison>
+class AVLSet;
+
+
+template <typename ElementType, typename Comparison = ThreeWayComparison>
+class FrozenAVLSet : public Set<ElementType>
+{
+public:
+    // Initializes a FrozenAVLSet with no elements.
+    FrozenAVLSet() noexcept;
+
+    // Initializes a FrozenAVLSet containing the elements in the range
+    // [first, last), which must be in strictly ascending order, as decided
+    // by the comparison policy; if they aren't, the set will not find its
+    // elements reliably.  Each element is copied exactly once, straight
+    // into its place in the array, in O(n) time.
+    template <typename ForwardIterator>
+    FrozenAVLSet(ForwardIterator first, ForwardIterator last);
+
+    // Cleans up the FrozenAVLSet so that it leaks no memory.
+    virtual ~FrozenAVLSet() noexcept;
+
+    // Initializes a new FrozenAVLSet to be a copy of an existing one.
+    FrozenAVLSet(const FrozenAVLSet& s);
+
+    // Initializes a new FrozenAVLSet whose contents are moved from an
+    // expiring one.
+    FrozenAVLSet(FrozenAVLSet&& s) noexcept;
+
+    // Assigns an existing FrozenAVLSet into another.
+    FrozenAVLSet& operator=(const FrozenAVLSet& s);
+
+    // Assigns an expiring FrozenAVLSet into another.
+    FrozenAVLSet& operator=(FrozenAVLSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() throws a std::logic_error, since a FrozenAVLSet can't be
+    // changed once it's been built.
+    virtual void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is in the set, false
+    // otherwise.  This function always runs in O(log n) time, comparing
+    // the element once per level of the tree and once more at the end.
+    virtual bool contains(const ElementType& element) const override;
+
+    // contains() can also look up a key of some other type that the
+    // comparison policy can compare to an ElementType, such as a
+    // std::string_view in a FrozenAVLSet<std::string>, without building
+    // an ElementType first.
+    template <typename Key, typename = impl_::FrozenAVLSet__enableHeterogeneous<ElementType, Comparison, Key>>
+    bool contains(const Key& key) const;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // memoryUsage() returns the number of bytes of memory allocated to
+    // hold the set's elements (not counting anything the elements
+    // themselves allocate, such as a long std::string's characters).
+    std::size_t memoryUsage() const noexcept;
+
+
+private:
+    friend class AVLSet<ElementType, Comparison>;
+
+    // Initializes a FrozenAVLSet containing the "count" elements starting
+    // at "first", which are in strictly ascending order, so that a range
+    // whose size is already known doesn't have to be walked twice.
+    template <typename ForwardIterator>
+    FrozenAVLSet(ForwardIterator first, unsigned int count);
+
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    static constexpr std::size_t ALIGNMENT = std::max(CACHE_LINE, alignof(ElementType));
+
+    // The number of levels below the current element whose descendants
+    // are prefetched at each step of a search: as many as fit into four
+    // cache lines, but at least one, and no more than four, since
+    // prefetching further ahead than the latency of memory is no help.
+    // (For ints, that's four levels in a single cache line; for
+    // std::strings, three levels in four lines, which measured noticeably
+    // faster than one level in one line.)
+    static constexpr std::size_t PREFETCH_BYTES = 4 * CACHE_LINE;
+
+    static constexpr unsigned int PREFETCH_LEVELS =
+        sizeof(ElementType) * 16 <= PREFETCH_BYTES ? 4
+        : sizeof(ElementType) * 8 <= PREFETCH_BYTES ? 3
+        : sizeof(ElementType) * 4 <= PREFETCH_BYTES ? 2
+        : 1;
+
+    static constexpr std::size_t PREFETCH_SPAN = std::size_t{1} << PREFETCH_LEVELS;
+
+    // Returns the index of the smallest element that is not less than the
+    // given key, or elementNumber if there isn't one.
+    template <typename Key>
+    std::size_t lowerBound(const Key& key) const noexcept;
+
+    // layOut() copies elements from "next", in ascending order, into the
+    // subtree rooted at the given index of a tree with "count" elements,
+    // so that calling it on index 0 fills the whole array.
+    template <typename ForwardIterator>
+    void layOut(ForwardIterator& next, std::size_t index, unsigned int count);
+
+    // allocate() makes room for the given number of elements, placed so
+    // that the descendants that are prefetched together start on a cache
+    // line boundary.  The elements aren't initialized, so elementNumber,
+    // which counts the elements that release() destroys, is left at 0.
+    void allocate(unsigned int count);
+
+    // release() destroys the elements and frees their memory, leaving the
+    // set empty.
+    void release() noexcept;
+
+    static void prefetch(const void* address) noexcept;
+
+    ElementType* elements;
+    unsigned int elementNumber;
+
+    // The memory that was allocated, which begins a little before the
+    // elements themselves.
+    void* storage;
+};
+
+
+
+template <typename ElementType, typename Comparison>
+FrozenAVLSet<ElementType, Comparison>::FrozenAVLSet() noexcept
+    : elements{nullptr}, elementNumber{0}, storage{nullptr}
+{
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename ForwardIterator>
+FrozenAVLSet<ElementType, Comparison>::FrozenAVLSet(ForwardIterator first, ForwardIterator last)
+    : FrozenAVLSet{first, static_cast<unsigned int>(std::distance(first, last))}
+{
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename ForwardIterator>
+FrozenAVLSet<ElementType, Comparison>::FrozenAVLSet(ForwardIterator first, unsigned int count)
+    : FrozenAVLSet{}
+{
+    allocate(count);
+    layOut(first, 0, count);
+    elementNumber = count;
+}
+
+
+template <typename ElementType, typename Comparison>
+FrozenAVLSet<ElementType, Comparison>::~FrozenAVLSet() noexcept
+{
+    release();
+}
+
+
+template <typename ElementType, typename Comparison>
+FrozenAVLSet<ElementType, Comparison>::FrozenAVLSet(const FrozenAVLSet& s)
+    : FrozenAVLSet{}
+{
+    allocate(s.elementNumber);
+
+    for (; elementNumber < s.elementNumber; ++elementNumber)
+        new (elements + elementNumber) ElementType{s.elements[elementNumber]};
+}
+
+
+template <typename ElementType, typename Comparison>
+FrozenAVLSet<ElementType, Comparison>::FrozenAVLSet(FrozenAVLSet&& s) noexcept
+    : FrozenAVLSet{}
+{
+    std::swap(elements, s.elements);
+    std::swap(elementNumber, s.elementNumber);
+    std::swap(storage, s.storage);
+}
+
+
+template <typename ElementType, typename Comparison>
+FrozenAVLSet<ElementType, Comparison>& FrozenAVLSet<ElementType, Comparison>::operator=(const FrozenAVLSet& s)
+{
+    if (this != &s)
+    {
+        FrozenAVLSet copied{s};
+        *this = std::move(copied);
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType, typename Comparison>
+FrozenAVLSet<ElementType, Comparison>& FrozenAVLSet<ElementType, Comparison>::operator=(FrozenAVLSet&& s) noexcept
+{
+    std::swap(elements, s.elements);
+    std::swap(elementNumber, s.elementNumber);
+    std::swap(storage, s.storage);
+    return *this;
+}
+
+
+template <typename ElementType, typename Comparison>
+bool FrozenAVLSet<ElementType, Comparison>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType, typename Comparison>
+void FrozenAVLSet<ElementType, Comparison>::add(const ElementType&)
+{
+    throw std::logic_error{"A FrozenAVLSet can't be changed once it's been built"};
+}
+
+
+template <typename ElementType, typename Comparison>
+bool FrozenAVLSet<ElementType, Comparison>::contains(const ElementType& element) const
+{
+    return contains<ElementType, void>(element);
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename Key, typename>
+bool FrozenAVLSet<ElementType, Comparison>::contains(const Key& key) const
+{
+    std::size_t index = lowerBound(key);
+
+    if (index == elementNumber)
+        return false;
+    else if constexpr (impl_::Comparison__isArithmetic<Comparison, Key, ElementType>::value)
+        return elements[index] == key;
+    else
+        return Comparison::compare(key, elements[index]) == 0;
+}
+
+
+template <typename ElementType, typename Comparison>
+unsigned int FrozenAVLSet<ElementType, Comparison>::size() const noexcept
+{
+    return elementNumber;
+}
+
+
+template <typename ElementType, typename Comparison>
+std::size_t FrozenAVLSet<ElementType, Comparison>::memoryUsage() const noexcept
+{
+    return storage == nullptr ? 0 : sizeof(ElementType) * elementNumber + ALIGNMENT;
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename Key>
+std::size_t FrozenAVLSet<ElementType, Comparison>::lowerBound(const Key& key) const noexcept
+{
+    // Each step goes to the right child when the element is less than the
+    // key and to the left child otherwise, which is a comparison and an
+    // addition rather than a branch, until it falls off the bottom of the
+    // tree.
+    std::size_t index = 0;
+
+    while (index < elementNumber)
+    {
+        // Near the bottom of the tree, the descendants are past the end of
+        // the array, and forming a pointer to them would be undefined, so
+        // their address is computed as an integer.  Prefetching an address
+        // that isn't there is harmless, and cheaper than checking.
+        std::uintptr_t descendants = reinterpret_cast<std::uintptr_t>(elements)
+            + ((index + 1) * PREFETCH_SPAN - 1) * sizeof(ElementType);
+
+        for (std::size_t offset = 0; offset < PREFETCH_SPAN * sizeof(ElementType); offset += CACHE_LINE)
+            prefetch(reinterpret_cast<const void*>(descendants + offset));
+
+        if constexpr (impl_::Comparison__isArithmetic<Comparison, Key, ElementType>::value)
+            index = 2 * index + 1 + (elements[index] < key);
+        else
+            index = 2 * index + 1 + (Comparison::compare(key, elements[index]) > 0);
+    }
+
+    // Numbering the elements from 1 instead (so the children of k are 2k
+    // and 2k + 1), each step appended one bit to k: 1 for going right and
+    // 0 for going left.  The lower bound is the last element the search
+    // went left from, so dropping the trailing 1s and then the 0 before
+    // them leaves its number; if the search never went left, that leaves
+    // 0, and there is no lower bound.
+    std::size_t k = index + 1;
+    std::size_t shift = 1;
+
+#if defined(__GNUC__)
+    shift += static_cast<std::size_t>(__builtin_ctzll(~static_cast<unsigned long long>(k)));
+#else
+    for (std::size_t bits = k; (bits & 1) != 0; bits >>= 1)
+        ++shift;
+#endif
+
+    k >>= shift;
+    return k == 0 ? elementNumber : k - 1;
+}
+
+
+template <typename ElementType, typename Comparison>
+template <typename ForwardIterator>
+void FrozenAVLSet<ElementType, Comparison>::layOut(ForwardIterator& next, std::size_t index, unsigned int count)
+{
+    // The array is filled by an inorder traversal of the implicit tree,
+    // which visits the indexes in exactly the order their elements come
+    // from the range.  The recursion is only as deep as the tree is tall.
+    if (index >= count)
+        return;
+
+    layOut(next, 2 * index + 1, count);
+    new (elements + index) ElementType{*next};
+    ++next;
+    layOut(next, 2 * index + 2, count);
+}
+
+
+template <typename ElementType, typename Comparison>
+void FrozenAVLSet<ElementType, Comparison>::allocate(unsigned int count)
+{
+    if (count == 0)
+        return;
+
+    // The descendants of index i that are prefetched together start at
+    // index (i + 1) * PREFETCH_SPAN - 1, so the elements start far enough
+    // into an aligned block that index PREFETCH_SPAN - 1 is at the start
+    // of a cache line.
+    std::size_t offset = (CACHE_LINE - (PREFETCH_SPAN - 1) * sizeof(ElementType) % CACHE_LINE) % CACHE_LINE;
+
+    storage = ::operator new(sizeof(ElementType) * count + ALIGNMENT, std::align_val_t{ALIGNMENT});
+    elements = reinterpret_cast<ElementType*>(static_cast<unsigned char*>(storage) + offset);
+}
+
+
+template <typename ElementType, typename Comparison>
+void FrozenAVLSet<ElementType, Comparison>::release() noexcept
+{
+    if (storage == nullptr)
+        return;
+
+    for (unsigned int i = 0; i < elementNumber; ++i)
+        elements[i].~ElementType();
+
+    ::operator delete(storage, std::align_val_t{ALIGNMENT});
+
+    elements = nullptr;
+    elementNumber = 0;
+    storage = nullptr;
+}
+
+
+template <typename ElementType, typename Comparison>
+void FrozenAVLSet<ElementType, Comparison>::prefetch(const void* address) noexcept
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void) address;
+#endif
+}
+
+
+
+#endif // FROZENAVLSET_HPP
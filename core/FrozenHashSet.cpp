@@ -0,0 +1,629 @@
+// FrozenHashSet.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Implementation of the FrozenHashSet.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FastHash.hpp"
+#include "FrozenHashSet.hpp"
+
+
+
+namespace
+{
+    // The largest pilot that will be tried for a bucket before giving up
+    // and starting over with a different seed.
+    constexpr unsigned int MAX_PILOT = 65535;
+
+    // Odd constants for mixing pilots and hashes together by multiplying.
+    constexpr std::uint64_t PILOT_MULTIPLIER = 0x9e3779b97f4a7c15ull;
+    constexpr std::uint64_t POSITION_MULTIPLIER = 0xbf58476d1ce4e5b9ull;
+    constexpr std::uint64_t FINGERPRINT_MULTIPLIER = 0x94d049bb133111ebull;
+
+
+    // Scales a 32-bit value into the range [0, n) without dividing.
+    inline unsigned int scale(std::uint64_t value32, unsigned int n) noexcept
+    {
+        return static_cast<unsigned int>((value32 * n) >> 32);
+    }
+
+
+    // The low half of a hash picks its bucket...
+    inline unsigned int bucketFor(std::uint64_t hash, unsigned int bucketCount) noexcept
+    {
+        return scale(hash & 0xffffffffull, bucketCount);
+    }
+
+
+    // ...and the whole hash, mixed with its bucket's pilot, picks its
+    // position.  The multiplication carries differences in the low bits of
+    // the hash up into the high bits, which are the ones that are used.
+    inline unsigned int positionFor(std::uint64_t hash, unsigned int pilot, unsigned int tableSize) noexcept
+    {
+        std::uint64_t mixed = (hash ^ (pilot * PILOT_MULTIPLIER)) * POSITION_MULTIPLIER;
+        return scale(mixed >> 32, tableSize);
+    }
+
+
+    inline std::uint32_t fingerprintFor(std::uint64_t hash) noexcept
+    {
+        return static_cast<std::uint32_t>((hash * FINGERPRINT_MULTIPLIER) >> 32);
+    }
+
+
+    // An image starts with this header.  Every offset is from the start
+    // of the image, and every array starts on an eight-byte boundary, so
+    // the arrays can be used in place once the image is mapped.
+    struct ImageHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint64_t seed;
+        std::uint32_t elementNumber;
+        std::uint32_t bucketCount;
+        std::uint32_t tableSize;
+        std::uint32_t characterCount;
+        std::uint64_t pilotsOffset;
+        std::uint64_t redirectsOffset;
+        std::uint64_t slotsOffset;
+        std::uint64_t charactersOffset;
+        std::uint64_t imageSize;
+        std::uint64_t checksum;
+    };
+
+    constexpr char IMAGE_MAGIC[8] = {'F', 'R', 'O', 'Z', 'E', 'N', 'H', 'S'};
+    constexpr std::uint32_t IMAGE_VERSION = 2;
+
+    // Written in the machine's own byte order, so an image written on a
+    // machine with the other byte order reads back as 0x04030201.
+    constexpr std::uint32_t IMAGE_BYTE_ORDER = 0x01020304;
+
+
+    inline std::uint64_t roundUpToEight(std::uint64_t n) noexcept
+    {
+        return (n + 7) & ~std::uint64_t{7};
+    }
+
+
+    // Fills in everything in a header except its seed and checksum, given
+    // the sizes of the arrays.
+    ImageHeader layoutImage(
+        std::uint32_t elementNumber, std::uint32_t bucketCount,
+        std::uint32_t tableSize, std::uint32_t characterCount) noexcept
+    {
+        ImageHeader header{};
+        std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+        header.version = IMAGE_VERSION;
+        header.byteOrder = IMAGE_BYTE_ORDER;
+        header.elementNumber = elementNumber;
+        header.bucketCount = bucketCount;
+        header.tableSize = tableSize;
+        header.characterCount = characterCount;
+
+        std::uint64_t slotCount = elementNumber == 0 ? 0 : elementNumber + 1;
+
+        header.pilotsOffset = roundUpToEight(sizeof(ImageHeader));
+        header.redirectsOffset = roundUpToEight(
+            header.pilotsOffset + sizeof(std::uint16_t) * std::uint64_t{bucketCount});
+        header.slotsOffset = roundUpToEight(
+            header.redirectsOffset + sizeof(std::uint32_t) * std::uint64_t{tableSize - elementNumber});
+        header.charactersOffset = header.slotsOffset + 2 * sizeof(std::uint32_t) * slotCount;
+        header.imageSize = header.charactersOffset + characterCount;
+        return header;
+    }
+
+
+    // The checksum covers the header, with the checksum itself taken as 0,
+    // as well as the arrays, since the seed and the sizes in the header
+    // decide where every lookup goes just as much as the arrays do.
+    std::uint64_t imageChecksum(const ImageHeader& header, const char* image, std::uint64_t imageSize) noexcept
+    {
+        ImageHeader summed = header;
+        summed.checksum = 0;
+
+        std::uint64_t headerHash = fastHash64(&summed, sizeof(summed));
+        return fastHash64(image + sizeof(ImageHeader), imageSize - sizeof(ImageHeader), headerHash);
+    }
+}
+
+
+
+FrozenHashSet::FrozenHashSet()
+    : elementNumber{0}, seed{0}, pilots{nullptr}, bucketCount{0},
+      redirects{nullptr}, tableSize{0}, slots{nullptr}, characters{nullptr},
+      image{nullptr}, imageSize{0}
+{
+}
+
+
+FrozenHashSet::FrozenHashSet(const AVLSet<std::string>& s)
+    : FrozenHashSet{}
+{
+    std::vector<std::string_view> keys;
+    keys.reserve(s.size());
+    s.inorder([&](const std::string& element) { keys.push_back(element); });
+    build(keys);
+}
+
+
+FrozenHashSet::~FrozenHashSet() noexcept
+{
+    release();
+}
+
+
+FrozenHashSet::FrozenHashSet(const FrozenHashSet& s)
+    : FrozenHashSet{}
+{
+    copyFrom(s);
+}
+
+
+FrozenHashSet::FrozenHashSet(FrozenHashSet&& s) noexcept
+    : FrozenHashSet{}
+{
+    *this = std::move(s);
+}
+
+
+FrozenHashSet& FrozenHashSet::operator=(const FrozenHashSet& s)
+{
+    if (this != &s)
+    {
+        release();
+        copyFrom(s);
+    }
+
+    return *this;
+}
+
+
+FrozenHashSet& FrozenHashSet::operator=(FrozenHashSet&& s) noexcept
+{
+    std::swap(elementNumber, s.elementNumber);
+    std::swap(seed, s.seed);
+    std::swap(pilots, s.pilots);
+    std::swap(bucketCount, s.bucketCount);
+    std::swap(redirects, s.redirects);
+    std::swap(tableSize, s.tableSize);
+    std::swap(slots, s.slots);
+    std::swap(characters, s.characters);
+    std::swap(image, s.image);
+    std::swap(imageSize, s.imageSize);
+    return *this;
+}
+
+
+bool FrozenHashSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void FrozenHashSet::add(const std::string&)
+{
+    throw std::logic_error{"A FrozenHashSet can't be changed once it's been built"};
+}
+
+
+bool FrozenHashSet::contains(const std::string& element) const
+{
+    return contains(std::string_view{element});
+}
+
+
+bool FrozenHashSet::contains(std::string_view element) const
+{
+    if (elementNumber == 0)
+        return false;
+
+    std::uint64_t hash = fastHash64(element.data(), element.size(), seed);
+    const Slot& slot = slots[slotFor(hash)];
+
+    if (slot.fingerprint != fingerprintFor(hash))
+        return false;
+
+    std::uint32_t length = (&slot)[1].offset - slot.offset;
+    return length == element.size()
+        && std::memcmp(characters + slot.offset, element.data(), length) == 0;
+}
+
+
+bool FrozenHashSet::contains(const char* element) const
+{
+    return contains(std::string_view{element});
+}
+
+
+unsigned int FrozenHashSet::size() const noexcept
+{
+    return elementNumber;
+}
+
+
+std::size_t FrozenHashSet::memoryUsage() const noexcept
+{
+    if (elementNumber == 0)
+        return 0;
+
+    return sizeof(std::uint16_t) * bucketCount
+        + sizeof(std::uint32_t) * (tableSize - elementNumber)
+        + sizeof(Slot) * (elementNumber + 1)
+        + slots[elementNumber].offset;
+}
+
+
+bool FrozenHashSet::saveImage(const std::string& path) const
+{
+    std::uint32_t characterCount = elementNumber == 0 ? 0 : slots[elementNumber].offset;
+    ImageHeader header = layoutImage(elementNumber, bucketCount, tableSize, characterCount);
+    header.seed = seed;
+
+    // The image is put together in memory first, so that the checksum
+    // can be computed over exactly the bytes that are written.
+    std::vector<char> bytes(header.imageSize, 0);
+
+    if (elementNumber > 0)
+    {
+        std::memcpy(bytes.data() + header.pilotsOffset, pilots, sizeof(std::uint16_t) * bucketCount);
+        std::memcpy(bytes.data() + header.redirectsOffset, redirects, sizeof(std::uint32_t) * (tableSize - elementNumber));
+        std::memcpy(bytes.data() + header.slotsOffset, slots, sizeof(Slot) * (elementNumber + 1));
+        std::memcpy(bytes.data() + header.charactersOffset, characters, characterCount);
+    }
+
+    header.checksum = imageChecksum(header, bytes.data(), header.imageSize);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    out.write(bytes.data(), bytes.size());
+    out.close();
+    return static_cast<bool>(out);
+}
+
+
+bool FrozenHashSet::mapImage(const std::string& path, bool verifyChecksum)
+{
+    release();
+
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(ImageHeader)))
+    {
+        close(file);
+        return false;
+    }
+
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+
+    if (mapped == MAP_FAILED)
+        return false;
+
+    const char* bytes = static_cast<const char*>(mapped);
+    ImageHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+
+    // Every offset is recomputed from the sizes and must agree with the
+    // header, which guarantees that every array lies inside the image.
+    bool sizesAreConsistent = header.elementNumber == 0
+        ? header.bucketCount == 0 && header.tableSize == 0 && header.characterCount == 0
+        : header.bucketCount > 0 && header.tableSize > header.elementNumber;
+
+    ImageHeader expected = layoutImage(
+        header.elementNumber, header.bucketCount, header.tableSize, header.characterCount);
+
+    bool valid = std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0
+        && header.version == IMAGE_VERSION
+        && header.byteOrder == IMAGE_BYTE_ORDER
+        && sizesAreConsistent
+        && header.pilotsOffset == expected.pilotsOffset
+        && header.redirectsOffset == expected.redirectsOffset
+        && header.slotsOffset == expected.slotsOffset
+        && header.charactersOffset == expected.charactersOffset
+        && header.imageSize == expected.imageSize
+        && header.imageSize == size
+        && (!verifyChecksum || header.checksum == imageChecksum(header, bytes, size));
+
+    if (!valid)
+    {
+        munmap(mapped, size);
+        return false;
+    }
+
+    image = mapped;
+    imageSize = size;
+
+    if (header.elementNumber > 0)
+    {
+        // The arrays are never written to after they're built, so it's
+        // safe for them to point into memory that can only be read.
+        char* start = static_cast<char*>(mapped);
+        pilots = reinterpret_cast<std::uint16_t*>(start + header.pilotsOffset);
+        redirects = reinterpret_cast<std::uint32_t*>(start + header.redirectsOffset);
+        slots = reinterpret_cast<Slot*>(start + header.slotsOffset);
+        characters = start + header.charactersOffset;
+
+        elementNumber = header.elementNumber;
+        seed = header.seed;
+        bucketCount = header.bucketCount;
+        tableSize = header.tableSize;
+
+        if (!indexesAreInBounds(header.characterCount))
+        {
+            release();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool FrozenHashSet::isMapped() const noexcept
+{
+    return image != nullptr;
+}
+
+
+unsigned int FrozenHashSet::slotFor(std::uint64_t hash) const noexcept
+{
+    unsigned int position = positionFor(hash, pilots[bucketFor(hash, bucketCount)], tableSize);
+    return position < elementNumber ? position : redirects[position - elementNumber];
+}
+
+
+bool FrozenHashSet::indexesAreInBounds(std::uint32_t characterCount) const noexcept
+{
+    for (unsigned int i = 0; i < tableSize - elementNumber; ++i)
+    {
+        if (redirects[i] >= elementNumber)
+            return false;
+    }
+
+    if (slots[0].offset != 0 || slots[elementNumber].offset != characterCount)
+        return false;
+
+    for (unsigned int i = 0; i < elementNumber; ++i)
+    {
+        if (slots[i].offset > slots[i + 1].offset)
+            return false;
+    }
+
+    return true;
+}
+
+
+void FrozenHashSet::build(std::vector<std::string_view>& keys)
+{
+    if (keys.empty())
+        return;
+
+    std::vector<std::uint64_t> hashes;
+    std::vector<unsigned int> order;
+
+    // Nearly every seed works on the first try; a new one is only needed
+    // when two different strings have the same 64-bit hash, or when some
+    // bucket can't be placed with any pilot.
+    for (seed = 0; ; ++seed)
+    {
+        // Sorting by hash puts duplicates next to each other.
+        hashes.resize(keys.size());
+        for (unsigned int i = 0; i < keys.size(); ++i)
+            hashes[i] = fastHash64(keys[i].data(), keys[i].size(), seed);
+
+        order.resize(keys.size());
+        for (unsigned int i = 0; i < order.size(); ++i)
+            order[i] = i;
+
+        std::sort(order.begin(), order.end(),
+            [&](unsigned int a, unsigned int b) { return hashes[a] < hashes[b]; });
+
+        bool hashesCollide = false;
+        unsigned int n = 0;
+        for (unsigned int i = 0; i < order.size() && !hashesCollide; ++i)
+        {
+            if (n > 0 && hashes[order[i]] == hashes[order[n - 1]])
+            {
+                hashesCollide = keys[order[i]] != keys[order[n - 1]];
+                continue;
+            }
+
+            order[n++] = order[i];
+        }
+
+        if (hashesCollide)
+            continue;
+
+        order.resize(n);
+        bucketCount = n / AVERAGE_BUCKET_SIZE + 1;
+        tableSize = n + static_cast<unsigned int>(n * EXTRA_SLOTS) + 1;
+
+        // Group the elements by bucket, with a counting sort.
+        std::vector<unsigned int> bucketStart(bucketCount + 1, 0);
+        for (unsigned int k : order)
+            ++bucketStart[bucketFor(hashes[k], bucketCount) + 1];
+
+        unsigned int largestBucket = 0;
+        for (unsigned int b = 0; b < bucketCount; ++b)
+        {
+            largestBucket = std::max(largestBucket, bucketStart[b + 1]);
+            bucketStart[b + 1] += bucketStart[b];
+        }
+
+        std::vector<unsigned int> members(n);
+        std::vector<unsigned int> next(bucketStart.begin(), bucketStart.end() - 1);
+        for (unsigned int k : order)
+            members[next[bucketFor(hashes[k], bucketCount)]++] = k;
+
+        // Then order the buckets from largest to smallest, with another.
+        std::vector<unsigned int> sizeStart(largestBucket + 2, 0);
+        for (unsigned int b = 0; b < bucketCount; ++b)
+            ++sizeStart[largestBucket - (bucketStart[b + 1] - bucketStart[b]) + 1];
+
+        for (unsigned int i = 0; i <= largestBucket; ++i)
+            sizeStart[i + 1] += sizeStart[i];
+
+        std::vector<unsigned int> bucketOrder(bucketCount);
+        for (unsigned int b = 0; b < bucketCount; ++b)
+            bucketOrder[sizeStart[largestBucket - (bucketStart[b + 1] - bucketStart[b])]++] = b;
+
+        // Find a pilot for each bucket.
+        std::vector<unsigned char> taken(tableSize, 0);
+        std::vector<std::uint16_t> bucketPilots(bucketCount, 0);
+        std::vector<unsigned int> positions(largestBucket);
+        bool allPlaced = true;
+
+        for (unsigned int b : bucketOrder)
+        {
+            unsigned int first = bucketStart[b];
+            unsigned int count = bucketStart[b + 1] - first;
+            if (count == 0)
+                break;
+
+            bool placed = false;
+            for (unsigned int pilot = 0; pilot <= MAX_PILOT && !placed; ++pilot)
+            {
+                unsigned int i = 0;
+                for (; i < count; ++i)
+                {
+                    unsigned int position = positionFor(hashes[members[first + i]], pilot, tableSize);
+                    if (taken[position])
+                        break;
+
+                    taken[position] = 1;
+                    positions[i] = position;
+                }
+
+                if (i == count)
+                {
+                    bucketPilots[b] = static_cast<std::uint16_t>(pilot);
+                    placed = true;
+                }
+                else
+                {
+                    while (i > 0)
+                        taken[positions[--i]] = 0;
+                }
+            }
+
+            if (!placed)
+            {
+                allPlaced = false;
+                break;
+            }
+        }
+
+        if (!allPlaced)
+            continue;
+
+        // Every position past the last slot that an element was sent to is
+        // redirected to one of the slots that nothing was sent to.
+        redirects = new std::uint32_t[tableSize - n]();
+        unsigned int nextEmpty = 0;
+        for (unsigned int position = n; position < tableSize; ++position)
+        {
+            if (!taken[position])
+                continue;
+
+            while (taken[nextEmpty])
+                ++nextEmpty;
+
+            redirects[position - n] = nextEmpty++;
+        }
+
+        elementNumber = n;
+        pilots = new std::uint16_t[bucketCount];
+        std::copy(bucketPilots.begin(), bucketPilots.end(), pilots);
+
+        // Lay the elements' characters out in slot order.
+        std::vector<unsigned int> keyInSlot(n);
+        std::size_t characterCount = 0;
+        for (unsigned int k : order)
+        {
+            keyInSlot[slotFor(hashes[k])] = k;
+            characterCount += keys[k].size();
+        }
+
+        slots = new Slot[n + 1];
+        characters = new char[characterCount == 0 ? 1 : characterCount];
+
+        std::uint32_t offset = 0;
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            const std::string_view& key = keys[keyInSlot[i]];
+            slots[i].fingerprint = fingerprintFor(hashes[keyInSlot[i]]);
+            slots[i].offset = offset;
+            std::memcpy(characters + offset, key.data(), key.size());
+            offset += static_cast<std::uint32_t>(key.size());
+        }
+
+        slots[n].fingerprint = 0;
+        slots[n].offset = offset;
+        return;
+    }
+}
+
+
+void FrozenHashSet::release() noexcept
+{
+    if (image != nullptr)
+    {
+        munmap(image, imageSize);
+        image = nullptr;
+        imageSize = 0;
+    }
+    else
+    {
+        delete[] pilots;
+        delete[] redirects;
+        delete[] slots;
+        delete[] characters;
+    }
+
+    elementNumber = 0;
+    pilots = nullptr;
+    bucketCount = 0;
+    redirects = nullptr;
+    tableSize = 0;
+    slots = nullptr;
+    characters = nullptr;
+}
+
+
+void FrozenHashSet::copyFrom(const FrozenHashSet& s)
+{
+    if (s.elementNumber == 0)
+        return;
+
+    std::uint32_t characterCount = s.slots[s.elementNumber].offset;
+
+    pilots = new std::uint16_t[s.bucketCount];
+    redirects = new std::uint32_t[s.tableSize - s.elementNumber];
+    slots = new Slot[s.elementNumber + 1];
+    characters = new char[characterCount == 0 ? 1 : characterCount];
+
+    std::copy(s.pilots, s.pilots + s.bucketCount, pilots);
+    std::copy(s.redirects, s.redirects + (s.tableSize - s.elementNumber), redirects);
+    std::copy(s.slots, s.slots + s.elementNumber + 1, slots);
+    std::copy(s.characters, s.characters + characterCount, characters);
+
+    elementNumber = s.elementNumber;
+    seed = s.seed;
+    bucketCount = s.bucketCount;
+    tableSize = s.tableSize;
+}
@@ -0,0 +1,216 @@
+// FrozenHashSet.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A FrozenHashSet is a Set of strings that is built once, from all of its
+// elements at the same time, and never changes afterward; add() throws a
+// std::logic_error.  In exchange, it uses much less memory than a HashSet
+// and looks elements up with fewer memory accesses.
+//
+// It's built on a "minimal perfect hash" in the style of PTHash.  Each
+// element's 64-bit hash picks one of a few "buckets," each of which holds
+// about four elements.  During construction, the buckets are visited from
+// largest to smallest, and each one is assigned a small "pilot" value: the
+// first one that, combined with the hashes of the bucket's elements, sends
+// every one of them to a different slot that no earlier bucket has taken.
+// That leaves every element with a slot of its own and no collisions to
+// resolve, so there are no lists, no empty slots, and no probing.  To make
+// the pilots quick to find, there are a few percent more slots than
+// elements; elements that land past the end are redirected to the slots
+// that were left empty, so the slots themselves are exactly as many as the
+// elements.
+//
+// The elements' characters are stored back to back in one array, in slot
+// order.  Each slot holds where its element starts, along with a 32-bit
+// fingerprint of its hash, so that looking up a string that isn't in the
+// set almost never has to compare any characters.  A lookup reads a pilot,
+// then one slot, and then (only if the fingerprint matches) the element.
+//
+// Because a FrozenHashSet is nothing more than those four arrays, it can
+// be saved to a file as an "image" and loaded back by mapping the file
+// into memory, rather than rebuilding the set from a list of words.  The
+// image is laid out exactly as the arrays are in memory, preceded by a
+// header that records a version, the byte order, the seed, the sizes and
+// offsets of the arrays, and a checksum of the rest of the header and
+// everything after it; a mapped set
+// looks elements up right where they are in the file, so startup takes
+// almost no time, and every process that maps the same image shares the
+// same pages of memory.
+
+#ifndef FROZENHASHSET_HPP
+#define FROZENHASHSET_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AVLSet.hpp"
+#include "HashSet.hpp"
+#include "Set.hpp"
+
+
+
+class FrozenHashSet : public Set<std::string>
+{
+public:
+    // The average number of elements per bucket.  Fewer elements per
+    // bucket make construction faster but use more memory for pilots.
+    static constexpr unsigned int AVERAGE_BUCKET_SIZE = 4;
+
+    // The number of extra slots, as a fraction of the number of elements,
+    // that pilots are allowed to send elements to before they're
+    // redirected.
+    static constexpr double EXTRA_SLOTS = 0.02;
+
+public:
+    // Initializes a FrozenHashSet with no elements.
+    FrozenHashSet();
+
+    // Initializes a FrozenHashSet containing the strings in the range
+    // [first, last); any string that appears more than once is only
+    // included once.
+    template <typename InputIterator>
+    FrozenHashSet(InputIterator first, InputIterator last);
+
+    // Initializes a FrozenHashSet containing the same elements as a
+    // HashSet or an AVLSet.
+    template <typename Hash, typename Sizing>
+    explicit FrozenHashSet(const HashSet<std::string, Hash, Sizing>& s);
+    explicit FrozenHashSet(const AVLSet<std::string>& s);
+
+    // Cleans up the FrozenHashSet so that it leaks no memory.
+    virtual ~FrozenHashSet() noexcept;
+
+    // Initializes a new FrozenHashSet to be a copy of an existing one.
+    FrozenHashSet(const FrozenHashSet& s);
+
+    // Initializes a new FrozenHashSet whose contents are moved from an
+    // expiring one.
+    FrozenHashSet(FrozenHashSet&& s) noexcept;
+
+    // Assigns an existing FrozenHashSet into another.
+    FrozenHashSet& operator=(const FrozenHashSet& s);
+
+    // Assigns an expiring FrozenHashSet into another.
+    FrozenHashSet& operator=(FrozenHashSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() throws a std::logic_error, since a FrozenHashSet can't be
+    // changed once it's been built.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given element is in the set, false
+    // otherwise.  This function runs in constant time, and never compares
+    // the element to more than one of the set's elements.
+    virtual bool contains(const std::string& element) const override;
+
+    // contains() can also look up a std::string_view, or a C string,
+    // without building a std::string first.
+    bool contains(std::string_view element) const;
+    bool contains(const char* element) const;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // memoryUsage() returns the number of bytes of memory that the set
+    // uses to hold its elements, whether they were allocated or mapped.
+    std::size_t memoryUsage() const noexcept;
+
+
+    // saveImage() writes the set to the given file as an image that
+    // mapImage() can load, returning false if the file couldn't be
+    // written.
+    bool saveImage(const std::string& path) const;
+
+    // mapImage() replaces the contents of the set with the image in the
+    // given file, which is mapped into memory read-only instead of being
+    // read.  It returns false, leaving the set empty, if the file can't
+    // be mapped or isn't a valid image for this machine.  Checking the
+    // checksum touches every page of the file; it can be skipped for
+    // images that are trusted, such as ones this program just wrote.
+    // Either way, the redirects and the slots' offsets are checked, so
+    // that even a damaged image whose checksum wasn't verified can't send
+    // a lookup outside of the mapped file.
+    bool mapImage(const std::string& path, bool verifyChecksum = true);
+
+    // isMapped() returns true if the set's elements are in a mapped
+    // image, false if they were allocated when the set was built.
+    bool isMapped() const noexcept;
+
+
+private:
+    struct Slot
+    {
+        std::uint32_t fingerprint;
+        std::uint32_t offset;
+    };
+
+    // Builds the set from the given strings, which are reordered, and any
+    // duplicates among them removed.
+    void build(std::vector<std::string_view>& keys);
+
+    // Returns the slot where an element with the given hash would be.
+    unsigned int slotFor(std::uint64_t hash) const noexcept;
+
+    // Returns true if every redirect names an existing slot and the slots'
+    // offsets ascend to exactly the number of characters, which is what
+    // keeps slotFor() and contains() inside the arrays.
+    bool indexesAreInBounds(std::uint32_t characterCount) const noexcept;
+
+    void release() noexcept;
+    void copyFrom(const FrozenHashSet& s);
+
+    unsigned int elementNumber;
+    std::uint64_t seed;
+
+    std::uint16_t* pilots;
+    unsigned int bucketCount;
+
+    // Slots from elementNumber up to tableSize don't exist; an element
+    // sent to one of them is actually in the slot given by redirects.
+    std::uint32_t* redirects;
+    unsigned int tableSize;
+
+    // There is one more Slot than there are elements, so that the length
+    // of the element in slot i is always slots[i + 1].offset - slots[i].offset.
+    Slot* slots;
+    char* characters;
+
+    // When the set was loaded by mapImage(), the arrays point into the
+    // mapped image rather than being allocated.
+    void* image;
+    std::size_t imageSize;
+};
+
+
+
+template <typename InputIterator>
+FrozenHashSet::FrozenHashSet(InputIterator first, InputIterator last)
+    : FrozenHashSet{}
+{
+    std::vector<std::string> strings(first, last);
+    std::vector<std::string_view> keys(strings.begin(), strings.end());
+    build(keys);
+}
+
+
+template <typename Hash, typename Sizing>
+FrozenHashSet::FrozenHashSet(const HashSet<std::string, Hash, Sizing>& s)
+    : FrozenHashSet{}
+{
+    std::vector<std::string_view> keys;
+    keys.reserve(s.size());
+    s.forEach([&](const std::string& element) { keys.push_back(element); });
+    build(keys);
+}
+
+
+
+#endif // FROZENHASHSET_HPP
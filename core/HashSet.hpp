@@ -10,9 +10,75 @@
 // indicating the size of the array.
 //
 // As elements are added to the HashSet and the proportion of the HashSet's
-// size to its capacity exceeds 0.8 (i.e., there are more than 80% as many
-// elements as there are array cells), the HashSet should be resized so
-// that it is twice as large as it was before.
+// size to its capacity exceeds its maximum load factor, which is 0.8 unless
+// it's changed (i.e., there are more than 80% as many elements as there
+// are array cells), the HashSet should be resized so that it is twice as
+// large as it was before.
+//
+// How a hash is reduced to an index, and which capacities are allowed, is
+// decided by a bucket sizing policy (see BucketSizing.hpp), which is the
+// third template parameter.  By default, any capacity is allowed and the
+// index is the hash modulo the capacity; the other policies trade that
+// division for masking or a multiplication, or use prime capacities to
+// make up for a weak hash.
+//
+// The resize can optionally be done incrementally: the old and new arrays
+// coexist while a bounded number of the old array's cells (the "migration
+// budget") are moved into the new one by each subsequent call to add(), so
+// no single call ever pays for rebuilding the whole table.  While a resize
+// is in progress, contains() looks in both arrays.
+//
+// Elements can also be removed.  When removing them leaves the HashSet
+// less full than its minimum load factor, which is 0.2 unless it's changed,
+// the array is shrunk to half its capacity (never below the default), using
+// the same resizing machinery, incrementally or all at once, as growing it.
+// The nodes of removed elements are reused by later adds rather than given
+// back to the heap; shrinkToFit() gives back everything that isn't needed,
+// both the unneeded cells and the storage of the removed nodes.
+//
+// The type of the hash function is a template parameter.  It defaults to
+// std::function, so any function with the right signature can be used,
+// but naming a function object type instead (e.g., HashSet<int, IntHash>)
+// lets the compiler inline the hash into add() and contains().  When no
+// hash function is given, the HashSet uses a FastHash, which is defined
+// for strings and integers; HashSet<std::string, FastHash<std::string>>
+// gets the same hash with no std::function in the way.
+//
+// The nodes of the linked lists are allocated from a NodePool, so that
+// building a large HashSet makes a few large allocations rather than one
+// per element, and destroying it gives them all back at once.
+//
+// A list that grows longer than the "treeify threshold" (because of a weak
+// hash, or keys chosen deliberately to collide) is turned into an AVLSet
+// ordered by hash and then by element, so that even when every element
+// lands in the same cell, looking one up takes O(log n) time rather than
+// O(n).  The cell stays a tree until removing elements shrinks it to half
+// the threshold or a resize spreads its elements out again, at which point
+// they go back into lists.  (Waiting until it's half as long keeps a cell
+// whose length hovers around the threshold from being turned back and
+// forth.)  This is only done for element types that can be compared
+// with <.
+//
+// A HashSet is also a BatchLookup.  containsMany() hashes a group of keys
+// and prefetches their cells, then prefetches the first node in each of
+// those cells, and only then walks the lists, so that the cache misses
+// for all of the keys in a group overlap instead of happening one after
+// another.
+//
+// A HashSet can be iterated with begin() and end(), so it can be used in a
+// range-based for loop or with the standard algorithms.  Its iterators walk
+// the array from its first cell to its last, following each cell's list
+// (or visiting its tree in order), and then the unmigrated cells of the old
+// array, if a resize is in progress; elements are visited in no particular
+// order, but each exactly once.
+//
+// When the number of elements is known ahead of time, reserve() sizes the
+// array once, so that adding them never triggers a resize.  A HashSet can
+// also be built directly from a range of elements; the range constructor
+// reserves space when the length of the range can be known in advance,
+// can skip the duplicate check when the caller promises the elements are
+// distinct, and can hash the elements on several threads before inserting
+// them.
 //
 // You are not permitted to use the containers in the C++ Standard Library
 // (such as std::set, std::map, or std::vector) to store the information
@@ -23,29 +89,220 @@
 #ifndef HASHSET_HPP
 #define HASHSET_HPP
 
+#include <cmath>
+#include <cstddef>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "AVLSet.hpp"
+#include "BatchLookup.hpp"
+#include "BucketSizing.hpp"
+#include "Comparison.hpp"
+#include "FastHash.hpp"
+#include "NodePool.hpp"
 #include "Set.hpp"
 
 using namespace std;
 
 
 
-template <typename ElementType>
-class HashSet : public Set<ElementType>
+namespace impl_
+{
+    // A hash function type is "transparent" if it declares a member type
+    // named is_transparent, which promises that it can also hash keys of
+    // other types (e.g., std::string_view for std::string elements), and
+    // that equivalent keys hash to the same value.
+    template <typename Hash, typename = void>
+    struct HashSet__isTransparent : std::false_type
+    {
+    };
+
+    template <typename Hash>
+    struct HashSet__isTransparent<Hash, std::void_t<typename Hash::is_transparent>> : std::true_type
+    {
+    };
+
+
+    template <typename ElementType, typename Hash, typename Key>
+    using HashSet__enableHeterogeneous = std::enable_if_t<
+        HashSet__isTransparent<Hash>::value && !std::is_same<Key, ElementType>::value>;
+
+
+    // Long lists can only be turned into trees when elements can be
+    // ordered with <.
+    template <typename ElementType, typename = void>
+    struct HashSet__isOrdered : std::false_type
+    {
+    };
+
+    template <typename ElementType>
+    struct HashSet__isOrdered<ElementType, std::void_t<
+        decltype(std::declval<const ElementType&>() < std::declval<const ElementType&>())>>
+        : std::true_type
+    {
+    };
+
+
+    // The elements of a tree-shaped cell are ordered by their hashes first,
+    // so that most comparisons never look at the elements themselves.  A
+    // HashSet__TreeProbe is what a key is wrapped in to look it up.
+    template <typename ElementType>
+    struct HashSet__TreeEntry
+    {
+        ElementType key;
+        unsigned int hashCode;
+    };
+
+    template <typename Key>
+    struct HashSet__TreeProbe
+    {
+        const Key& key;
+        unsigned int hashCode;
+    };
+
+
+    // The trees' comparison policy compares hashes and only looks at the
+    // keys, with a single three-way comparison, when the hashes are equal.
+    // The first argument can be either an entry or a probe.
+    struct HashSet__TreeComparison
+    {
+        template <typename A, typename ElementType>
+        static int compare(const A& a, const HashSet__TreeEntry<ElementType>& b)
+        {
+            if (a.hashCode != b.hashCode)
+                return a.hashCode < b.hashCode ? -1 : 1;
+
+            return ThreeWayComparison::compare(a.key, b.key);
+        }
+    };
+}
+
+
+
+template <
+    typename ElementType, typename Hash = std::function<unsigned int(const ElementType&)>,
+    typename Sizing = ModuloSizing>
+class HashSet : public Set<ElementType>, public BatchLookup<ElementType>
 {
 public:
     // The default capacity of the HashSet before anything has been
-    // added to it.
+    // added to it, before the sizing policy rounds it up.
     static constexpr unsigned int DEFAULT_CAPACITY = 10;
 
+    // The ratio of size to capacity beyond which the HashSet is resized,
+    // unless it's changed with setMaxLoadFactor().
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.8;
+
+    // The ratio of size to capacity below which removing an element shrinks
+    // the HashSet, unless it's changed with setMinLoadFactor().
+    static constexpr double DEFAULT_MIN_LOAD_FACTOR = 0.2;
+
+    // The length beyond which a list is turned into a tree, unless it's
+    // changed with setTreeifyThreshold().
+    static constexpr unsigned int DEFAULT_TREEIFY_THRESHOLD = 8;
+
+    // Whether lists can be turned into trees at all, which requires that
+    // elements can be compared with <.
+    static constexpr bool CAN_TREEIFY = impl_::HashSet__isOrdered<ElementType>::value;
+
+    // The number of keys whose memory accesses containsMany() overlaps;
+    // longer batches are handled this many keys at a time.
+    static constexpr unsigned int BATCH_GROUP_SIZE = 16;
+
     // A HashFunction is a function that takes a reference to a const
-    // ElementType and returns an unsigned int.
-    using HashFunction = std::function<unsigned int(const ElementType&)>;
+    // ElementType and returns an unsigned int.  By default, it can be any
+    // such function, but a HashSet whose Hash is a particular function
+    // object type calls it directly, so the compiler can inline it.
+    using HashFunction = Hash;
+
+    // A VisitFunction is a function that takes a reference to a const
+    // ElementType and returns no value.
+    using VisitFunction = std::function<void(const ElementType&)>;
+
+private:
+    struct ListNode;
+    using TreeEntry = impl_::HashSet__TreeEntry<ElementType>;
+    using Tree = AVLSet<TreeEntry, impl_::HashSet__TreeComparison>;
+
+public:
+    // An Iterator visits each of the elements of a HashSet once, in no
+    // particular order.  Elements can't be changed through an Iterator,
+    // since that would change their hashes.  Adding or removing elements
+    // invalidates every Iterator.
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ElementType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ElementType*;
+        using reference = const ElementType&;
+
+        // How many cells ahead an Iterator asks for the first node of a
+        // list, so that it's already in the cache when it's reached.
+        static constexpr unsigned int PREFETCH_DISTANCE = 8;
+
+        // Initializes an Iterator that refers to no element.
+        Iterator() noexcept;
+
+        reference operator*() const noexcept;
+        pointer operator->() const noexcept;
+
+        Iterator& operator++() noexcept;
+        Iterator operator++(int) noexcept;
+
+        bool operator==(const Iterator& other) const noexcept;
+        bool operator!=(const Iterator& other) const noexcept;
+
+    private:
+        friend class HashSet;
+        explicit Iterator(const HashSet* set) noexcept;
+
+        // Moves to the first element in the cell at the current index or
+        // any cell after it, or to the end if there isn't one.
+        void seek() noexcept;
+
+        // The array being walked is kept here, rather than looked up in the
+        // set at every step; "set" is only needed to move on to the old one.
+        const HashSet* set;
+        ListNode** cells;
+        Tree** cellTrees;
+        unsigned int capacity;
+        unsigned int index;
+
+        // The list node at the current position, or nullptr when the
+        // position is in the cell's tree instead.  Every position has a
+        // different node or tree element, and the end has neither.
+        const ListNode* node;
+        typename Tree::Iterator treeElement;
+    };
 
 public:
     // Initializes a HashSet to be empty, so that it will use the given
-    // hash function whenever it needs to hash an element.
-    explicit HashSet(HashFunction hashFunction);
+    // hash function (or a FastHash, if none is given) whenever it needs
+    // to hash an element.  The migration budget is the number of cells of
+    // the old array that each call to add() moves into the new array while
+    // a resize is in progress; a budget of 0 means that a resize moves
+    // every cell at once.
+    explicit HashSet(
+        HashFunction hashFunction = FastHash<ElementType>{}, unsigned int migrationBudget = 0);
+
+    // Initializes a HashSet to contain the elements in the range [first,
+    // last), such as a dictionary's words read with std::istream_iterator.
+    // If the range can be traversed more than once, the array is sized for
+    // all of its elements up front.  If elementsAreUnique is true, the
+    // caller promises that no element appears twice in the range, so each
+    // one is inserted without first looking for it.  If hashThreads is
+    // more than 1 and the range is random-access, the elements are hashed
+    // on that many threads at once before any of them are inserted, in
+    // which case the hash function must be safe to call concurrently.
+    template <typename InputIterator>
+    HashSet(
+        InputIterator first, InputIterator last, HashFunction hashFunction = FastHash<ElementType>{},
+        bool elementsAreUnique = false, unsigned int hashThreads = 1);
 
     // Cleans up the HashSet so that it leaks no memory.
     virtual ~HashSet() noexcept;
@@ -71,11 +328,12 @@ public:
 
     // add() adds an element to the set.  If the element is already in the set,
     // this function has no effect.  This function triggers a resizing of the
-    // array when the ratio of size to capacity would exceed 0.8.  In the case
-    // where the array is resized, this function runs in linear time (with
-    // respect to the number of elements, assuming a good hash function);
-    // otherwise, it runs in constant time (again, assuming a good hash
-    // function).
+    // array when the ratio of size to capacity would exceed the maximum load
+    // factor.  In the case where the array is resized all at once, this
+    // function runs in linear time (with respect to the number of elements,
+    // assuming a good hash function); otherwise, it runs in constant time
+    // (again, assuming a good hash function), plus the time to migrate at
+    // most "migration budget" cells when a resize is in progress.
     virtual void add(const ElementType& element) override;
 
 
@@ -85,13 +343,117 @@ public:
     virtual bool contains(const ElementType& element) const override;
 
 
+    // contains() can also look up a key of some other type that can be
+    // compared to an ElementType with ==, such as a std::string_view in a
+    // HashSet<std::string>, without building an ElementType first.  This
+    // is only available when the hash function type is transparent.
+    template <typename Key, typename = impl_::HashSet__enableHeterogeneous<ElementType, Hash, Key>>
+    bool contains(const Key& key) const;
+
+
+    // remove() removes an element from the set.  If the element isn't in
+    // the set, this function has no effect.  This function runs in constant
+    // time (assuming a good hash function), plus the time to migrate at most
+    // "migration budget" cells when a resize is in progress.  When removing
+    // the element leaves the set less full than the minimum load factor, a
+    // resize to half the capacity is started, and in the case where it's done
+    // all at once, this function runs in linear time.
+    void remove(const ElementType& element);
+
+
+    // containsMany() stores into results[i] whether keys[i] is in the set,
+    // for each of the count keys.  It does the same work as calling
+    // contains() on each key, but overlaps the cache misses of up to
+    // BATCH_GROUP_SIZE keys at a time.
+    virtual void containsMany(const ElementType* keys, unsigned int count, bool* results) const override;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const noexcept override;
 
 
+    // begin() returns an Iterator referring to the first element, and end()
+    // returns one referring to the position just after the last.  Walking
+    // from begin() to end() takes time proportional to the capacity plus
+    // the number of elements.
+    Iterator begin() const noexcept;
+    Iterator end() const noexcept;
+
+
+    // forEach() calls the given "visit" function once for each of the
+    // elements in the set, in no particular order.
+    void forEach(VisitFunction visit) const;
+
+
+    // isResizing() returns true if an incremental resize has been started
+    // but not all of the old array's cells have been migrated yet.
+    bool isResizing() const noexcept;
+
+
+    // capacity() returns the number of cells in the array.
+    unsigned int capacity() const noexcept;
+
+
+    // loadFactor() returns the ratio of size to capacity.
+    double loadFactor() const noexcept;
+
+
+    // maxLoadFactor() returns the ratio of size to capacity beyond which
+    // the HashSet is resized.
+    double maxLoadFactor() const noexcept;
+
+
+    // setMaxLoadFactor() changes the ratio of size to capacity beyond which
+    // the HashSet is resized; it must be positive.  The new ratio takes
+    // effect the next time an element is added or space is reserved.
+    void setMaxLoadFactor(double maxLoadFactor) noexcept;
+
+
+    // minLoadFactor() returns the ratio of size to capacity below which
+    // removing an element shrinks the HashSet.
+    double minLoadFactor() const noexcept;
+
+
+    // setMinLoadFactor() changes the ratio of size to capacity below which
+    // removing an element shrinks the HashSet; 0 means that the HashSet
+    // never shrinks on its own.  It should be less than half of the maximum
+    // load factor, or else the shrunken HashSet would immediately be too
+    // full.
+    void setMinLoadFactor(double minLoadFactor) noexcept;
+
+
+    // setTreeifyThreshold() changes the length beyond which a list is
+    // turned into a tree; 0 means that lists are never turned into trees.
+    // Lists that are already longer aren't affected until they grow again.
+    void setTreeifyThreshold(unsigned int treeifyThreshold) noexcept;
+
+
+    // treeCount() returns the number of cells that are currently trees.
+    unsigned int treeCount() const noexcept;
+
+
+    // reserve() makes the array large enough that the set can hold the
+    // given number of elements without being resized.  If that requires
+    // a larger array, every element is moved into it at once, and any
+    // incremental resize in progress is finished first.  If the array is
+    // already large enough, this function has no effect.
+    void reserve(unsigned int elementCount);
+
+
+    // shrinkToFit() makes the array as small as it can be while still
+    // holding the set's elements within the maximum load factor (but no
+    // smaller than the default capacity), and moves every element into
+    // newly-allocated nodes, so that the storage left behind by removed
+    // elements is given back to the heap.  Any incremental resize in
+    // progress is finished first.  This function runs in linear time.
+    void shrinkToFit();
+
+
     // elementsAtIndex() returns the number of elements that hashed to a
     // particular index in the array.  If the index is out of the boundaries
-    // of the array, this function returns 0.
+    // of the array, this function returns 0.  While a resize is in progress,
+    // the index refers to the new array, and elements that have not been
+    // migrated yet are counted where they will eventually land.
     unsigned int elementsAtIndex(unsigned int index) const;
 
 
@@ -102,292 +464,1101 @@ public:
 
 
 private:
+    // Each node remembers the full hash of its key, so that moving it to a
+    // new array never requires hashing it again, and so that most keys
+    // that don't match can be ruled out without comparing them.
     struct ListNode
     {
         ElementType key;
-        ListNode* next = nullptr;
-        static void deleteList(ListNode * L)
+        unsigned int hashCode;
+        ListNode* next;
+
+        ListNode(const ElementType& key, unsigned int hashCode, ListNode* next)
+            : key{key}, hashCode{hashCode}, next{next}
         {
-            if (L != nullptr)
-                deleteList(L->next);
-            delete L;
         }
     };
+
+    // Allocates an array of empty lists.  Each cell points to the first
+    // node in its list, or is nullptr when the list is empty.
+    static ListNode** createTable(unsigned int capacity);
+
+    // Deallocates an array, along with any nodes still in it, and its
+    // trees, if it has any.  The nodes' storage stays in the pool until
+    // the pool itself is released.
+    void destroyTable(ListNode** table, Tree** tableTrees, unsigned int capacity);
+
+    // Returns true if the given element, whose hash is given, is in the
+    // given array's list or tree at the given index.
+    template <typename Key>
+    static bool isInCell(
+        ListNode** table, Tree** tableTrees, unsigned int index,
+        const Key& element, unsigned int elementHash);
+
+    // Returns true if the given element, whose hash is given, is in the
+    // set, looking in both arrays while a resize is in progress.
+    template <typename Key>
+    bool isPresent(const Key& element, unsigned int elementHash) const;
+
+    // Removes the given element, whose hash is given, from the given
+    // array's list or tree at the given index, returning true if it was
+    // there.  A tree that shrinks to half the treeify threshold goes back
+    // to being a list.
+    bool removeFromCell(
+        ListNode** table, Tree** tableTrees, unsigned int index,
+        const ElementType& element, unsigned int elementHash);
+
+    // Asks the processor to start loading the cache line containing the
+    // given address, without waiting for it to arrive.
+    static void prefetch(const void* address) noexcept;
+
+    // Starts a resize, if one isn't already in progress and the array is
+    // full enough to need one, and moves the old array's cells along.
+    void growIfNeeded();
+
+    // Starts a resize to half the capacity, if one isn't already in
+    // progress and the array has become empty enough to need one.
+    void shrinkIfNeeded();
+
+    // Adds a node for an element that is known not to be in the set yet.
+    void insertNew(const ElementType& element, unsigned int elementHash);
+
+    // Puts a node into the cell of the current array where it belongs,
+    // either at the front of its list or into its tree, turning the list
+    // into a tree if it has become too long.
+    void link(ListNode* node);
+
+    // Moves every node in the current array's list at the given index into
+    // a new tree.
+    void treeify(unsigned int index);
+
+    // Begins a resize by making the current array the "old" one and
+    // allocating a new one with the given capacity.
+    void startResize(unsigned int newCapacity);
+
+    // Moves up to the given number of the old array's cells into the new
+    // one, discarding the old array when its last cell has been moved.
+    void migrate(unsigned int budget);
+
+    void copyFrom(const HashSet& s);
+
     HashFunction hashFunction;
     ListNode** hash;
     unsigned int hash_capacity;
-    unsigned int hash_size;
     unsigned int elementNumber;
+    double maxLoad;
+    double minLoad;
+
+    // Parallel to the array, the tree that each cell has become, if any;
+    // nullptr until the first time a list is turned into a tree.
+    Tree** trees;
+    unsigned int treeifyThreshold;
+
+    unsigned int migrationBudget;
+    ListNode** oldHash;
+    Tree** oldTrees;
+    unsigned int oldCapacity;
+    unsigned int migrationIndex;
+
+    NodePool<ListNode> nodes;
 };
 
 
 
-namespace impl_
+template <typename ElementType, typename Hash, typename Sizing>
+HashSet<ElementType, Hash, Sizing>::HashSet(HashFunction hashFunction, unsigned int migrationBudget)
+        : hashFunction{hashFunction}, maxLoad{DEFAULT_MAX_LOAD_FACTOR}, minLoad{DEFAULT_MIN_LOAD_FACTOR},
+          migrationBudget{migrationBudget}
 {
-    template <typename ElementType>
-    unsigned int HashSet__undefinedHashFunction(const ElementType& element)
+    hash_capacity = Sizing::capacityAtLeast(DEFAULT_CAPACITY);
+    hash = createTable(hash_capacity);
+    elementNumber = 0;
+    trees = nullptr;
+    treeifyThreshold = DEFAULT_TREEIFY_THRESHOLD;
+
+    oldHash = nullptr;
+    oldTrees = nullptr;
+    oldCapacity = 0;
+    migrationIndex = 0;
+}
+
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+template <typename InputIterator>
+HashSet<ElementType, Hash, Sizing>::HashSet(
+    InputIterator first, InputIterator last, HashFunction hashFunction,
+    bool elementsAreUnique, unsigned int hashThreads)
+        : HashSet{hashFunction}
+{
+    using Category = typename std::iterator_traits<InputIterator>::iterator_category;
+
+    // An input iterator can only be traversed once, so there's no way to
+    // count its elements without consuming them.
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value)
+        reserve(static_cast<unsigned int>(std::distance(first, last)));
+
+    if constexpr (std::is_base_of<std::random_access_iterator_tag, Category>::value)
     {
-        return 0;
+        unsigned int count = static_cast<unsigned int>(last - first);
+
+        if (hashThreads > 1 && count > 0)
+        {
+            std::unique_ptr<unsigned int[]> hashes{new unsigned int[count]};
+            unsigned int perThread = (count + hashThreads - 1) / hashThreads;
+
+            unsigned int threadCount = (count + perThread - 1) / perThread;
+
+            std::unique_ptr<std::thread[]> threads{new std::thread[threadCount]};
+            for (unsigned int t = 0; t < threadCount; ++t)
+            {
+                unsigned int begin = t * perThread;
+                unsigned int end = count - begin < perThread ? count : begin + perThread;
+                threads[t] = std::thread{
+                    [&, begin, end]
+                    {
+                        for (unsigned int i = begin; i < end; ++i)
+                            hashes[i] = this->hashFunction(first[i]);
+                    }};
+            }
+
+            for (unsigned int t = 0; t < threadCount; ++t)
+                threads[t].join();
+
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                growIfNeeded();
+                if (elementsAreUnique || !isPresent(first[i], hashes[i]))
+                    insertNew(first[i], hashes[i]);
+            }
+
+            return;
+        }
+    }
+
+    for (; first != last; ++first)
+    {
+        if (elementsAreUnique)
+        {
+            growIfNeeded();
+            insertNew(*first, hashFunction(*first));
+        }
+        else
+        {
+            add(*first);
+        }
     }
 }
 
 
+template <typename ElementType, typename Hash, typename Sizing>
+HashSet<ElementType, Hash, Sizing>::~HashSet() noexcept
+{
+    destroyTable(hash, trees, hash_capacity);
+    destroyTable(oldHash, oldTrees, oldCapacity);
+}
 
-template <typename ElementType>
-HashSet<ElementType>::HashSet(HashFunction hashFunction)
-        : hashFunction{hashFunction}
+
+template <typename ElementType, typename Hash, typename Sizing>
+HashSet<ElementType, Hash, Sizing>::HashSet(const HashSet& s)
+        : hashFunction{s.hashFunction}, maxLoad{s.maxLoad}, minLoad{s.minLoad},
+          migrationBudget{s.migrationBudget}
 {
+    copyFrom(s);
+}
+
 
-    hash_capacity = DEFAULT_CAPACITY;
-    hash = new ListNode*[DEFAULT_CAPACITY];
-    for(int i =0; i < hash_capacity; i++)
+template <typename ElementType, typename Hash, typename Sizing>
+HashSet<ElementType, Hash, Sizing>::HashSet(HashSet&& s) noexcept
+        : hashFunction{s.hashFunction}, maxLoad{s.maxLoad}, minLoad{s.minLoad},
+          migrationBudget{s.migrationBudget}
+{
+    hash_capacity = s.hash_capacity;
+    hash = s.hash;
+    elementNumber = s.elementNumber;
+    trees = s.trees;
+    treeifyThreshold = s.treeifyThreshold;
+    oldHash = s.oldHash;
+    oldTrees = s.oldTrees;
+    oldCapacity = s.oldCapacity;
+    migrationIndex = s.migrationIndex;
+    nodes = std::move(s.nodes);
+
+    // The expiring set is left with an empty array of its own, so that it
+    // can still be destroyed or assigned into.
+    s.hash_capacity = 0;
+    s.hash = nullptr;
+    s.elementNumber = 0;
+    s.trees = nullptr;
+    s.oldHash = nullptr;
+    s.oldTrees = nullptr;
+    s.oldCapacity = 0;
+    s.migrationIndex = 0;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+HashSet<ElementType, Hash, Sizing>& HashSet<ElementType, Hash, Sizing>::operator=(const HashSet& s)
+{
+    if (this != &s)
     {
-        hash[i] = new ListNode;
+        destroyTable(hash, trees, hash_capacity);
+        destroyTable(oldHash, oldTrees, oldCapacity);
+        nodes.release();
+
+        hashFunction = s.hashFunction;
+        maxLoad = s.maxLoad;
+        minLoad = s.minLoad;
+        migrationBudget = s.migrationBudget;
+        copyFrom(s);
     }
-    hash_size = 0;
-    elementNumber=0;
+
+    return *this;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+HashSet<ElementType, Hash, Sizing>& HashSet<ElementType, Hash, Sizing>::operator=(HashSet&& s) noexcept
+{
+    std::swap(hashFunction, s.hashFunction);
+    std::swap(hash, s.hash);
+    std::swap(hash_capacity, s.hash_capacity);
+    std::swap(maxLoad, s.maxLoad);
+    std::swap(minLoad, s.minLoad);
+    std::swap(elementNumber, s.elementNumber);
+    std::swap(trees, s.trees);
+    std::swap(treeifyThreshold, s.treeifyThreshold);
+    std::swap(migrationBudget, s.migrationBudget);
+    std::swap(oldHash, s.oldHash);
+    std::swap(oldTrees, s.oldTrees);
+    std::swap(oldCapacity, s.oldCapacity);
+    std::swap(migrationIndex, s.migrationIndex);
+    std::swap(nodes, s.nodes);
+    return *this;
 }
 
 
+template <typename ElementType, typename Hash, typename Sizing>
+bool HashSet<ElementType, Hash, Sizing>::isImplemented() const noexcept
+{
+    return true;
+}
 
-template <typename ElementType>
-HashSet<ElementType>::~HashSet() noexcept
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::add(const ElementType& element)
 {
+    growIfNeeded();
+
+    unsigned int elementHash = hashFunction(element);
+    if (isPresent(element, elementHash))
+        return;
+
+    insertNew(element, elementHash);
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+bool HashSet<ElementType, Hash, Sizing>::contains(const ElementType& element) const
+{
+    if (hash_capacity == 0)
+        return false;
+
+    return isPresent(element, hashFunction(element));
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+template <typename Key, typename>
+bool HashSet<ElementType, Hash, Sizing>::contains(const Key& key) const
+{
+    if (hash_capacity == 0)
+        return false;
+
+    return isPresent(key, hashFunction(key));
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::remove(const ElementType& element)
+{
+    if (hash_capacity == 0)
+        return;
+
+    if (oldHash != nullptr)
+        migrate(migrationBudget);
 
-    for (int i = 0; i < hash_capacity; ++i) {
-        ListNode::deleteList(hash[i]);
+    unsigned int elementHash = hashFunction(element);
+    bool removed = removeFromCell(
+        hash, trees, Sizing::indexFor(elementHash, hash_capacity), element, elementHash);
+
+    if (!removed && oldHash != nullptr)
+    {
+        unsigned int oldIndex = Sizing::indexFor(elementHash, oldCapacity);
+        if (oldIndex >= migrationIndex)
+            removed = removeFromCell(oldHash, oldTrees, oldIndex, element, elementHash);
     }
-    delete []hash;
 
+    if (!removed)
+        return;
 
+    elementNumber = elementNumber - 1;
+    shrinkIfNeeded();
 }
 
 
-template <typename ElementType>
-HashSet<ElementType>::HashSet(const HashSet& s)
-        : hashFunction{impl_::HashSet__undefinedHashFunction<ElementType>}
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::containsMany(const ElementType* keys, unsigned int count, bool* results) const
 {
-    hash_capacity = s.hash_capacity;
-    hash_size = s.hash_size;
-    hash = new ListNode*[hash_capacity];
-    for(int i =0; i < hash_capacity; i++)
+    if (hash_capacity == 0)
     {
-        hash[i] = new ListNode;
+        for (unsigned int i = 0; i < count; ++i)
+            results[i] = false;
+
+        return;
     }
 
+    unsigned int hashes[BATCH_GROUP_SIZE];
 
-    for (int i = 0; i <hash_capacity ; ++i) {
-        ListNode* tmp = hash[i];
-        ListNode* copyTmp = s.hash[i];
-        while(copyTmp->next!= nullptr)
+    for (unsigned int first = 0; first < count; first += BATCH_GROUP_SIZE)
+    {
+        unsigned int groupSize = count - first < BATCH_GROUP_SIZE ? count - first : BATCH_GROUP_SIZE;
+
+        for (unsigned int i = 0; i < groupSize; ++i)
         {
-            tmp->next = new ListNode;
-            tmp->next->key = copyTmp->next->key;
-            copyTmp = copyTmp->next;
-            tmp = tmp->next;
+            hashes[i] = hashFunction(keys[first + i]);
+            prefetch(&hash[Sizing::indexFor(hashes[i], hash_capacity)]);
+        }
 
+        // By now, the first cells have most likely arrived, so their lists'
+        // first nodes can be requested while the rest are still loading.
+        for (unsigned int i = 0; i < groupSize; ++i)
+        {
+            ListNode* head = hash[Sizing::indexFor(hashes[i], hash_capacity)];
+            if (head != nullptr)
+                prefetch(head);
         }
 
+        for (unsigned int i = 0; i < groupSize; ++i)
+            results[first + i] = isPresent(keys[first + i], hashes[i]);
     }
+}
 
+
+template <typename ElementType, typename Hash, typename Sizing>
+unsigned int HashSet<ElementType, Hash, Sizing>::size() const noexcept
+{
+    return elementNumber;
 }
 
-template <typename ElementType>
-HashSet<ElementType>::HashSet(HashSet&& s) noexcept
-        : hashFunction{impl_::HashSet__undefinedHashFunction<ElementType>}
+
+template <typename ElementType, typename Hash, typename Sizing>
+typename HashSet<ElementType, Hash, Sizing>::Iterator HashSet<ElementType, Hash, Sizing>::begin() const noexcept
 {
-    hash_capacity = s.hash_capacity;
-    hash_size = s.hash_size;
-    hash = new ListNode*[hash_capacity];
-    for(int i =0; i < hash_capacity; i++)
-    {
-        hash[i] = new ListNode;
-    }
+    Iterator first{this};
+    first.seek();
+    return first;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+typename HashSet<ElementType, Hash, Sizing>::Iterator HashSet<ElementType, Hash, Sizing>::end() const noexcept
+{
+    return Iterator{};
+}
 
 
-    for (int i = 0; i <hash_capacity ; ++i) {
-        ListNode* tmp = hash[i];
-        ListNode* copyTmp = s.hash[i];
-        while(copyTmp->next!= nullptr)
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::forEach(VisitFunction visit) const
+{
+    ListNode** tables[] = {hash, oldHash};
+    Tree** tableTrees[] = {trees, oldTrees};
+    unsigned int capacities[] = {hash_capacity, oldCapacity};
+
+    for (unsigned int t = 0; t < 2; ++t)
+    {
+        unsigned int first = t == 0 ? 0 : migrationIndex;
+        for (unsigned int i = first; i < capacities[t]; ++i)
         {
-            tmp->next = new ListNode;
-            tmp->next->key = copyTmp->next->key;
-            copyTmp = copyTmp->next;
-            tmp = tmp->next;
+            for (ListNode* node = tables[t][i]; node != nullptr; node = node->next)
+                visit(node->key);
 
+            if constexpr (CAN_TREEIFY)
+            {
+                if (tableTrees[t] != nullptr && tableTrees[t][i] != nullptr)
+                    tableTrees[t][i]->inorder([&](const TreeEntry& entry) { visit(entry.key); });
+            }
         }
-
     }
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+bool HashSet<ElementType, Hash, Sizing>::isResizing() const noexcept
+{
+    return oldHash != nullptr;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+unsigned int HashSet<ElementType, Hash, Sizing>::capacity() const noexcept
+{
+    return hash_capacity;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+double HashSet<ElementType, Hash, Sizing>::loadFactor() const noexcept
+{
+    return hash_capacity == 0 ? 0.0 : static_cast<double>(elementNumber) / hash_capacity;
+}
+
 
+template <typename ElementType, typename Hash, typename Sizing>
+double HashSet<ElementType, Hash, Sizing>::maxLoadFactor() const noexcept
+{
+    return maxLoad;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::setMaxLoadFactor(double maxLoadFactor) noexcept
+{
+    maxLoad = maxLoadFactor;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+double HashSet<ElementType, Hash, Sizing>::minLoadFactor() const noexcept
+{
+    return minLoad;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::setMinLoadFactor(double minLoadFactor) noexcept
+{
+    minLoad = minLoadFactor;
 }
 
 
-template <typename ElementType>
-HashSet<ElementType>& HashSet<ElementType>::operator=(const HashSet& s)
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::setTreeifyThreshold(unsigned int treeifyThreshold) noexcept
 {
-    for(int i = 0; i < hash_capacity; i++) {
-        ListNode::deleteList(hash[i]);
+    this->treeifyThreshold = treeifyThreshold;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+unsigned int HashSet<ElementType, Hash, Sizing>::treeCount() const noexcept
+{
+    unsigned int count = 0;
+    Tree** tables[] = {trees, oldTrees};
+    unsigned int capacities[] = {hash_capacity, oldCapacity};
+
+    for (unsigned int t = 0; t < 2; ++t)
+    {
+        if (tables[t] == nullptr)
+            continue;
+
+        for (unsigned int i = 0; i < capacities[t]; ++i)
+        {
+            if (tables[t][i] != nullptr)
+                count = count + 1;
+        }
     }
 
-    delete[] hash;
+    return count;
+}
 
-    hash_size = s.size();
-    hash_capacity = s.hash_capacity;
 
-    hash = new ListNode*[hash_capacity]();
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::reserve(unsigned int elementCount)
+{
+    // Holding elementCount elements without exceeding the maximum load
+    // factor takes at least elementCount / maxLoad cells.
+    double needed = std::ceil(elementCount / maxLoad);
+    if (needed <= hash_capacity)
+        return;
+
+    unsigned int newCapacity = Sizing::capacityAtLeast(
+        needed < 4294967295.0 ? static_cast<unsigned int>(needed) : 4294967295u);
+
+    if (oldHash != nullptr)
+        migrate(oldCapacity);
 
-    for(int i = 0; i < hash_capacity; i++) {
-        hash[i] = new ListNode;
+    startResize(newCapacity);
+    migrate(oldCapacity);
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::shrinkToFit()
+{
+    if (oldHash != nullptr)
+        migrate(oldCapacity);
+
+    double needed = std::ceil(elementNumber / maxLoad);
+    unsigned int newCapacity = Sizing::capacityAtLeast(
+        needed < DEFAULT_CAPACITY ? DEFAULT_CAPACITY
+            : needed < 4294967295.0 ? static_cast<unsigned int>(needed) : 4294967295u);
+
+    // Every node is recreated in a fresh pool, so that when the old pool
+    // is destroyed, it takes all of the old slabs with it, including the
+    // free slots that removed elements left behind.
+    NodePool<ListNode> oldNodes{std::move(nodes)};
+    startResize(newCapacity);
+
+    for (unsigned int i = 0; i < oldCapacity; ++i)
+    {
+        for (ListNode* node = oldHash[i]; node != nullptr; node = node->next)
+            link(nodes.create(node->key, node->hashCode, nullptr));
+
+        if constexpr (CAN_TREEIFY)
+        {
+            if (oldTrees != nullptr && oldTrees[i] != nullptr)
+            {
+                oldTrees[i]->inorder(
+                    [this](const TreeEntry& entry)
+                    {
+                        link(nodes.create(entry.key, entry.hashCode, nullptr));
+                    });
+            }
+        }
     }
 
-    return *this;
+    destroyTable(oldHash, oldTrees, oldCapacity);
+
+    oldHash = nullptr;
+    oldTrees = nullptr;
+    oldCapacity = 0;
+    migrationIndex = 0;
 }
 
 
-template <typename ElementType>
-HashSet<ElementType>& HashSet<ElementType>::operator=(HashSet&& s) noexcept
+template <typename ElementType, typename Hash, typename Sizing>
+unsigned int HashSet<ElementType, Hash, Sizing>::elementsAtIndex(unsigned int index) const
 {
-    for (int i = 0; i < s.hash_capacity; ++i) {
-        while(s.hash[i]->next!= nullptr)
+    if (index >= hash_capacity)
+        return 0;
+
+    int counter = 0;
+    for (ListNode* head = hash[index]; head != nullptr; head = head->next)
+    {
+        counter = counter + 1;
+    }
+
+    if constexpr (CAN_TREEIFY)
+    {
+        if (trees != nullptr && trees[index] != nullptr)
+            counter = counter + trees[index]->size();
+    }
+
+    // Depending on the sizing policy, elements waiting in any of the old
+    // array's unmigrated cells might eventually land in this one.
+    if (oldHash != nullptr)
+    {
+        for (unsigned int i = migrationIndex; i < oldCapacity; ++i)
         {
-            this->add(s.hash[i]->next->key);
+            for (ListNode* node = oldHash[i]; node != nullptr; node = node->next)
+            {
+                if (Sizing::indexFor(node->hashCode, hash_capacity) == index)
+                    counter = counter + 1;
+            }
+
+            if constexpr (CAN_TREEIFY)
+            {
+                if (oldTrees != nullptr && oldTrees[i] != nullptr)
+                {
+                    oldTrees[i]->inorder(
+                        [&](const TreeEntry& entry)
+                        {
+                            if (Sizing::indexFor(entry.hashCode, hash_capacity) == index)
+                                counter = counter + 1;
+                        });
+                }
+            }
         }
     }
-    return *this;
+
+    return counter;
 }
 
 
-template <typename ElementType>
-bool HashSet<ElementType>::isImplemented() const noexcept
+template <typename ElementType, typename Hash, typename Sizing>
+bool HashSet<ElementType, Hash, Sizing>::isElementAtIndex(const ElementType& element, unsigned int index) const
 {
-    return true;
+    if (index >= hash_capacity)
+        return false;
+
+    unsigned int elementHash = hashFunction(element);
+    return Sizing::indexFor(elementHash, hash_capacity) == index
+        && isPresent(element, elementHash);
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+template <typename Key>
+bool HashSet<ElementType, Hash, Sizing>::isInCell(
+    ListNode** table, Tree** tableTrees, unsigned int index,
+    const Key& element, unsigned int elementHash)
+{
+    for (ListNode* test = table[index]; test != nullptr; test = test->next)
+    {
+        if (test->hashCode == elementHash && test->key == element)
+            return true;
+    }
+
+    if constexpr (CAN_TREEIFY)
+    {
+        if (tableTrees != nullptr && tableTrees[index] != nullptr)
+            return tableTrees[index]->contains(impl_::HashSet__TreeProbe<Key>{element, elementHash});
+    }
+
+    return false;
 }
 
-template <typename ElementType>
-void HashSet<ElementType>::add(const ElementType& element)
+
+template <typename ElementType, typename Hash, typename Sizing>
+template <typename Key>
+bool HashSet<ElementType, Hash, Sizing>::isPresent(const Key& element, unsigned int elementHash) const
 {
-    int elementIndex;
-    if ((hash_size / hash_capacity) > 0.8) {
-        int prevCapacity = hash_capacity;
-        hash_capacity = prevCapacity * 2;
+    if (isInCell(hash, trees, Sizing::indexFor(elementHash, hash_capacity), element, elementHash))
+        return true;
 
-        ListNode **oldHash = hash;
-        hash = new ListNode *[hash_capacity];
-        elementNumber = 0;
-        for (int i = 0; i < hash_capacity; i++) {
-            hash[i] = new ListNode;
+    if (oldHash != nullptr)
+    {
+        unsigned int oldIndex = Sizing::indexFor(elementHash, oldCapacity);
+        if (oldIndex >= migrationIndex)
+            return isInCell(oldHash, oldTrees, oldIndex, element, elementHash);
+    }
+
+    return false;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+bool HashSet<ElementType, Hash, Sizing>::removeFromCell(
+    ListNode** table, Tree** tableTrees, unsigned int index,
+    const ElementType& element, unsigned int elementHash)
+{
+    for (ListNode** previous = &table[index]; *previous != nullptr; previous = &(*previous)->next)
+    {
+        ListNode* node = *previous;
+        if (node->hashCode == elementHash && node->key == element)
+        {
+            *previous = node->next;
+            nodes.destroy(node);
+            return true;
         }
+    }
 
-        for (int j = 0; j < prevCapacity; ++j) {
-            ListNode *source = oldHash[j];
-            while (source->next != nullptr)
+    if constexpr (CAN_TREEIFY)
+    {
+        if (tableTrees != nullptr && tableTrees[index] != nullptr)
+        {
+            Tree* tree = tableTrees[index];
+            unsigned int sizeBefore = tree->size();
+            tree->remove(TreeEntry{element, elementHash});
+            bool removed = tree->size() < sizeBefore;
+
+            if (tree->size() <= treeifyThreshold / 2)
             {
-                ElementType copyElement = source->next->key;
-                elementIndex = hashFunction(copyElement) % hash_capacity;
-                if (hash[elementIndex]->next == nullptr) {
-                    hash[elementIndex]->next = new ListNode;
-                    hash[elementIndex]->next->key = copyElement;
-                    elementNumber = elementNumber + 1;
-                    hash_size = hash_size + 1;
-                } else {
-                    if (!this->isElementAtIndex(copyElement, elementIndex)) {
-                        ListNode *tmp = hash[elementIndex];
-                        while (tmp->next != nullptr) {
-                            tmp = tmp->next;
-                        }
-                        tmp->next = new ListNode;
-                        tmp->next->key = copyElement;
-                        elementNumber = elementNumber + 1;
-
-                    }
-                }
-                source = source->next;
+                // While a cell is a tree, its list is empty, so the tree's
+                // elements become the whole list.
+                tree->inorder(
+                    [&](const TreeEntry& entry)
+                    {
+                        table[index] = nodes.create(entry.key, entry.hashCode, table[index]);
+                    });
+
+                delete tree;
+                tableTrees[index] = nullptr;
             }
 
+            return removed;
         }
     }
 
-    elementIndex = hashFunction(element) % hash_capacity;
-    if (hash[elementIndex]->next == nullptr)
+    return false;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+typename HashSet<ElementType, Hash, Sizing>::ListNode** HashSet<ElementType, Hash, Sizing>::createTable(unsigned int capacity)
+{
+    return new ListNode*[capacity]();
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::destroyTable(ListNode** table, Tree** tableTrees, unsigned int capacity)
+{
+    if constexpr (CAN_TREEIFY)
     {
-        hash[elementIndex]->next = new ListNode;
-        hash[elementIndex]->next->key = element;
-        elementNumber = elementNumber + 1;
-        hash_size = hash_size + 1;
+        if (tableTrees != nullptr)
+        {
+            for (unsigned int i = 0; i < capacity; ++i)
+                delete tableTrees[i];
+
+            delete[] tableTrees;
+        }
     }
-    else
+
+    if (table == nullptr)
+        return;
+
+    if (NodePool<ListNode>::NEEDS_DISCARD)
     {
-        if (!this->isElementAtIndex(element, elementIndex))
+        for (unsigned int i = 0; i < capacity; ++i)
         {
-            ListNode *tmp = hash[elementIndex];
-            while (tmp->next != nullptr)
+            for (ListNode* node = table[i]; node != nullptr; )
             {
-                tmp = tmp->next;
+                ListNode* next = node->next;
+                nodes.discard(node);
+                node = next;
             }
-            tmp->next = new ListNode;
-            tmp->next->key = element;
-            elementNumber = elementNumber + 1;
+        }
+    }
+
+    delete[] table;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::prefetch(const void* address) noexcept
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void) address;
+#endif
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::growIfNeeded()
+{
+    if (oldHash != nullptr)
+    {
+        migrate(migrationBudget);
+    }
+    else if (hash_capacity == 0 || elementNumber + 1 > maxLoad * hash_capacity)
+    {
+        startResize(Sizing::capacityAtLeast(hash_capacity == 0 ? DEFAULT_CAPACITY : hash_capacity * 2));
+        migrate(migrationBudget == 0 ? oldCapacity : migrationBudget);
+    }
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::shrinkIfNeeded()
+{
+    unsigned int smallest = Sizing::capacityAtLeast(DEFAULT_CAPACITY);
+    if (oldHash != nullptr || hash_capacity <= smallest || elementNumber >= minLoad * hash_capacity)
+        return;
+
+    unsigned int newCapacity = Sizing::capacityAtLeast(hash_capacity / 2 < smallest ? smallest : hash_capacity / 2);
+    if (newCapacity >= hash_capacity)
+        return;
+
+    startResize(newCapacity);
+    migrate(migrationBudget == 0 ? oldCapacity : migrationBudget);
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::insertNew(const ElementType& element, unsigned int elementHash)
+{
+    link(nodes.create(element, elementHash, nullptr));
+    elementNumber = elementNumber + 1;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::link(ListNode* node)
+{
+    unsigned int index = Sizing::indexFor(node->hashCode, hash_capacity);
 
+    if constexpr (CAN_TREEIFY)
+    {
+        if (trees != nullptr && trees[index] != nullptr)
+        {
+            trees[index]->add(TreeEntry{node->key, node->hashCode});
+            nodes.destroy(node);
+            return;
         }
     }
 
+    node->next = hash[index];
+    hash[index] = node;
 
+    if constexpr (CAN_TREEIFY)
+    {
+        if (treeifyThreshold > 0)
+        {
+            unsigned int length = 0;
+            for (ListNode* n = node; n != nullptr && length <= treeifyThreshold; n = n->next)
+                length = length + 1;
+
+            if (length > treeifyThreshold)
+                treeify(index);
+        }
+    }
 }
 
 
-template <typename ElementType>
-bool HashSet<ElementType>::contains(const ElementType& element) const
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::treeify(unsigned int index)
 {
-    unsigned int index = hashFunction(element) % hash_capacity;
-    ListNode* test = hash[index];
-    while(test->next != nullptr)
+    if (trees == nullptr)
+        trees = new Tree*[hash_capacity]();
+
+    Tree* tree = new Tree;
+    while (hash[index] != nullptr)
     {
-        if(test->next->key == element)
-            return true;
-        test = test->next;
+        ListNode* node = hash[index];
+        hash[index] = node->next;
+        tree->add(TreeEntry{node->key, node->hashCode});
+        nodes.destroy(node);
     }
-    return false;
+
+    trees[index] = tree;
 }
 
 
-template <typename ElementType>
-unsigned int HashSet<ElementType>::size() const noexcept
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::startResize(unsigned int newCapacity)
 {
-    return elementNumber;
+    oldHash = hash;
+    oldTrees = trees;
+    oldCapacity = hash_capacity;
+    migrationIndex = 0;
+
+    hash_capacity = newCapacity;
+    hash = createTable(hash_capacity);
+    trees = nullptr;
 }
 
 
-template <typename ElementType>
-unsigned int HashSet<ElementType>::elementsAtIndex(unsigned int index) const
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::migrate(unsigned int budget)
 {
+    for (; budget > 0 && migrationIndex < oldCapacity; --budget, ++migrationIndex)
+    {
+        // The nodes themselves move into the new array; only the links
+        // between them change.
+        while (oldHash[migrationIndex] != nullptr)
+        {
+            ListNode* node = oldHash[migrationIndex];
+            oldHash[migrationIndex] = node->next;
+            link(node);
+        }
 
-    int counter = 0;
-    ListNode* head = hash[index];
-    while(head->next!= nullptr)
+        // A tree's elements go back into lists, which only become trees
+        // again if they're still too long in the new array.
+        if constexpr (CAN_TREEIFY)
+        {
+            if (oldTrees != nullptr && oldTrees[migrationIndex] != nullptr)
+            {
+                oldTrees[migrationIndex]->inorder(
+                    [this](const TreeEntry& entry)
+                    {
+                        link(nodes.create(entry.key, entry.hashCode, nullptr));
+                    });
+
+                delete oldTrees[migrationIndex];
+                oldTrees[migrationIndex] = nullptr;
+            }
+        }
+    }
+
+    if (migrationIndex >= oldCapacity)
     {
-        counter =counter+1;
-        head = head->next;
+        destroyTable(oldHash, oldTrees, oldCapacity);
+        oldHash = nullptr;
+        oldTrees = nullptr;
+        oldCapacity = 0;
+        migrationIndex = 0;
     }
-    return counter;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::copyFrom(const HashSet& s)
+{
+    hash_capacity = s.hash_capacity == 0 ? Sizing::capacityAtLeast(DEFAULT_CAPACITY) : s.hash_capacity;
+    hash = createTable(hash_capacity);
+    elementNumber = 0;
+    trees = nullptr;
+    treeifyThreshold = s.treeifyThreshold;
+    oldHash = nullptr;
+    oldTrees = nullptr;
+    oldCapacity = 0;
+    migrationIndex = 0;
+
+    // The copy is never in the middle of a resize; elements still in the
+    // source's old array are placed directly into the copy's only array.
+    ListNode** tables[] = {s.hash, s.oldHash};
+    Tree** tableTrees[] = {s.trees, s.oldTrees};
+    unsigned int capacities[] = {s.hash_capacity, s.oldCapacity};
+
+    for (unsigned int t = 0; t < 2; ++t)
+    {
+        unsigned int first = t == 0 ? 0 : s.migrationIndex;
+        for (unsigned int i = first; i < capacities[t]; ++i)
+        {
+            for (ListNode* copyTmp = tables[t][i]; copyTmp != nullptr; copyTmp = copyTmp->next)
+            {
+                link(nodes.create(copyTmp->key, copyTmp->hashCode, nullptr));
+                elementNumber = elementNumber + 1;
+            }
+
+            if constexpr (CAN_TREEIFY)
+            {
+                if (tableTrees[t] != nullptr && tableTrees[t][i] != nullptr)
+                {
+                    tableTrees[t][i]->inorder(
+                        [this](const TreeEntry& entry)
+                        {
+                            link(nodes.create(entry.key, entry.hashCode, nullptr));
+                            elementNumber = elementNumber + 1;
+                        });
+                }
+            }
+        }
+    }
+}
+
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+HashSet<ElementType, Hash, Sizing>::Iterator::Iterator() noexcept
+    : set{nullptr}, cells{nullptr}, cellTrees{nullptr}, capacity{0}, index{0}, node{nullptr}
+{
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+HashSet<ElementType, Hash, Sizing>::Iterator::Iterator(const HashSet* set) noexcept
+    : set{set}, cells{set->hash}, cellTrees{set->trees}, capacity{set->hash_capacity}, index{0}, node{nullptr}
+{
+}
 
 
+template <typename ElementType, typename Hash, typename Sizing>
+typename HashSet<ElementType, Hash, Sizing>::Iterator::reference
+HashSet<ElementType, Hash, Sizing>::Iterator::operator*() const noexcept
+{
+    return node != nullptr ? node->key : treeElement->key;
 }
 
 
-template <typename ElementType>
-bool HashSet<ElementType>::isElementAtIndex(const ElementType& element, unsigned int index) const
+template <typename ElementType, typename Hash, typename Sizing>
+typename HashSet<ElementType, Hash, Sizing>::Iterator::pointer
+HashSet<ElementType, Hash, Sizing>::Iterator::operator->() const noexcept
 {
-    ListNode* head = hash[index];
-    while(head->next!= nullptr)
+    return &**this;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+typename HashSet<ElementType, Hash, Sizing>::Iterator& HashSet<ElementType, Hash, Sizing>::Iterator::operator++() noexcept
+{
+    if (node != nullptr)
     {
-        if (element == head->next->key)
-            return true;
-        head = head->next;
+        node = node->next;
+        if (node != nullptr)
+            return *this;
+
+        if constexpr (CAN_TREEIFY)
+        {
+            if (cellTrees != nullptr && cellTrees[index] != nullptr)
+            {
+                treeElement = cellTrees[index]->begin();
+                return *this;
+            }
+        }
     }
-    return false;
+    else if constexpr (CAN_TREEIFY)
+    {
+        ++treeElement;
+        if (treeElement != typename Tree::Iterator{})
+            return *this;
+    }
+
+    index = index + 1;
+    seek();
+    return *this;
 }
 
 
+template <typename ElementType, typename Hash, typename Sizing>
+typename HashSet<ElementType, Hash, Sizing>::Iterator HashSet<ElementType, Hash, Sizing>::Iterator::operator++(int) noexcept
+{
+    Iterator old = *this;
+    ++*this;
+    return old;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+bool HashSet<ElementType, Hash, Sizing>::Iterator::operator==(const Iterator& other) const noexcept
+{
+    return node == other.node && treeElement == other.treeElement;
+}
+
+
+template <typename ElementType, typename Hash, typename Sizing>
+bool HashSet<ElementType, Hash, Sizing>::Iterator::operator!=(const Iterator& other) const noexcept
+{
+    return node != other.node || treeElement != other.treeElement;
+}
 
-#endif // HASHSET_HPP
 
+template <typename ElementType, typename Hash, typename Sizing>
+void HashSet<ElementType, Hash, Sizing>::Iterator::seek() noexcept
+{
+    while (true)
+    {
+        for (; index < capacity; ++index)
+        {
+            if (cells[index] != nullptr)
+            {
+                node = cells[index];
+
+                // The lists are scattered through memory, so the first node
+                // of a cell a little further along is requested now, to
+                // overlap its cache miss with the steps in between.
+                if (index + PREFETCH_DISTANCE < capacity)
+                    HashSet::prefetch(cells[index + PREFETCH_DISTANCE]);
+
+                return;
+            }
+
+            if constexpr (CAN_TREEIFY)
+            {
+                if (cellTrees != nullptr && cellTrees[index] != nullptr)
+                {
+                    treeElement = cellTrees[index]->begin();
+                    return;
+                }
+            }
+        }
+
+        if (cells == set->oldHash || set->oldHash == nullptr)
+            break;
+
+        cells = set->oldHash;
+        cellTrees = set->oldTrees;
+        capacity = set->oldCapacity;
+        index = set->migrationIndex;
+    }
+
+    cells = nullptr;
+    cellTrees = nullptr;
+    capacity = 0;
+    index = 0;
+}
+
+
+#endif // HASHSET_HPP
@@ -0,0 +1,246 @@
+// NodePool.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A NodePool hands out storage for the nodes of a linked data structure
+// (such as the lists in a HashSet or the tree in an AVLSet), so that the
+// structure doesn't have to go to the heap once per node.  Storage is
+// carved out of "slabs," contiguous blocks that each hold many nodes; the
+// slabs start small and double in size (up to a limit), so that a pool
+// that only ever holds a handful of nodes stays small.  Nodes that are
+// destroyed go onto a free list and are reused before any new storage is
+// carved out of a slab.
+//
+// When the structure is done with all of its nodes at once, release()
+// gives every slab back to the heap in one step.  Any nodes that are
+// still alive at that point need to have been discard()ed first, unless
+// their destructors don't do anything.
+
+#ifndef NODEPOOL_HPP
+#define NODEPOOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+
+template <typename Node>
+class NodePool
+{
+public:
+    // The number of nodes in the first slab, and the most that any one
+    // slab will hold.
+    static constexpr unsigned int FIRST_SLAB_SIZE = 16;
+    static constexpr unsigned int MAX_SLAB_SIZE = 4096;
+
+    // True when nodes have to be discard()ed before release(), because
+    // their destructors actually do something.
+    static constexpr bool NEEDS_DISCARD = !std::is_trivially_destructible<Node>::value;
+
+public:
+    // Initializes a NodePool with no slabs.
+    NodePool() noexcept;
+
+    // Gives every slab back to the heap.  Like release(), this does not
+    // run the destructors of any nodes still alive.
+    ~NodePool() noexcept;
+
+    // A NodePool can't be copied, since the nodes it holds are linked to
+    // one another by pointers that a copy would not know how to update,
+    // but it can be moved; the nodes stay exactly where they are.
+    NodePool(const NodePool& p) = delete;
+    NodePool& operator=(const NodePool& p) = delete;
+    NodePool(NodePool&& p) noexcept;
+    NodePool& operator=(NodePool&& p) noexcept;
+
+
+    // create() constructs a new node, passing the given arguments to its
+    // constructor, and returns a pointer to it.
+    template <typename... Args>
+    Node* create(Args&&... args);
+
+
+    // destroy() runs a node's destructor and makes its storage available
+    // to be reused by a subsequent call to create().
+    void destroy(Node* node) noexcept;
+
+
+    // discard() runs a node's destructor without recycling its storage,
+    // for use just before release().
+    void discard(Node* node) noexcept;
+
+
+    // release() gives every slab back to the heap at once, leaving the
+    // pool empty but still usable.
+    void release() noexcept;
+
+
+    // slabCount() returns the number of slabs the pool currently holds,
+    // which is also the number of heap allocations it has made since it
+    // was last released.
+    unsigned int slabCount() const noexcept;
+
+
+private:
+    union Slot
+    {
+        Slot* nextFree;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    struct Slab
+    {
+        Slab* next;
+        Slot* slots;
+    };
+
+    Slot* allocateSlot();
+
+    Slab* slabs;
+    Slot* freeList;
+    Slot* unused;
+    Slot* unusedEnd;
+    unsigned int nextSlabSize;
+    unsigned int slabNumber;
+};
+
+
+
+template <typename Node>
+NodePool<Node>::NodePool() noexcept
+    : slabs{nullptr}, freeList{nullptr}, unused{nullptr}, unusedEnd{nullptr},
+      nextSlabSize{FIRST_SLAB_SIZE}, slabNumber{0}
+{
+}
+
+
+template <typename Node>
+NodePool<Node>::~NodePool() noexcept
+{
+    release();
+}
+
+
+template <typename Node>
+NodePool<Node>::NodePool(NodePool&& p) noexcept
+    : NodePool{}
+{
+    *this = std::move(p);
+}
+
+
+template <typename Node>
+NodePool<Node>& NodePool<Node>::operator=(NodePool&& p) noexcept
+{
+    std::swap(slabs, p.slabs);
+    std::swap(freeList, p.freeList);
+    std::swap(unused, p.unused);
+    std::swap(unusedEnd, p.unusedEnd);
+    std::swap(nextSlabSize, p.nextSlabSize);
+    std::swap(slabNumber, p.slabNumber);
+    return *this;
+}
+
+
+template <typename Node>
+template <typename... Args>
+Node* NodePool<Node>::create(Args&&... args)
+{
+    Slot* slot = allocateSlot();
+
+    try
+    {
+        return new (slot->storage) Node(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        slot->nextFree = freeList;
+        freeList = slot;
+        throw;
+    }
+}
+
+
+template <typename Node>
+void NodePool<Node>::destroy(Node* node) noexcept
+{
+    node->~Node();
+
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    slot->nextFree = freeList;
+    freeList = slot;
+}
+
+
+template <typename Node>
+void NodePool<Node>::discard(Node* node) noexcept
+{
+    node->~Node();
+}
+
+
+template <typename Node>
+void NodePool<Node>::release() noexcept
+{
+    while (slabs != nullptr)
+    {
+        Slab* next = slabs->next;
+        ::operator delete(slabs);
+        slabs = next;
+    }
+
+    freeList = nullptr;
+    unused = nullptr;
+    unusedEnd = nullptr;
+    nextSlabSize = FIRST_SLAB_SIZE;
+    slabNumber = 0;
+}
+
+
+template <typename Node>
+unsigned int NodePool<Node>::slabCount() const noexcept
+{
+    return slabNumber;
+}
+
+
+template <typename Node>
+typename NodePool<Node>::Slot* NodePool<Node>::allocateSlot()
+{
+    if (freeList != nullptr)
+    {
+        Slot* slot = freeList;
+        freeList = slot->nextFree;
+        return slot;
+    }
+
+    if (unused == unusedEnd)
+    {
+        // The Slab header and its slots share one allocation; the slots
+        // start at the first suitably aligned offset after the header.
+        constexpr std::size_t headerSize =
+            (sizeof(Slab) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+
+        void* memory = ::operator new(headerSize + sizeof(Slot) * nextSlabSize);
+        Slab* slab = static_cast<Slab*>(memory);
+        slab->next = slabs;
+        slab->slots = reinterpret_cast<Slot*>(static_cast<unsigned char*>(memory) + headerSize);
+        slabs = slab;
+        slabNumber = slabNumber + 1;
+
+        unused = slab->slots;
+        unusedEnd = slab->slots + nextSlabSize;
+
+        if (nextSlabSize < MAX_SLAB_SIZE)
+            nextSlabSize = nextSlabSize * 2;
+    }
+
+    return unused++;
+}
+
+
+
+#endif // NODEPOOL_HPP
@@ -0,0 +1,351 @@
+// ReadMostlyHashSet.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// A ReadMostlyHashSet is a separately-chained hash table, like a HashSet,
+// that is meant to be shared by many threads when nearly every operation
+// is a lookup.  contains() never takes a lock and never writes to memory
+// that another thread writes to; it finishes in a number of steps bounded
+// by the length of one chain, no matter what other threads are doing.
+//
+// Writers take turns using a mutex.  A node is fully initialized before
+// it is published by storing a pointer to it (atomically) at the front of
+// its chain, and it is never modified afterward, so a reader either sees
+// it completely or not at all.  When the table needs to be resized, the
+// writer builds a complete new array with copies of every node and then
+// publishes it by atomically replacing the pointer to the table.  Readers
+// that were already walking the old table may keep doing so, so the old
+// table is handed to an EpochReclaimer, which deletes it only once every
+// reader that could have seen it is done.
+
+#ifndef READMOSTLYHASHSET_HPP
+#define READMOSTLYHASHSET_HPP
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include "EpochReclaimer.hpp"
+#include "Set.hpp"
+
+
+
+template <typename ElementType, typename Hash = std::function<unsigned int(const ElementType&)>>
+class ReadMostlyHashSet : public Set<ElementType>
+{
+public:
+    // The default capacity of the ReadMostlyHashSet before anything has
+    // been added to it.
+    static constexpr unsigned int DEFAULT_CAPACITY = 16;
+
+    // A HashFunction is a function that takes a reference to a const
+    // ElementType and returns an unsigned int.  It may be called from
+    // several threads at once.
+    using HashFunction = Hash;
+
+public:
+    // Initializes a ReadMostlyHashSet to be empty, so that it will use the
+    // given hash function whenever it needs to hash an element.
+    explicit ReadMostlyHashSet(HashFunction hashFunction);
+
+    // Cleans up the ReadMostlyHashSet so that it leaks no memory.  No
+    // other thread may be using it at the time.
+    virtual ~ReadMostlyHashSet() noexcept;
+
+    // Initializes a new ReadMostlyHashSet to be a copy of an existing one,
+    // which other threads may continue to use while it's being copied.
+    ReadMostlyHashSet(const ReadMostlyHashSet& s);
+
+    // A ReadMostlyHashSet can't be moved or assigned, since there's no
+    // way to do that while other threads might be using either one.
+    ReadMostlyHashSet(ReadMostlyHashSet&& s) = delete;
+    ReadMostlyHashSet& operator=(const ReadMostlyHashSet& s) = delete;
+    ReadMostlyHashSet& operator=(ReadMostlyHashSet&& s) = delete;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  Calls to add() from different
+    // threads take turns; they never block calls to contains().
+    virtual void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  It can be called by any number of threads at once
+    // without taking any locks.
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // capacity() returns the number of cells in the current array.
+    unsigned int capacity() const;
+
+
+    // retiredCount() returns the number of old arrays that have been
+    // replaced but not yet deleted, because readers might still be
+    // using them.
+    unsigned int retiredCount() const;
+
+
+    // elementsAtIndex() returns the number of elements that hashed to a
+    // particular index in the array.  If the index is out of the boundaries
+    // of the array, this function returns 0.
+    unsigned int elementsAtIndex(unsigned int index) const;
+
+
+    // isElementAtIndex() returns true if the given element hashed to a
+    // particular index in the array, false otherwise.  If the index is
+    // out of the boundaries of the array, this functions returns false.
+    bool isElementAtIndex(const ElementType& element, unsigned int index) const;
+
+
+private:
+    struct ListNode
+    {
+        ElementType key;
+        unsigned int hashCode;
+        ListNode* next;
+    };
+
+    struct Table
+    {
+        unsigned int capacity;
+        std::atomic<ListNode*>* cells;
+    };
+
+    static Table* createTable(unsigned int capacity);
+    static void destroyTable(void* table);
+
+    // findNode() returns the node in the given table containing the given
+    // element, or nullptr if there isn't one.
+    static const ListNode* findNode(const Table* t, const ElementType& element, unsigned int elementHash);
+
+    // copyInto() adds a copy of every node in one table to another.
+    static void copyInto(Table* to, const Table* from);
+
+    void resize();
+
+    HashFunction hashFunction;
+    std::atomic<Table*> table;
+    std::atomic<unsigned int> elementNumber;
+
+    mutable std::mutex writeLock;
+    EpochReclaimer reclaimer;
+};
+
+
+
+template <typename ElementType, typename Hash>
+ReadMostlyHashSet<ElementType, Hash>::ReadMostlyHashSet(HashFunction hashFunction)
+    : hashFunction{hashFunction}, table{createTable(DEFAULT_CAPACITY)}, elementNumber{0}
+{
+}
+
+
+template <typename ElementType, typename Hash>
+ReadMostlyHashSet<ElementType, Hash>::~ReadMostlyHashSet() noexcept
+{
+    destroyTable(table.load());
+}
+
+
+template <typename ElementType, typename Hash>
+ReadMostlyHashSet<ElementType, Hash>::ReadMostlyHashSet(const ReadMostlyHashSet& s)
+    : hashFunction{s.hashFunction}, table{nullptr}, elementNumber{0}
+{
+    std::lock_guard<std::mutex> guard{s.writeLock};
+
+    const Table* from = s.table.load(std::memory_order_acquire);
+    Table* to = createTable(from->capacity);
+    copyInto(to, from);
+
+    table.store(to);
+    elementNumber.store(s.elementNumber.load());
+}
+
+
+template <typename ElementType, typename Hash>
+bool ReadMostlyHashSet<ElementType, Hash>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType, typename Hash>
+void ReadMostlyHashSet<ElementType, Hash>::add(const ElementType& element)
+{
+    unsigned int elementHash = hashFunction(element);
+    std::lock_guard<std::mutex> guard{writeLock};
+
+    // Only writers replace the table, so it can't change while we hold
+    // the write lock.
+    Table* t = table.load(std::memory_order_relaxed);
+    if (findNode(t, element, elementHash) != nullptr)
+        return;
+
+    std::atomic<ListNode*>& cell = t->cells[elementHash % t->capacity];
+    ListNode* node = new ListNode{element, elementHash, cell.load(std::memory_order_relaxed)};
+    cell.store(node, std::memory_order_release);
+
+    unsigned int newSize = elementNumber.load(std::memory_order_relaxed) + 1;
+    elementNumber.store(newSize, std::memory_order_relaxed);
+
+    if (newSize * 5 > t->capacity * 4)
+        resize();
+    else if (reclaimer.pendingCount() > 0)
+        reclaimer.collect();
+}
+
+
+template <typename ElementType, typename Hash>
+bool ReadMostlyHashSet<ElementType, Hash>::contains(const ElementType& element) const
+{
+    unsigned int elementHash = hashFunction(element);
+
+    EpochReclaimer::Guard guard = reclaimer.pin();
+    return findNode(table.load(std::memory_order_acquire), element, elementHash) != nullptr;
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int ReadMostlyHashSet<ElementType, Hash>::size() const noexcept
+{
+    return elementNumber.load(std::memory_order_relaxed);
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int ReadMostlyHashSet<ElementType, Hash>::capacity() const
+{
+    EpochReclaimer::Guard guard = reclaimer.pin();
+    return table.load(std::memory_order_acquire)->capacity;
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int ReadMostlyHashSet<ElementType, Hash>::retiredCount() const
+{
+    std::lock_guard<std::mutex> guard{writeLock};
+    return reclaimer.pendingCount();
+}
+
+
+template <typename ElementType, typename Hash>
+unsigned int ReadMostlyHashSet<ElementType, Hash>::elementsAtIndex(unsigned int index) const
+{
+    EpochReclaimer::Guard guard = reclaimer.pin();
+    const Table* t = table.load(std::memory_order_acquire);
+
+    if (index >= t->capacity)
+        return 0;
+
+    unsigned int counter = 0;
+    for (const ListNode* node = t->cells[index].load(std::memory_order_acquire);
+         node != nullptr; node = node->next)
+    {
+        counter = counter + 1;
+    }
+
+    return counter;
+}
+
+
+template <typename ElementType, typename Hash>
+bool ReadMostlyHashSet<ElementType, Hash>::isElementAtIndex(const ElementType& element, unsigned int index) const
+{
+    unsigned int elementHash = hashFunction(element);
+
+    EpochReclaimer::Guard guard = reclaimer.pin();
+    const Table* t = table.load(std::memory_order_acquire);
+
+    return index < t->capacity
+        && elementHash % t->capacity == index
+        && findNode(t, element, elementHash) != nullptr;
+}
+
+
+template <typename ElementType, typename Hash>
+typename ReadMostlyHashSet<ElementType, Hash>::Table* ReadMostlyHashSet<ElementType, Hash>::createTable(unsigned int capacity)
+{
+    Table* t = new Table{capacity, new std::atomic<ListNode*>[capacity]};
+    for (unsigned int i = 0; i < capacity; ++i)
+        t->cells[i].store(nullptr, std::memory_order_relaxed);
+
+    return t;
+}
+
+
+template <typename ElementType, typename Hash>
+void ReadMostlyHashSet<ElementType, Hash>::destroyTable(void* table)
+{
+    Table* t = static_cast<Table*>(table);
+
+    for (unsigned int i = 0; i < t->capacity; ++i)
+    {
+        ListNode* node = t->cells[i].load(std::memory_order_relaxed);
+        while (node != nullptr)
+        {
+            ListNode* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    delete[] t->cells;
+    delete t;
+}
+
+
+template <typename ElementType, typename Hash>
+const typename ReadMostlyHashSet<ElementType, Hash>::ListNode* ReadMostlyHashSet<ElementType, Hash>::findNode(
+    const Table* t, const ElementType& element, unsigned int elementHash)
+{
+    for (const ListNode* node = t->cells[elementHash % t->capacity].load(std::memory_order_acquire);
+         node != nullptr; node = node->next)
+    {
+        if (node->hashCode == elementHash && node->key == element)
+            return node;
+    }
+
+    return nullptr;
+}
+
+
+template <typename ElementType, typename Hash>
+void ReadMostlyHashSet<ElementType, Hash>::copyInto(Table* to, const Table* from)
+{
+    for (unsigned int i = 0; i < from->capacity; ++i)
+    {
+        for (const ListNode* node = from->cells[i].load(std::memory_order_relaxed);
+             node != nullptr; node = node->next)
+        {
+            std::atomic<ListNode*>& cell = to->cells[node->hashCode % to->capacity];
+            cell.store(new ListNode{node->key, node->hashCode, cell.load(std::memory_order_relaxed)},
+                       std::memory_order_relaxed);
+        }
+    }
+}
+
+
+template <typename ElementType, typename Hash>
+void ReadMostlyHashSet<ElementType, Hash>::resize()
+{
+    Table* oldTable = table.load(std::memory_order_relaxed);
+    Table* newTable = createTable(oldTable->capacity * 2);
+
+    // Readers may still be walking the old table's chains, so its nodes
+    // can't be relinked; the new table gets copies of them instead.
+    copyInto(newTable, oldTable);
+
+    table.store(newTable, std::memory_order_release);
+    reclaimer.retire(oldTable, destroyTable);
+}
+
+
+
+#endif // READMOSTLYHASHSET_HPP
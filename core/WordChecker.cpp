@@ -6,91 +6,179 @@
 // Replace and/or augment the implementations below as needed to meet
 // the requirements.
 
+#include <algorithm>
+#include <memory>
 #include "WordChecker.hpp"
 
 
 
+namespace
+{
+    const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+
+    void addSuggestion(std::vector<std::string>& suggestions, const std::string& suggestion)
+    {
+        if (std::find(suggestions.begin(), suggestions.end(), suggestion) == suggestions.end())
+            suggestions.push_back(suggestion);
+    }
+}
+
+
+
 WordChecker::WordChecker(const Set<std::string>& words)
-    : words{words}
+    : words{words}, batch{dynamic_cast<const BatchLookup<std::string>*>(&words)}, filter{nullptr}
+{
+}
+
+
+WordChecker::WordChecker(const Set<std::string>& words, const BloomFilter& filter)
+    : words{words}, batch{dynamic_cast<const BatchLookup<std::string>*>(&words)}, filter{&filter}
 {
 }
 
 
 bool WordChecker::wordExists(const std::string& word) const
 {
-    return words.contains(word);
+    return (filter == nullptr || filter->mightContain(word)) && words.contains(word);
+}
+
+
+void WordChecker::lookUp(const std::vector<std::string>& candidates, unsigned int count, bool* found) const
+{
+    if (filter != nullptr)
+    {
+        // So few candidates get past the filter that there's nothing to
+        // gain from looking them up as a batch.
+        for (unsigned int i = 0; i < count; i++)
+            found[i] = filter->mightContain(candidates[i]) && words.contains(candidates[i]);
+
+        return;
+    }
+
+    if (batch != nullptr)
+    {
+        batch->containsMany(candidates.data(), count, found);
+        return;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+        found[i] = words.contains(candidates[i]);
 }
 
 
 std::vector<std::string> WordChecker::findSuggestions(const std::string& word) const
 {
-      std::vector<std::string> suggestions;
-    std::string alphabet ="ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::vector<std::string> suggestions;
+
+    // All of the candidates from one kind of edit are built first and then
+    // looked up together, so that a Set that supports batches can overlap
+    // their lookups.  Inserting a letter produces the most candidates, so
+    // there's always room for that many; the strings are reused from one
+    // kind of edit to the next rather than being allocated again.  Only
+    // candidates that turn out to be words are copied into the suggestions.
+    const unsigned int maxCandidates = alphabet.size() * (word.size() + 1);
+    std::vector<std::string> candidates(maxCandidates);
+    std::unique_ptr<bool[]> found{new bool[maxCandidates]};
+    unsigned int count;
 
+    for (std::string& candidate : candidates)
+        candidate.reserve(word.size() + 1);
 
 
     //Swapping
-    for (int i = 0; i < word.size() - 1; i++)
+    count = 0;
+    for (std::size_t i = 0; i + 1 < word.size(); i++)
     {
-        std::string temp = word;
-        std::swap(temp[i], temp[i+1]);
-        if (wordExists(temp) && (std::find(suggestions.begin(), suggestions.end(), temp) == suggestions.end()))
-            suggestions.push_back(temp);
+        std::string& candidate = candidates[count++];
+        candidate = word;
+        std::swap(candidate[i], candidate[i+1]);
     }
 
-
+    lookUp(candidates, count, found.get());
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (found[i])
+            addSuggestion(suggestions, candidates[i]);
+    }
 
 
     //Insert
-    for (int i = 0; i <= word.size(); i++)
+    count = 0;
+    for (std::size_t i = 0; i <= word.size(); i++)
     {
-        for (int x = 0; x < alphabet.size(); x++)
+        for (char letter : alphabet)
         {
-            std::string temp = word;
-            temp.insert(i, alphabet.substr(x,1));
-            if (wordExists(temp) && (std::find(suggestions.begin(), suggestions.end(), temp) == suggestions.end()))
-                suggestions.push_back(temp);
+            std::string& candidate = candidates[count++];
+            candidate.assign(word, 0, i);
+            candidate.push_back(letter);
+            candidate.append(word, i, std::string::npos);
         }
     }
 
+    lookUp(candidates, count, found.get());
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (found[i])
+            addSuggestion(suggestions, candidates[i]);
+    }
+
 
     //Delete
-    for (int i = 0; i < word.size(); i++)
+    count = 0;
+    for (std::size_t i = 0; i < word.size(); i++)
     {
-        std::string temp = word;
-        temp = temp.erase(i,1);
-        if (wordExists(temp) && (std::find(suggestions.begin(), suggestions.end(), temp) == suggestions.end()))
-            suggestions.push_back(temp);
+        std::string& candidate = candidates[count++];
+        candidate.assign(word, 0, i);
+        candidate.append(word, i + 1, std::string::npos);
+    }
+
+    lookUp(candidates, count, found.get());
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (found[i])
+            addSuggestion(suggestions, candidates[i]);
     }
 
 
     //Replace
-    for (int i = 0; i < word.size(); i++)
+    count = 0;
+    for (std::size_t i = 0; i < word.size(); i++)
     {
-
-        for (int y = 0; y < alphabet.size(); y++)
+        for (char letter : alphabet)
         {
-            std::string temp = word;
-            temp[i] = alphabet[y]; // might have to use replace
-            if (wordExists(temp) && (std::find(suggestions.begin(), suggestions.end(), temp) == suggestions.end()))
-                suggestions.push_back(temp);
+            std::string& candidate = candidates[count++];
+            candidate = word;
+            candidate[i] = letter;
         }
+    }
 
+    lookUp(candidates, count, found.get());
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (found[i])
+            addSuggestion(suggestions, candidates[i]);
     }
 
 
     //Split
-    for (int i = 1; i < word.size(); i++)
+    //
+    // The first halves go in the first half of the candidates and the
+    // second halves right after them, so that both are looked up at once.
+    unsigned int splits = word.size() > 1 ? word.size() - 1 : 0;
+    for (std::size_t i = 1; i < word.size(); i++)
     {
-        std::string temp1 = word.substr(0,i);
-        std::string temp2 = word.substr(i);
-        std::string temp = temp1 + " " + temp2;
-        if (wordExists(temp1) && wordExists(temp2) && (std::find(suggestions.begin(), suggestions.end(), temp) == suggestions.end()))
-            suggestions.push_back(temp);
+        candidates[i - 1].assign(word, 0, i);
+        candidates[splits + i - 1].assign(word, i, std::string::npos);
     }
 
+    lookUp(candidates, 2 * splits, found.get());
+    for (unsigned int i = 0; i < splits; i++)
+    {
+        if (found[i] && found[splits + i])
+            addSuggestion(suggestions, candidates[i] + " " + candidates[splits + i]);
+    }
 
 
     return suggestions;
 }
-
@@ -18,6 +18,8 @@
 
 #include <string>
 #include <vector>
+#include "BatchLookup.hpp"
+#include "BloomFilter.hpp"
 #include "Set.hpp"
 
 
@@ -30,6 +32,12 @@ public:
     // whenever it needs to look up a word.
     WordChecker(const Set<std::string>& words);
 
+    // This constructor also takes a BloomFilter containing the same
+    // words, which is checked before the Set, so that most candidates
+    // that aren't words are ruled out without being looked up.  The
+    // WordChecker stores a reference to the filter, too.
+    WordChecker(const Set<std::string>& words, const BloomFilter& filter);
+
 
     // wordExists() returns true if the given word is spelled correctly,
     // false otherwise.
@@ -43,7 +51,18 @@ public:
 
 
 private:
+    // lookUp() stores into found[i] whether candidates[i] is a word, for
+    // each of the first count candidates, looking them up as one batch
+    // when the Set supports it.
+    void lookUp(const std::vector<std::string>& candidates, unsigned int count, bool* found) const;
+
     const Set<std::string>& words;
+
+    // The same Set, if it's also a BatchLookup; nullptr otherwise.
+    const BatchLookup<std::string>* batch;
+
+    // The BloomFilter in front of the Set, or nullptr if there isn't one.
+    const BloomFilter* filter;
 };
 
 
@@ -0,0 +1,427 @@
+// AVLSetBenchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Benchmarks for looking elements up in an AVLSet, reporting both the time
+// per lookup and how many heap allocations each lookup makes, for loading
+// a dictionary into one, for answering questions about positions and
+// ranges in ascending order, for finding all of the words that start with
+// a given prefix, for merging whole dictionaries, and for looking elements
+// up in a frozen copy of an AVLSet rather than in the tree itself.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Benchmarks.hpp"
+#include "FrozenAVLSet.hpp"
+
+
+namespace
+{
+    // Looks up every key once, in the order given, and reports nanoseconds
+    // and heap allocations per lookup, along with how many were found.
+    template <typename SetType, typename Key>
+    void lookups(const std::string& name, const SetType& s, const std::vector<Key>& keys)
+    {
+        unsigned long long allocationsBefore = heapAllocations();
+        unsigned int found = 0;
+
+        Stopwatch timer;
+        for (const Key& key : keys)
+        {
+            if (s.contains(key))
+                ++found;
+        }
+        double ns = timer.elapsedNanoseconds() / static_cast<double>(keys.size());
+
+        double allocations =
+            (heapAllocations() - allocationsBefore) / static_cast<double>(keys.size());
+
+        std::cout << "  " << std::left << std::setw(32) << name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(8) << ns << " ns/lookup, "
+                  << std::setprecision(2) << allocations << " allocations/lookup ("
+                  << found << " of " << keys.size() << " found)" << std::endl;
+    }
+
+
+    void stringLookups(unsigned int count)
+    {
+        // Half of the words are added; looking all of them up, shuffled,
+        // gives an even mix of hits and misses.
+        std::vector<std::string> words = makeWords(count * 2);
+
+        AVLSet<std::string> s;
+        for (unsigned int i = 0; i < count; ++i)
+            s.add(words[i]);
+
+        std::shuffle(words.begin(), words.end(), std::mt19937{46});
+
+        std::vector<std::string_view> views{words.begin(), words.end()};
+
+        std::cout << "AVLSet<std::string> lookups (" << count << " words)" << std::endl;
+        lookups("std::string keys", s, words);
+        lookups("std::string_view keys", s, views);
+    }
+
+
+    void intLookups(unsigned int count)
+    {
+        std::vector<int> keys(count * 2);
+        for (unsigned int i = 0; i < keys.size(); ++i)
+            keys[i] = static_cast<int>(i);
+
+        std::mt19937 engine{46};
+        std::shuffle(keys.begin(), keys.end(), engine);
+
+        AVLSet<int> s;
+        for (unsigned int i = 0; i < count; ++i)
+            s.add(keys[i]);
+
+        std::shuffle(keys.begin(), keys.end(), engine);
+
+        std::cout << "AVLSet<int> lookups (" << count << " elements)" << std::endl;
+        lookups("int keys", s, keys);
+    }
+
+
+    template <typename Load>
+    void loadTime(const std::string& name, Load load)
+    {
+        Stopwatch timer;
+        AVLSet<std::string> s = load();
+        double seconds = timer.elapsedSeconds();
+
+        std::cout << "  " << std::left << std::setw(32) << name << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(8) << seconds
+                  << " s (" << s.size() << " words, height " << s.height() << ")" << std::endl;
+    }
+
+
+    // Loads a dictionary whose words are already sorted, as a dictionary
+    // file's are, by adding them one at a time and by building the tree
+    // all at once, and then loads the same words in random order.
+    void dictionaryLoads(unsigned int count)
+    {
+        std::vector<std::string> sorted = makeWords(count);
+        std::sort(sorted.begin(), sorted.end());
+
+        std::vector<std::string> shuffled = sorted;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937{46});
+
+        std::cout << "Loading a dictionary into an AVLSet (" << count << " words)" << std::endl;
+
+        loadTime("sorted, add() each word",
+            [&]
+            {
+                AVLSet<std::string> s;
+                for (const std::string& word : sorted)
+                    s.add(word);
+                return s;
+            });
+
+        loadTime("sorted, assignSorted()",
+            [&]
+            {
+                AVLSet<std::string> s;
+                s.assignSorted(sorted.begin(), sorted.end());
+                return s;
+            });
+
+        loadTime("sorted, range constructor",
+            [&] { return AVLSet<std::string>{sorted.begin(), sorted.end()}; });
+
+        loadTime("shuffled, add() each word",
+            [&]
+            {
+                AVLSet<std::string> s;
+                for (const std::string& word : shuffled)
+                    s.add(word);
+                return s;
+            });
+
+        loadTime("shuffled, range constructor",
+            [&] { return AVLSet<std::string>{shuffled.begin(), shuffled.end()}; });
+    }
+
+
+    // Times "queries" calls to "query" and reports microseconds per query.
+    template <typename Query>
+    void queryTime(const std::string& name, unsigned int queries, Query query)
+    {
+        unsigned long long total = 0;
+
+        Stopwatch timer;
+        for (unsigned int i = 0; i < queries; ++i)
+            total += query(i);
+        double us = timer.elapsedNanoseconds() / 1000.0 / queries;
+
+        std::cout << "  " << std::left << std::setw(32) << name << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(12) << us
+                  << " us/query (checksum " << total << ")" << std::endl;
+    }
+
+
+    // Counts the words between two random words and finds the word at a
+    // random position, which is what paging through a dictionary does,
+    // both with the subtree sizes and by walking the tree in order.
+    void orderStatistics(unsigned int count)
+    {
+        std::vector<std::string> words = makeWords(count);
+        std::sort(words.begin(), words.end());
+
+        AVLSet<std::string> s;
+        s.assignSorted(words.begin(), words.end());
+
+        std::mt19937 engine{46};
+        std::uniform_int_distribution<unsigned int> position{0, count - 1};
+
+        constexpr unsigned int QUERIES = 100000;
+        constexpr unsigned int SCANS = 20;
+
+        std::vector<std::pair<std::string, std::string>> ranges;
+        std::vector<unsigned int> positions;
+        for (unsigned int i = 0; i < QUERIES; ++i)
+        {
+            unsigned int a = position(engine);
+            unsigned int b = position(engine);
+            ranges.emplace_back(words[std::min(a, b)], words[std::max(a, b)]);
+            positions.push_back(position(engine));
+        }
+
+        std::cout << "Order statistics on an AVLSet (" << count << " words)" << std::endl;
+
+        queryTime("countInRange()", QUERIES,
+            [&](unsigned int i) { return s.countInRange(ranges[i].first, ranges[i].second); });
+
+        queryTime("inorder() counting the range", SCANS,
+            [&](unsigned int i)
+            {
+                unsigned int inRange = 0;
+                s.inorder(
+                    [&](const std::string& word)
+                    {
+                        if (ranges[i].first <= word && word <= ranges[i].second)
+                            ++inRange;
+                    });
+                return inRange;
+            });
+
+        queryTime("select()", QUERIES,
+            [&](unsigned int i) { return s.select(positions[i]).size(); });
+
+        queryTime("iterating to the position", SCANS,
+            [&](unsigned int i) { return std::next(s.begin(), positions[i])->size(); });
+
+        queryTime("rank()", QUERIES,
+            [&](unsigned int i) { return s.rank(ranges[i].first); });
+    }
+
+
+    // Finds every word with a given prefix, taken from the start of a
+    // random word in the dictionary, by starting at lowerBound() and
+    // walking forward, with forEachInRange(), and by walking the whole
+    // tree inorder.  The dictionary is about the size of a full English
+    // one.
+    void prefixEnumeration(unsigned int count)
+    {
+        std::vector<std::string> words = makeWords(count);
+
+        AVLSet<std::string> s{words.begin(), words.end()};
+
+        constexpr unsigned int QUERIES = 10000;
+        constexpr unsigned int SCANS = 10;
+
+        std::cout << "Enumerating words by prefix (" << count << " words)" << std::endl;
+
+        for (unsigned int length = 1; length <= 4; ++length)
+        {
+            std::mt19937 engine{46};
+            std::uniform_int_distribution<unsigned int> position{0, count - 1};
+
+            std::vector<std::string> prefixes;
+            for (unsigned int i = 0; i < QUERIES; ++i)
+                prefixes.push_back(words[position(engine)].substr(0, length));
+
+            auto hasPrefix = [&](const std::string& word, unsigned int i)
+            {
+                return word.compare(0, prefixes[i].size(), prefixes[i]) == 0;
+            };
+
+            std::cout << " prefix length " << length << std::endl;
+
+            queryTime("lowerBound() and iterating", QUERIES,
+                [&](unsigned int i)
+                {
+                    unsigned int found = 0;
+                    for (auto w = s.lowerBound(prefixes[i]); w != s.end() && hasPrefix(*w, i); ++w)
+                        ++found;
+                    return found;
+                });
+
+            // The words are all uppercase letters, so every word with the
+            // prefix comes before the prefix followed by '~'.
+            queryTime("forEachInRange()", QUERIES,
+                [&](unsigned int i)
+                {
+                    unsigned int found = 0;
+                    s.forEachInRange(prefixes[i], prefixes[i] + '~', [&](const std::string&) { ++found; });
+                    return found;
+                });
+
+            queryTime("inorder()", SCANS,
+                [&](unsigned int i)
+                {
+                    unsigned int found = 0;
+                    s.inorder([&](const std::string& word) { found += hasPrefix(word, i); });
+                    return found;
+                });
+        }
+    }
+
+
+    std::string threadCount(unsigned int threads)
+    {
+        return std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+    }
+
+
+    // Times one set operation on a copy of "target" (the copy isn't timed)
+    // and reports seconds and the size of the result.
+    template <typename Operation>
+    void operationTime(const std::string& name, const AVLSet<std::string>& target, Operation operation)
+    {
+        AVLSet<std::string> s{target};
+
+        Stopwatch timer;
+        operation(s);
+        double seconds = timer.elapsedSeconds();
+
+        std::cout << "  " << std::left << std::setw(32) << name << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(8) << seconds
+                  << " s (" << s.size() << " words)" << std::endl;
+    }
+
+
+    // Merges two dictionaries of "count" words each, half of whose words
+    // are in both, by adding or removing one word at a time and with the
+    // set operations on 1 thread up to the number of hardware threads (or
+    // 4, if there are fewer), and then applies a small blocklist to one.
+    void setAlgebra(unsigned int count)
+    {
+        std::vector<std::string> words = makeWords(count + count / 2);
+
+        AVLSet<std::string> a{words.begin(), words.begin() + count};
+        AVLSet<std::string> b{words.end() - count, words.end()};
+        AVLSet<std::string> blocklist{words.begin(), words.begin() + count / 100};
+
+        unsigned int maxThreads = std::max(4u, std::thread::hardware_concurrency());
+
+        std::cout << "Merging two AVLSets (" << count << " words each, "
+                  << count / 2 << " in both)" << std::endl;
+
+        operationTime("add() each word", a,
+            [&](AVLSet<std::string>& s) { for (const std::string& word : b) s.add(word); });
+
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            operationTime("unionWith(), " + threadCount(threads), a,
+                [&](AVLSet<std::string>& s) { s.unionWith(b, threads); });
+        }
+
+        operationTime("remove() words not in both", a,
+            [&](AVLSet<std::string>& s)
+            {
+                for (unsigned int i = 0; i < count / 2; ++i)
+                    s.remove(words[i]);
+            });
+
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            operationTime("intersectWith(), " + threadCount(threads), a,
+                [&](AVLSet<std::string>& s) { s.intersectWith(b, threads); });
+        }
+
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            operationTime("differenceWith(), " + threadCount(threads), a,
+                [&](AVLSet<std::string>& s) { s.differenceWith(b, threads); });
+        }
+
+        std::cout << "Applying a blocklist (" << blocklist.size() << " words) to an AVLSet ("
+                  << count << " words)" << std::endl;
+
+        operationTime("remove() each word", a,
+            [&](AVLSet<std::string>& s) { for (const std::string& word : blocklist) s.remove(word); });
+
+        operationTime("differenceWith()", a,
+            [&](AVLSet<std::string>& s) { s.differenceWith(blocklist); });
+    }
+
+
+    // Adds the first half of the keys to a tree one at a time, in the order
+    // given, freezes it, and then looks all of the keys up, shuffled, in
+    // both the tree and the frozen copy.
+    template <typename ElementType>
+    void frozenLookups(const std::string& name, std::vector<ElementType>& keys)
+    {
+        unsigned int count = keys.size() / 2;
+
+        AVLSet<ElementType> s;
+        for (unsigned int i = 0; i < count; ++i)
+            s.add(keys[i]);
+
+        Stopwatch timer;
+        FrozenAVLSet<ElementType> frozen = s.freeze();
+        double seconds = timer.elapsedSeconds();
+
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{46});
+
+        std::cout << "Freezing an AVLSet<" << name << "> (" << count << " elements, freeze() took "
+                  << std::fixed << std::setprecision(3) << seconds << " s)" << std::endl;
+        lookups("AVLSet", s, keys);
+        lookups("FrozenAVLSet", frozen, keys);
+    }
+
+
+    void frozenIntLookups(unsigned int count)
+    {
+        std::vector<int> keys(count * 2);
+        for (unsigned int i = 0; i < keys.size(); ++i)
+            keys[i] = static_cast<int>(i);
+
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{46});
+        frozenLookups("int", keys);
+    }
+
+
+    void frozenStringLookups(unsigned int count)
+    {
+        std::vector<std::string> words = makeWords(count * 2);
+        frozenLookups("std::string", words);
+    }
+}
+
+
+void runAVLSetBenchmarks()
+{
+    stringLookups(1000000);
+    intLookups(1000000);
+    dictionaryLoads(1000000);
+    orderStatistics(1000000);
+    prefixEnumeration(466000);
+    setAlgebra(1000000);
+
+    for (unsigned int count : {10000, 1000000, 10000000})
+    {
+        frozenIntLookups(count);
+        frozenStringLookups(count);
+    }
+}
@@ -0,0 +1,133 @@
+// Benchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Implementations of the utilities declared in Benchmarks.hpp.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <unordered_set>
+#include "Benchmarks.hpp"
+
+
+
+namespace
+{
+    unsigned long long allocationCount = 0;
+    std::atomic<std::size_t> bytesInUse{0};
+
+    // Each allocation is preceded by its size, so that operator delete
+    // knows how many bytes it's giving back.  The header is as large as
+    // the strictest alignment, so the memory after it is still aligned.
+    constexpr std::size_t HEADER_SIZE = alignof(std::max_align_t);
+}
+
+
+// Replacing the global operator new (and the matching operator delete)
+// is how the benchmarks count heap allocations and the bytes in use.
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+
+    void* p = std::malloc(HEADER_SIZE + size);
+    if (p == nullptr)
+        throw std::bad_alloc{};
+
+    *static_cast<std::size_t*>(p) = size;
+    bytesInUse += size;
+    return static_cast<char*>(p) + HEADER_SIZE;
+}
+
+
+void operator delete(void* p) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    void* start = static_cast<char*>(p) - HEADER_SIZE;
+    bytesInUse -= *static_cast<std::size_t*>(start);
+    std::free(start);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+
+unsigned long long heapAllocations()
+{
+    return allocationCount;
+}
+
+
+std::size_t heapBytesInUse()
+{
+    return bytesInUse;
+}
+
+
+Stopwatch::Stopwatch()
+    : start{std::chrono::steady_clock::now()}
+{
+}
+
+
+void Stopwatch::restart()
+{
+    start = std::chrono::steady_clock::now();
+}
+
+
+double Stopwatch::elapsedSeconds() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+long long Stopwatch::elapsedNanoseconds() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+
+std::vector<std::string> makeWords(unsigned int count, unsigned int seed)
+{
+    std::mt19937 engine{seed};
+    std::uniform_int_distribution<int> letter{'A', 'Z'};
+    std::binomial_distribution<int> length{14, 0.5};
+
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> words;
+    words.reserve(count);
+
+    while (words.size() < count)
+    {
+        std::string word(std::max(2, length(engine)), ' ');
+        for (char& c : word)
+            c = static_cast<char>(letter(engine));
+
+        if (seen.insert(word).second)
+            words.push_back(word);
+    }
+
+    return words;
+}
+
+
+long long percentile(std::vector<long long>& samples, double p)
+{
+    if (samples.empty())
+        return 0;
+
+    std::sort(samples.begin(), samples.end());
+    std::size_t index = static_cast<std::size_t>(p / 100.0 * (samples.size() - 1));
+    return samples[index];
+}
@@ -0,0 +1,69 @@
+// Benchmarks.hpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Declarations shared by the benchmarks in the "exp" directory, along with
+// a few small utilities for generating workloads and timing them.  Each
+// group of benchmarks is a function that prints its results to std::cout;
+// expmain.cpp decides which ones run.
+
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+
+// A Stopwatch measures elapsed wall-clock time from when it was created
+// (or last restarted).
+class Stopwatch
+{
+public:
+    Stopwatch();
+
+    void restart();
+    double elapsedSeconds() const;
+    long long elapsedNanoseconds() const;
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+
+// makeWords() returns the given number of distinct, randomly-generated
+// uppercase words, with lengths distributed roughly like the words in an
+// English dictionary.  The same seed always produces the same words.
+std::vector<std::string> makeWords(unsigned int count, unsigned int seed = 46);
+
+
+// heapAllocations() returns the number of times the global operator new
+// has been called since the program started.
+unsigned long long heapAllocations();
+
+
+// heapBytesInUse() returns the number of bytes that have been allocated
+// with the global operator new and not yet deleted.
+std::size_t heapBytesInUse();
+
+
+// percentile() returns the value at the given percentile (0-100) of a
+// collection of samples, which it sorts in place.
+long long percentile(std::vector<long long>& samples, double p);
+
+
+void runHashSetBenchmarks();
+void runNodePoolBenchmarks();
+void runConcurrencyBenchmarks();
+void runFrozenHashSetBenchmarks();
+void runWordCheckerBenchmarks();
+void runChurnBenchmarks();
+void runIterationBenchmarks();
+void runAVLSetBenchmarks();
+
+
+
+#endif // BENCHMARKS_HPP
@@ -0,0 +1,146 @@
+// ChurnBenchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Benchmarks for removing elements from the sets, both for pruning words
+// from a dictionary that's already loaded and for a steady mix of adds and
+// removes, along with how much memory a HashSet gives back afterward.
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Benchmarks.hpp"
+#include "FastHash.hpp"
+#include "HashSet.hpp"
+
+
+namespace
+{
+    using StringHashSet = HashSet<std::string, FastHash<std::string>>;
+
+
+    // Loads every word, then prunes every tenth one, either by removing
+    // each of them or by building a new set from the words that remain
+    // (which is what pruning took before there was a remove()).  While
+    // rebuilding, the old and new sets both exist; the extra memory is
+    // what the new one adds to what the old one already held.
+    template <typename SetType>
+    void pruning(const std::string& name, const std::vector<std::string>& words)
+    {
+        std::unique_ptr<SetType> s{new SetType};
+        for (const std::string& word : words)
+            s->add(word);
+
+        Stopwatch removing;
+        for (unsigned int i = 0; i < words.size(); i += 10)
+            s->remove(words[i]);
+        double removeSeconds = removing.elapsedSeconds();
+
+        s.reset(new SetType);
+        for (const std::string& word : words)
+            s->add(word);
+
+        std::size_t before = heapBytesInUse();
+
+        Stopwatch rebuilding;
+        std::unique_ptr<SetType> rebuilt{new SetType};
+        for (unsigned int i = 0; i < words.size(); ++i)
+        {
+            if (i % 10 != 0)
+                rebuilt->add(words[i]);
+        }
+        std::size_t extra = heapBytesInUse() - before;
+        s.reset();
+        double rebuildSeconds = rebuilding.elapsedSeconds();
+
+        std::cout << "  " << std::left << std::setw(8) << name << std::right
+                  << std::fixed << std::setprecision(3)
+                  << " remove() " << removeSeconds << " s"
+                  << ", rebuild " << rebuildSeconds << " s with "
+                  << extra / 1024 << " KB extra (" << rebuilt->size() << " words left)" << std::endl;
+    }
+
+
+    // Keeps a set at a steady size while replacing its words: each step
+    // adds a word that isn't in the set and removes the oldest one that
+    // is, reporting nanoseconds per step.
+    template <typename SetType>
+    void churn(const std::string& name, const std::vector<std::string>& words, unsigned int live, SetType* s)
+    {
+        for (unsigned int i = 0; i < live; ++i)
+            s->add(words[i]);
+
+        unsigned int steps = words.size() - live;
+        Stopwatch timer;
+        for (unsigned int i = 0; i < steps; ++i)
+        {
+            s->add(words[live + i]);
+            s->remove(words[i]);
+        }
+        double ns = timer.elapsedNanoseconds() / static_cast<double>(steps);
+
+        std::cout << "  " << std::left << std::setw(8) << name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(8) << ns
+                  << " ns per add/remove pair (" << s->size() << " words)" << std::endl;
+
+        delete s;
+    }
+
+
+    // Loads every word, removes 90% of them, and reports the heap memory
+    // the HashSet holds at each step, with and without shrinking.
+    void massDeletion(const std::vector<std::string>& words, double minLoadFactor)
+    {
+        std::size_t baseline = heapBytesInUse();
+
+        StringHashSet s{FastHash<std::string>{}};
+        s.setMinLoadFactor(minLoadFactor);
+        for (const std::string& word : words)
+            s.add(word);
+
+        std::size_t full = heapBytesInUse() - baseline;
+
+        for (unsigned int i = 0; i < words.size(); ++i)
+        {
+            if (i % 10 != 0)
+                s.remove(words[i]);
+        }
+
+        std::size_t pruned = heapBytesInUse() - baseline;
+        unsigned int prunedCapacity = s.capacity();
+
+        Stopwatch shrinking;
+        s.shrinkToFit();
+        double shrinkSeconds = shrinking.elapsedSeconds();
+
+        std::size_t shrunk = heapBytesInUse() - baseline;
+
+        std::cout << "  min load " << std::fixed << std::setprecision(1) << minLoadFactor
+                  << ": full " << full / 1024 << " KB"
+                  << ", after removing 90% " << pruned / 1024 << " KB (" << prunedCapacity << " cells)"
+                  << ", after shrinkToFit() " << shrunk / 1024 << " KB (" << s.capacity() << " cells, "
+                  << std::setprecision(3) << shrinkSeconds << " s)" << std::endl;
+    }
+}
+
+
+void runChurnBenchmarks()
+{
+    std::vector<std::string> words = makeWords(500000);
+
+    std::cout << "Pruning every tenth word (" << words.size() << " words)" << std::endl;
+    pruning<StringHashSet>("HashSet", words);
+    pruning<AVLSet<std::string>>("AVLSet", words);
+
+    std::cout << "Churn at a steady 200000 words (" << words.size() - 200000 << " replacements)" << std::endl;
+    churn("HashSet", words, 200000, new StringHashSet{FastHash<std::string>{}});
+    churn("AVLSet", words, 200000, new AVLSet<std::string>);
+
+    std::cout << "HashSet memory after mass deletion (" << words.size() << " words)" << std::endl;
+    massDeletion(words, 0.0);
+    massDeletion(words, StringHashSet::DEFAULT_MIN_LOAD_FACTOR);
+}
@@ -0,0 +1,122 @@
+// ConcurrencyBenchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Benchmarks for looking up words in a shared dictionary from many threads
+// at once, comparing a HashSet behind one global mutex, the ConcurrentHashSet,
+// and the lock-free readers of the ReadMostlyHashSet.
+
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "ConcurrentHashSet.hpp"
+#include "HashSet.hpp"
+#include "ReadMostlyHashSet.hpp"
+
+
+namespace
+{
+    struct StringHash
+    {
+        unsigned int operator()(const std::string& s) const
+        {
+            unsigned int hash = 0;
+            for (char c : s)
+                hash = hash * 31 + static_cast<unsigned char>(c);
+            return hash;
+        }
+    };
+
+
+    // A HashSet behind one mutex, which is what callers had to do before
+    // there was a ConcurrentHashSet.
+    class LockedHashSet
+    {
+    public:
+        void add(const std::string& word)
+        {
+            std::lock_guard<std::mutex> guard{lock};
+            words.add(word);
+        }
+
+        bool contains(const std::string& word) const
+        {
+            std::lock_guard<std::mutex> guard{lock};
+            return words.contains(word);
+        }
+
+    private:
+        mutable std::mutex lock;
+        HashSet<std::string, StringHash> words{StringHash{}};
+    };
+
+
+    // Runs the given number of threads, each of which looks up every probe
+    // word, and returns the total number of lookups per second.
+    template <typename SetType>
+    double lookupThroughput(const SetType& s, const std::vector<std::string>& probes, unsigned int threadCount)
+    {
+        std::vector<std::thread> threads;
+        std::vector<unsigned int> found(threadCount);
+
+        Stopwatch elapsed;
+        for (unsigned int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t]
+            {
+                unsigned int count = 0;
+                for (const std::string& probe : probes)
+                    count += s.contains(probe) ? 1 : 0;
+                found[t] = count;
+            });
+        }
+
+        for (std::thread& thread : threads)
+            thread.join();
+
+        return static_cast<double>(probes.size()) * threadCount / elapsed.elapsedSeconds();
+    }
+}
+
+
+void runConcurrencyBenchmarks()
+{
+    std::vector<std::string> words = makeWords(400000);
+    std::vector<std::string> dictionary(words.begin(), words.begin() + 200000);
+
+    // Half of the probes are in the dictionary and half aren't.
+    std::vector<std::string> probes;
+    for (unsigned int i = 0; i < 200000; ++i)
+        probes.push_back(words[(i % 2 == 0) ? i : 200000 + i]);
+
+    LockedHashSet locked;
+    ConcurrentHashSet<std::string, StringHash> striped{StringHash{}};
+    ReadMostlyHashSet<std::string, StringHash> lockFree{StringHash{}};
+    for (const std::string& word : dictionary)
+    {
+        locked.add(word);
+        striped.add(word);
+        lockFree.add(word);
+    }
+
+    unsigned int maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads < 4)
+        maxThreads = 4;
+
+    std::cout << "Concurrent lookups (" << std::thread::hardware_concurrency()
+              << " hardware threads), millions of lookups/s" << std::endl;
+
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::cout << "  " << std::setw(3) << threads << " threads: global mutex "
+                  << std::fixed << std::setprecision(2)
+                  << lookupThroughput(locked, probes, threads) / 1e6
+                  << ", striped " << lookupThroughput(striped, probes, threads) / 1e6
+                  << ", lock-free readers " << lookupThroughput(lockFree, probes, threads) / 1e6 << std::endl;
+    }
+}
@@ -0,0 +1,192 @@
+// FrozenHashSetBenchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Benchmarks comparing the FrozenHashSet to the HashSet and the AVLSet it
+// can be built from: how long each takes to build, how much memory each
+// uses per word, and how long each takes to look words up, along with how
+// long a program takes to get a dictionary ready when it starts.
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Benchmarks.hpp"
+#include "FastHash.hpp"
+#include "FrozenHashSet.hpp"
+#include "HashSet.hpp"
+
+
+namespace
+{
+    // Builds a set with the given function, then looks up every key,
+    // reporting the build time, the heap bytes per word that the set is
+    // still using afterward, and nanoseconds per lookup.
+    template <typename SetType, typename BuildFunction>
+    void buildAndLookUp(
+        const std::string& name, unsigned int wordCount,
+        const std::vector<std::string>& keys, BuildFunction buildSet)
+    {
+        std::size_t bytesBefore = heapBytesInUse();
+        Stopwatch build;
+        SetType* s = buildSet();
+        double buildSeconds = build.elapsedSeconds();
+        double bytesPerWord = static_cast<double>(heapBytesInUse() - bytesBefore) / wordCount;
+
+        unsigned int found = 0;
+        Stopwatch lookup;
+        for (const std::string& key : keys)
+            found += s->contains(key) ? 1 : 0;
+        double ns = lookup.elapsedNanoseconds() / static_cast<double>(keys.size());
+
+        std::cout << "  " << std::left << std::setw(14) << name << std::right
+                  << " build " << std::fixed << std::setprecision(3) << buildSeconds << " s, "
+                  << std::setprecision(1) << std::setw(6) << bytesPerWord << " bytes/word, "
+                  << std::setw(6) << ns << " ns/lookup (" << found << " found)" << std::endl;
+
+        delete s;
+    }
+
+
+    std::vector<std::string> readWords(const std::string& path)
+    {
+        std::ifstream in{path};
+        std::vector<std::string> words;
+        std::string word;
+        while (std::getline(in, word))
+            words.push_back(word);
+        return words;
+    }
+
+
+    // Times how long it takes to get a dictionary ready to use, from a
+    // word list or from an image, up to and including the first lookup,
+    // since a mapped image isn't read until it's used.
+    void startupTime(const std::vector<std::string>& words)
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path();
+        std::string listPath = (directory / "FrozenHashSetBenchmarks.txt").string();
+        std::string imagePath = (directory / "FrozenHashSetBenchmarks.img").string();
+
+        {
+            std::ofstream out{listPath};
+            for (const std::string& word : words)
+                out << word << '\n';
+        }
+
+        {
+            std::vector<std::string> list = readWords(listPath);
+            FrozenHashSet{list.begin(), list.end()}.saveImage(imagePath);
+        }
+
+        auto report = [](const std::string& name, double seconds, bool found)
+        {
+            std::cout << "  " << std::left << std::setw(32) << name << std::right
+                      << std::fixed << std::setprecision(2) << seconds * 1000.0 << " ms"
+                      << (found ? "" : " (unexpected lookup result)") << std::endl;
+        };
+
+        {
+            Stopwatch startup;
+            std::vector<std::string> list = readWords(listPath);
+            HashSet<std::string> s{list.begin(), list.end()};
+            report("word list, HashSet", startup.elapsedSeconds(), s.contains(words[0]));
+        }
+
+        {
+            Stopwatch startup;
+            std::vector<std::string> list = readWords(listPath);
+            AVLSet<std::string> s;
+            for (const std::string& word : list)
+                s.add(word);
+            report("word list, AVLSet", startup.elapsedSeconds(), s.contains(words[0]));
+        }
+
+        {
+            Stopwatch startup;
+            std::vector<std::string> list = readWords(listPath);
+            FrozenHashSet s{list.begin(), list.end()};
+            report("word list, FrozenHashSet", startup.elapsedSeconds(), s.contains(words[0]));
+        }
+
+        {
+            Stopwatch startup;
+            FrozenHashSet s;
+            bool found = s.mapImage(imagePath) && s.contains(words[0]);
+            report("image, checksum verified", startup.elapsedSeconds(), found);
+        }
+
+        {
+            Stopwatch startup;
+            FrozenHashSet s;
+            bool found = s.mapImage(imagePath, false) && s.contains(words[0]);
+            report("image, trusted", startup.elapsedSeconds(), found);
+        }
+
+        std::remove(listPath.c_str());
+        std::remove(imagePath.c_str());
+    }
+}
+
+
+void runFrozenHashSetBenchmarks()
+{
+    std::vector<std::string> words = makeWords(500000);
+    std::vector<std::string> absent = makeWords(500000, 47);
+
+    std::size_t characters = 0;
+    for (const std::string& word : words)
+        characters += word.size();
+
+    // About half of the lookups are for words in the set (a few of the
+    // "absent" words happen to be in the set, too), in a random order.
+    std::vector<std::string> keys(words);
+    keys.insert(keys.end(), absent.begin(), absent.end());
+    std::mt19937 engine{46};
+    std::shuffle(keys.begin(), keys.end(), engine);
+
+    HashSet<std::string> hashed{words.begin(), words.end(), FastHash<std::string>{}, true};
+    AVLSet<std::string> tree;
+    for (const std::string& word : words)
+        tree.add(word);
+
+    std::cout << "Frozen dictionaries (" << words.size() << " words, "
+              << std::fixed << std::setprecision(1)
+              << static_cast<double>(characters) / words.size() << " characters/word)" << std::endl;
+
+    buildAndLookUp<HashSet<std::string>>(
+        "HashSet", words.size(), keys,
+        [&] { return new HashSet<std::string>{words.begin(), words.end(), FastHash<std::string>{}, true}; });
+
+    buildAndLookUp<AVLSet<std::string>>(
+        "AVLSet", words.size(), keys,
+        [&]
+        {
+            AVLSet<std::string>* s = new AVLSet<std::string>;
+            for (const std::string& word : words)
+                s->add(word);
+            return s;
+        });
+
+    buildAndLookUp<FrozenHashSet>(
+        "Frozen (range)", words.size(), keys,
+        [&] { return new FrozenHashSet{words.begin(), words.end()}; });
+
+    buildAndLookUp<FrozenHashSet>(
+        "Frozen (hash)", words.size(), keys,
+        [&] { return new FrozenHashSet{hashed}; });
+
+    buildAndLookUp<FrozenHashSet>(
+        "Frozen (AVL)", words.size(), keys,
+        [&] { return new FrozenHashSet{tree}; });
+
+    std::cout << "Dictionary startup (" << words.size() << " words)" << std::endl;
+    startupTime(words);
+}
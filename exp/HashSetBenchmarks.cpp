@@ -0,0 +1,412 @@
+// HashSetBenchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Benchmarks for the HashSet and the alternative hash table implementations.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "FastHash.hpp"
+#include "FlatHashSet.hpp"
+#include "HashSet.hpp"
+
+
+namespace
+{
+    unsigned int stringHash(const std::string& s)
+    {
+        unsigned int hash = 0;
+        for (char c : s)
+            hash = hash * 31 + static_cast<unsigned char>(c);
+        return hash;
+    }
+
+
+    unsigned int intHash(const int& i)
+    {
+        return static_cast<unsigned int>(i) * 2654435761u;
+    }
+
+
+    struct StringHash
+    {
+        unsigned int operator()(const std::string& s) const { return stringHash(s); }
+    };
+
+
+    struct IntHash
+    {
+        unsigned int operator()(const int& i) const { return intHash(i); }
+    };
+
+
+    // Times one lookup of every key (half of which are present) in a set
+    // that has already been filled, reporting nanoseconds per lookup.
+    template <typename SetType, typename Key>
+    double lookupTime(SetType& s, const std::vector<Key>& present, const std::vector<Key>& absent)
+    {
+        for (const Key& key : present)
+            s.add(key);
+
+        unsigned int found = 0;
+        Stopwatch lookup;
+        for (unsigned int i = 0; i < present.size(); ++i)
+        {
+            found += s.contains(present[i]) ? 1 : 0;
+            found += s.contains(absent[i]) ? 1 : 0;
+        }
+        double ns = lookup.elapsedNanoseconds() / (2.0 * present.size());
+
+        if (found != present.size())
+            std::cout << "  (unexpected lookup results)" << std::endl;
+
+        return ns;
+    }
+
+
+    void hashPolicies(const std::vector<std::string>& words)
+    {
+        unsigned int half = words.size() / 2;
+        std::vector<std::string> present(words.begin(), words.begin() + half);
+        std::vector<std::string> absent(words.begin() + half, words.begin() + 2 * half);
+
+        std::vector<int> presentInts;
+        std::vector<int> absentInts;
+        for (unsigned int i = 0; i < half; ++i)
+        {
+            presentInts.push_back(static_cast<int>(2 * i));
+            absentInts.push_back(static_cast<int>(2 * i + 1));
+        }
+
+        HashSet<int> intErased{intHash};
+        HashSet<int, IntHash> intInlined{IntHash{}};
+        HashSet<std::string> stringErased{stringHash};
+        HashSet<std::string, StringHash> stringInlined{StringHash{}};
+        FlatHashSet<int> flatIntErased{intHash};
+        FlatHashSet<int, IntHash> flatIntInlined{IntHash{}};
+        FlatHashSet<std::string> flatStringErased{stringHash};
+        FlatHashSet<std::string, StringHash> flatStringInlined{StringHash{}};
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "  HashSet<int>:             std::function " << lookupTime(intErased, presentInts, absentInts)
+                  << " ns, functor " << lookupTime(intInlined, presentInts, absentInts) << " ns" << std::endl
+                  << "  HashSet<std::string>:     std::function " << lookupTime(stringErased, present, absent)
+                  << " ns, functor " << lookupTime(stringInlined, present, absent) << " ns" << std::endl
+                  << "  FlatHashSet<int>:         std::function " << lookupTime(flatIntErased, presentInts, absentInts)
+                  << " ns, functor " << lookupTime(flatIntInlined, presentInts, absentInts) << " ns" << std::endl
+                  << "  FlatHashSet<std::string>: std::function " << lookupTime(flatStringErased, present, absent)
+                  << " ns, functor " << lookupTime(flatStringInlined, present, absent) << " ns" << std::endl;
+    }
+
+
+    // Measures the latency of every individual add() while building a
+    // HashSet, which is where an all-at-once resize shows up as a spike.
+    void insertLatency(const std::vector<std::string>& words, unsigned int migrationBudget)
+    {
+        HashSet<std::string> s{stringHash, migrationBudget};
+        std::vector<long long> latencies;
+        latencies.reserve(words.size());
+
+        Stopwatch total;
+        for (const std::string& word : words)
+        {
+            Stopwatch one;
+            s.add(word);
+            latencies.push_back(one.elapsedNanoseconds());
+        }
+        double seconds = total.elapsedSeconds();
+
+        std::cout << "  migration budget " << std::setw(4) << migrationBudget
+                  << ": total " << std::fixed << std::setprecision(3) << seconds << " s"
+                  << ", p50 " << percentile(latencies, 50.0) << " ns"
+                  << ", p99 " << percentile(latencies, 99.0) << " ns"
+                  << ", p99.9 " << percentile(latencies, 99.9) << " ns"
+                  << ", max " << latencies.back() << " ns" << std::endl;
+    }
+
+
+    // Builds a HashSet while counting hash function calls, then looks up
+    // every word in a HashSet whose hash function only produces a few
+    // distinct values, so that the chains are long.
+    void growthAndLongChains(const std::vector<std::string>& words)
+    {
+        unsigned long long hashCalls = 0;
+        HashSet<std::string> s{[&](const std::string& w) { ++hashCalls; return stringHash(w); }};
+
+        Stopwatch build;
+        for (const std::string& word : words)
+            s.add(word);
+
+        std::cout << "  build: " << std::fixed << std::setprecision(3) << build.elapsedSeconds()
+                  << " s, " << hashCalls << " hash calls for " << words.size() << " words" << std::endl;
+
+        HashSet<std::string> chained{[](const std::string& w) { return stringHash(w) % 64; }};
+        unsigned int count = words.size() < 20000 ? words.size() : 20000;
+        for (unsigned int i = 0; i < count; ++i)
+            chained.add(words[i]);
+
+        Stopwatch lookup;
+        unsigned int found = 0;
+        for (unsigned int i = 0; i < count; ++i)
+            found += chained.contains(words[i]) ? 1 : 0;
+
+        std::cout << "  " << count << " lookups in chains of ~" << count / 64 << ": "
+                  << std::setprecision(1) << lookup.elapsedNanoseconds() / static_cast<double>(count)
+                  << " ns/lookup (" << found << " found)" << std::endl;
+    }
+
+
+    // Hashes every word many times with a given hash function, reporting
+    // how many bytes per second it gets through.
+    template <typename HashType>
+    void hashThroughput(const std::string& name, const std::vector<std::string>& words, HashType hash)
+    {
+        constexpr unsigned int ROUNDS = 20;
+
+        unsigned long long bytes = 0;
+        for (const std::string& word : words)
+            bytes += word.size();
+
+        unsigned int combined = 0;
+        Stopwatch timer;
+        for (unsigned int round = 0; round < ROUNDS; ++round)
+        {
+            for (const std::string& word : words)
+                combined ^= hash(word);
+        }
+        double seconds = timer.elapsedSeconds();
+
+        std::cout << "  " << std::left << std::setw(24) << name << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(6)
+                  << bytes * ROUNDS / seconds / 1e6 << " MB/s, "
+                  << std::setprecision(1) << seconds * 1e9 / (words.size() * ROUNDS)
+                  << " ns/word (" << (combined & 1) << ")" << std::endl;
+    }
+
+
+    // Adds words that all hash to the same value, as an attacker who knows
+    // the hash function could arrange, then looks each of them up, with
+    // long lists either left alone or turned into trees.
+    void collidingKeys(const std::vector<std::string>& words)
+    {
+        struct CollidingHash
+        {
+            unsigned int operator()(const std::string&) const { return 46; }
+        };
+
+        for (unsigned int count : {100u, 1000u, 10000u})
+        {
+            for (unsigned int threshold : {0u, HashSet<std::string>::DEFAULT_TREEIFY_THRESHOLD})
+            {
+                HashSet<std::string, CollidingHash> s{CollidingHash{}};
+                s.setTreeifyThreshold(threshold);
+
+                Stopwatch build;
+                for (unsigned int i = 0; i < count; ++i)
+                    s.add(words[i]);
+                double buildNs = build.elapsedNanoseconds() / static_cast<double>(count);
+
+                unsigned int found = 0;
+                Stopwatch lookup;
+                for (unsigned int i = 0; i < count; ++i)
+                    found += s.contains(words[i]) ? 1 : 0;
+                double lookupNs = lookup.elapsedNanoseconds() / static_cast<double>(count);
+
+                std::cout << "  " << std::setw(5) << count << " colliding words, "
+                          << (threshold == 0 ? "lists:" : "trees:") << std::fixed << std::setprecision(1)
+                          << std::setw(10) << buildNs << " ns/add, "
+                          << std::setw(10) << lookupNs << " ns/lookup (" << found << " found)" << std::endl;
+            }
+        }
+    }
+
+
+    // Fills a HashSet with the given maximum load factor, then reports the
+    // average length of its non-empty lists and the time per lookup.
+    template <typename Hash, typename Sizing>
+    void chainsAndLookups(
+        const std::string& name, double maxLoadFactor,
+        const std::vector<std::string>& present, const std::vector<std::string>& absent)
+    {
+        HashSet<std::string, Hash, Sizing> s{Hash{}};
+        s.setMaxLoadFactor(maxLoadFactor);
+        double ns = lookupTime(s, present, absent);
+
+        unsigned int nonEmpty = 0;
+        for (unsigned int i = 0; i < s.capacity(); ++i)
+            nonEmpty += s.elementsAtIndex(i) > 0 ? 1 : 0;
+
+        std::cout << "  " << std::left << std::setw(22) << name << std::right
+                  << std::fixed << std::setprecision(2)
+                  << " max " << maxLoadFactor << ", load " << s.loadFactor()
+                  << ", average chain " << static_cast<double>(s.size()) / nonEmpty
+                  << ", " << std::setprecision(1) << ns << " ns/lookup" << std::endl;
+    }
+
+
+    void loadFactorsAndSizing(const std::vector<std::string>& words)
+    {
+        unsigned int half = words.size() / 2;
+        std::vector<std::string> present(words.begin(), words.begin() + half);
+        std::vector<std::string> absent(words.begin() + half, words.begin() + 2 * half);
+
+        for (double maxLoadFactor : {0.5, 0.8, 1.0, 2.0, 4.0})
+        {
+            chainsAndLookups<FastHash<std::string>, ModuloSizing>(
+                "FastHash, modulo", maxLoadFactor, present, absent);
+            chainsAndLookups<FastHash<std::string>, PowerOfTwoSizing>(
+                "FastHash, power of two", maxLoadFactor, present, absent);
+            chainsAndLookups<FastHash<std::string>, FastRangeSizing>(
+                "FastHash, fastrange", maxLoadFactor, present, absent);
+            chainsAndLookups<StringHash, ModuloSizing>(
+                "*31 hash, modulo", maxLoadFactor, present, absent);
+            chainsAndLookups<StringHash, PowerOfTwoSizing>(
+                "*31 hash, power of two", maxLoadFactor, present, absent);
+            chainsAndLookups<StringHash, PrimeSizing>(
+                "*31 hash, prime", maxLoadFactor, present, absent);
+        }
+    }
+
+
+    // Times building a HashSet from every word in a few different ways,
+    // which is what loading a dictionary at startup costs.
+    void bulkLoading(const std::vector<std::string>& words)
+    {
+        auto report = [](const std::string& name, double seconds, unsigned int size)
+        {
+            std::cout << "  " << std::left << std::setw(32) << name << std::right
+                      << std::fixed << std::setprecision(3) << seconds << " s ("
+                      << size << " words)" << std::endl;
+        };
+
+        {
+            Stopwatch build;
+            HashSet<std::string, StringHash> s{StringHash{}};
+            for (const std::string& word : words)
+                s.add(word);
+            report("add() one at a time", build.elapsedSeconds(), s.size());
+        }
+
+        {
+            Stopwatch build;
+            HashSet<std::string, StringHash> s{StringHash{}};
+            s.reserve(words.size());
+            for (const std::string& word : words)
+                s.add(word);
+            report("reserve(), then add()", build.elapsedSeconds(), s.size());
+        }
+
+        {
+            Stopwatch build;
+            HashSet<std::string, StringHash> s{words.begin(), words.end(), StringHash{}};
+            report("range constructor", build.elapsedSeconds(), s.size());
+        }
+
+        {
+            Stopwatch build;
+            HashSet<std::string, StringHash> s{words.begin(), words.end(), StringHash{}, true};
+            report("range, unique", build.elapsedSeconds(), s.size());
+        }
+
+        {
+            Stopwatch build;
+            HashSet<std::string, StringHash> s{words.begin(), words.end(), StringHash{}, true, 4};
+            report("range, unique, 4 hash threads", build.elapsedSeconds(), s.size());
+        }
+    }
+
+
+    // Looks up a shuffled mix of present and absent words with
+    // containsMany(), batchSize keys at a time, and with contains() one
+    // at a time, reporting millions of lookups per second for each.
+    void batchLookups(const std::vector<std::string>& words)
+    {
+        unsigned int half = words.size() / 2;
+        HashSet<std::string, StringHash> s{StringHash{}};
+        for (unsigned int i = 0; i < half; ++i)
+            s.add(words[i]);
+
+        std::vector<std::string> keys(words.begin(), words.begin() + 2 * half);
+        std::mt19937 engine{46};
+        std::shuffle(keys.begin(), keys.end(), engine);
+
+        std::unique_ptr<bool[]> results{new bool[keys.size()]};
+
+        Stopwatch single;
+        unsigned int singleFound = 0;
+        for (const std::string& key : keys)
+            singleFound += s.contains(key) ? 1 : 0;
+        double singleRate = keys.size() / single.elapsedSeconds() / 1e6;
+
+        std::cout << "  contains():          " << std::fixed << std::setprecision(1)
+                  << std::setw(6) << singleRate << " M lookups/s" << std::endl;
+
+        for (unsigned int batchSize : {1u, 2u, 4u, 8u, 16u, 32u, 64u, 128u, 256u})
+        {
+            Stopwatch batched;
+            for (unsigned int first = 0; first < keys.size(); first += batchSize)
+            {
+                unsigned int count = keys.size() - first < batchSize ? keys.size() - first : batchSize;
+                s.containsMany(keys.data() + first, count, results.get() + first);
+            }
+            double rate = keys.size() / batched.elapsedSeconds() / 1e6;
+
+            unsigned int found = 0;
+            for (unsigned int i = 0; i < keys.size(); ++i)
+                found += results[i] ? 1 : 0;
+
+            std::cout << "  containsMany(" << std::setw(3) << batchSize << "):  "
+                      << std::setw(6) << rate << " M lookups/s";
+            if (found != singleFound)
+                std::cout << " (unexpected lookup results)";
+            std::cout << std::endl;
+        }
+    }
+}
+
+
+void runHashSetBenchmarks()
+{
+    std::vector<std::string> words = makeWords(200000);
+
+    std::cout << "HashSet insert latency (" << words.size() << " words)" << std::endl;
+    for (unsigned int budget : {0u, 1u, 4u, 16u})
+        insertLatency(words, budget);
+
+    std::cout << "HashSet growth and long chains" << std::endl;
+    growthAndLongChains(words);
+
+    std::cout << "Colliding keys" << std::endl;
+    collidingKeys(words);
+
+    std::cout << "Lookup time by hash policy" << std::endl;
+    hashPolicies(words);
+
+    std::cout << "String hash throughput (" << words.size() << " words)" << std::endl;
+    hashThroughput("byte-at-a-time * 31", words, StringHash{});
+    hashThroughput("FastHash", words, FastHash<std::string>{});
+
+    HashSet<std::string, FastHash<std::string>> fastHashed{FastHash<std::string>{}};
+    std::vector<std::string> absent(words.begin() + words.size() / 2, words.end());
+    std::vector<std::string> present(words.begin(), words.begin() + absent.size());
+    std::cout << "  HashSet<std::string, FastHash> lookup: " << std::setprecision(1)
+              << lookupTime(fastHashed, present, absent) << " ns" << std::endl;
+
+    std::cout << "Chain length and lookup time by load factor and sizing" << std::endl;
+    loadFactorsAndSizing(words);
+
+    std::cout << "Batched lookups by batch size" << std::endl;
+    batchLookups(words);
+
+    std::vector<std::string> dictionary = makeWords(1000000);
+
+    std::cout << "Bulk loading (" << dictionary.size() << " words)" << std::endl;
+    bulkLoading(dictionary);
+}
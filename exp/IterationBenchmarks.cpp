@@ -0,0 +1,158 @@
+// IterationBenchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Benchmarks for visiting every element of a set, which is what exporting
+// or re-indexing a dictionary costs, and for the different ways of
+// visiting the elements of an AVLSet in order.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Benchmarks.hpp"
+#include "FastHash.hpp"
+#include "HashSet.hpp"
+
+
+namespace
+{
+    constexpr unsigned int ROUNDS = 10;
+
+
+    // Times ROUNDS full scans, each of which calls "scan" with a function
+    // that adds the length of each element to a total, and reports millions
+    // of elements per second.
+    template <typename Scan>
+    void scanRate(const std::string& name, unsigned int size, Scan scan)
+    {
+        unsigned long long total = 0;
+        auto visit = [&](const std::string& word) { total += word.size(); };
+
+        Stopwatch timer;
+        for (unsigned int round = 0; round < ROUNDS; ++round)
+            scan(visit);
+        double seconds = timer.elapsedSeconds();
+
+        std::cout << "  " << std::left << std::setw(28) << name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(7)
+                  << size * static_cast<double>(ROUNDS) / seconds / 1e6
+                  << " M elements/s (" << total / ROUNDS << " characters)" << std::endl;
+    }
+
+
+    void fullScans(const std::vector<std::string>& words)
+    {
+        HashSet<std::string, FastHash<std::string>> hashSet{FastHash<std::string>{}};
+        AVLSet<std::string> avlSet;
+        for (const std::string& word : words)
+        {
+            hashSet.add(word);
+            avlSet.add(word);
+        }
+
+        scanRate("HashSet iterators", hashSet.size(),
+            [&](auto& visit) { for (const std::string& word : hashSet) visit(word); });
+        scanRate("HashSet::forEach()", hashSet.size(),
+            [&](auto& visit) { hashSet.forEach(visit); });
+        scanRate("AVLSet iterators", avlSet.size(),
+            [&](auto& visit) { for (const std::string& word : avlSet) visit(word); });
+        scanRate("AVLSet::inorder()", avlSet.size(),
+            [&](auto& visit) { avlSet.inorder(visit); });
+    }
+
+
+    // Times ROUNDS in-order scans of an AVLSet of integers, which are cheap
+    // enough to visit that the cost of the traversal itself dominates,
+    // reporting nanoseconds per element.
+    template <typename Scan>
+    void orderedScanTime(const std::string& name, const AVLSet<int>& s, Scan scan)
+    {
+        long long total = 0;
+
+        Stopwatch timer;
+        for (unsigned int round = 0; round < ROUNDS; ++round)
+            total += scan();
+        double ns = timer.elapsedNanoseconds() / (static_cast<double>(ROUNDS) * s.size());
+
+        std::cout << "  " << std::left << std::setw(40) << name << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(6) << ns
+                  << " ns/element (" << total / ROUNDS << ")" << std::endl;
+    }
+
+
+    void orderedScans(unsigned int count)
+    {
+        std::vector<int> keys(count);
+        for (unsigned int i = 0; i < count; ++i)
+            keys[i] = static_cast<int>(i);
+
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{46});
+
+        AVLSet<int> s;
+        for (int key : keys)
+            s.add(key);
+
+        orderedScanTime("inorder() with a VisitFunction", s,
+            [&]
+            {
+                long long sum = 0;
+                AVLSet<int>::VisitFunction visit = [&](const int& i) { sum += i; };
+                s.inorder(visit);
+                return sum;
+            });
+
+        orderedScanTime("inorder() with a lambda", s,
+            [&]
+            {
+                long long sum = 0;
+                s.inorder([&](const int& i) { sum += i; });
+                return sum;
+            });
+
+        orderedScanTime("range-based for", s,
+            [&]
+            {
+                long long sum = 0;
+                for (int i : s)
+                    sum += i;
+                return sum;
+            });
+
+        orderedScanTime("std::accumulate over rbegin(), rend()", s,
+            [&] { return std::accumulate(s.rbegin(), s.rend(), 0LL); });
+
+        orderedScanTime("preorder() with a lambda", s,
+            [&]
+            {
+                long long sum = 0;
+                s.preorder([&](const int& i) { sum += i; });
+                return sum;
+            });
+
+        orderedScanTime("postorder() with a lambda", s,
+            [&]
+            {
+                long long sum = 0;
+                s.postorder([&](const int& i) { sum += i; });
+                return sum;
+            });
+    }
+}
+
+
+void runIterationBenchmarks()
+{
+    std::vector<std::string> words = makeWords(1000000);
+
+    std::cout << "Full scans (" << words.size() << " words)" << std::endl;
+    fullScans(words);
+
+    std::cout << "AVLSet<int> ordered scans (1000000 keys)" << std::endl;
+    orderedScans(1000000);
+}
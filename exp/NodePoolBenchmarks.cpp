@@ -0,0 +1,64 @@
+// NodePoolBenchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Benchmarks for building and destroying the node-based sets, whose nodes
+// are allocated from a NodePool.
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Benchmarks.hpp"
+#include "HashSet.hpp"
+
+
+namespace
+{
+    struct StringHash
+    {
+        unsigned int operator()(const std::string& s) const
+        {
+            unsigned int hash = 0;
+            for (char c : s)
+                hash = hash * 31 + static_cast<unsigned char>(c);
+            return hash;
+        }
+    };
+
+
+    // Builds a set from every word, then destroys it, reporting how long
+    // each step took and how many heap allocations the build made.
+    template <typename SetType>
+    void buildAndDestroy(const std::string& name, const std::vector<std::string>& words, SetType* s)
+    {
+        unsigned long long allocationsBefore = heapAllocations();
+        Stopwatch build;
+
+        for (const std::string& word : words)
+            s->add(word);
+
+        double buildSeconds = build.elapsedSeconds();
+        unsigned long long allocations = heapAllocations() - allocationsBefore;
+
+        Stopwatch destroy;
+        delete s;
+        double destroySeconds = destroy.elapsedSeconds();
+
+        std::cout << "  " << std::left << std::setw(10) << name << std::right
+                  << " build " << std::fixed << std::setprecision(3) << buildSeconds << " s, "
+                  << allocations << " allocations, destroy " << destroySeconds << " s" << std::endl;
+    }
+}
+
+
+void runNodePoolBenchmarks()
+{
+    std::vector<std::string> words = makeWords(500000);
+
+    std::cout << "Node allocation (" << words.size() << " words)" << std::endl;
+    buildAndDestroy("HashSet", words, new HashSet<std::string, StringHash>{StringHash{}});
+    buildAndDestroy("AVLSet", words, new AVLSet<std::string>);
+}
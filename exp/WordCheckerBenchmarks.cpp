@@ -0,0 +1,123 @@
+// WordCheckerBenchmarks.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Benchmarks for finding suggestions with the WordChecker, with and
+// without a BloomFilter in front of the Set of words.
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Benchmarks.hpp"
+#include "BloomFilter.hpp"
+#include "FrozenHashSet.hpp"
+#include "HashSet.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    // Returns misspellings of some of the given words, each made by
+    // replacing one letter with a random one.
+    std::vector<std::string> misspell(const std::vector<std::string>& words, unsigned int count)
+    {
+        std::mt19937 engine{46};
+        std::uniform_int_distribution<unsigned int> pick{0, static_cast<unsigned int>(words.size() - 1)};
+        std::uniform_int_distribution<int> letter{'A', 'Z'};
+
+        std::vector<std::string> misspellings;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            std::string word = words[pick(engine)];
+            std::uniform_int_distribution<unsigned int> position{0, static_cast<unsigned int>(word.size() - 1)};
+            word[position(engine)] = static_cast<char>(letter(engine));
+            misspellings.push_back(word);
+        }
+
+        return misspellings;
+    }
+
+
+    void suggestionRate(const std::string& name, const WordChecker& checker, const std::vector<std::string>& misspellings)
+    {
+        unsigned long long suggestions = 0;
+        Stopwatch timer;
+        for (const std::string& word : misspellings)
+            suggestions += checker.findSuggestions(word).size();
+        double seconds = timer.elapsedSeconds();
+
+        std::cout << "  " << std::left << std::setw(28) << name << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(8) << misspellings.size() / seconds
+                  << " words/s (" << suggestions << " suggestions)" << std::endl;
+    }
+
+
+    // Reports how often the filter lets through a candidate that isn't a
+    // word, using the candidates that findSuggestions() would look up.
+    template <typename SetType>
+    void falsePositiveRate(
+        const BloomFilter& filter, const SetType& words, const std::vector<std::string>& misspellings)
+    {
+        unsigned long long negatives = 0;
+        unsigned long long falsePositives = 0;
+
+        for (const std::string& word : misspellings)
+        {
+            for (std::size_t i = 0; i < word.size(); ++i)
+            {
+                std::string candidate = word;
+                for (char letter = 'A'; letter <= 'Z'; ++letter)
+                {
+                    candidate[i] = letter;
+                    if (!words.contains(candidate))
+                    {
+                        ++negatives;
+                        falsePositives += filter.mightContain(candidate) ? 1 : 0;
+                    }
+                }
+            }
+        }
+
+        std::cout << "  false positive rate " << std::setprecision(3)
+                  << 100.0 * falsePositives / negatives << "% of " << negatives
+                  << " candidates that aren't words" << std::endl;
+    }
+}
+
+
+void runWordCheckerBenchmarks()
+{
+    std::vector<std::string> words = makeWords(200000);
+    std::vector<std::string> misspellings = misspell(words, 5000);
+
+    AVLSet<std::string> tree;
+    for (const std::string& word : words)
+        tree.add(word);
+
+    HashSet<std::string> table{words.begin(), words.end(), FastHash<std::string>{}, true};
+    FrozenHashSet frozen{words.begin(), words.end()};
+
+    std::cout << "WordChecker suggestions (" << words.size() << " words, "
+              << misspellings.size() << " misspellings)" << std::endl;
+
+    for (unsigned int bitsPerElement : {8u, 12u, 16u})
+    {
+        BloomFilter filter{words.begin(), words.end(), bitsPerElement};
+        std::cout << "  BloomFilter with " << bitsPerElement << " bits/word: "
+                  << filter.memoryUsage() << " bytes" << std::endl;
+        falsePositiveRate(filter, frozen, misspellings);
+    }
+
+    BloomFilter filter{words.begin(), words.end()};
+
+    suggestionRate("AVLSet", WordChecker{tree}, misspellings);
+    suggestionRate("AVLSet + BloomFilter", WordChecker{tree, filter}, misspellings);
+    suggestionRate("HashSet", WordChecker{table}, misspellings);
+    suggestionRate("HashSet + BloomFilter", WordChecker{table, filter}, misspellings);
+    suggestionRate("FrozenHashSet", WordChecker{frozen}, misspellings);
+    suggestionRate("FrozenHashSet + BloomFilter", WordChecker{frozen, filter}, misspellings);
+}
@@ -6,12 +6,22 @@
 // Do whatever you'd like here.  This is intended to allow you to experiment
 // with your code, outside of the context of the broader program or Google
 // Test.
+//
+// At the moment, it runs the benchmarks declared in Benchmarks.hpp.
+
+#include "Benchmarks.hpp"
 
 
 int main()
 {
-
+    runHashSetBenchmarks();
+    runNodePoolBenchmarks();
+    runConcurrencyBenchmarks();
+    runFrozenHashSetBenchmarks();
+    runWordCheckerBenchmarks();
+    runChurnBenchmarks();
+    runIterationBenchmarks();
+    runAVLSetBenchmarks();
 
     return 0;
 }
-
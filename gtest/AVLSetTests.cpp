@@ -0,0 +1,854 @@
+// AVLSetTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the AVLSet beyond the sanity checks, covering larger
+// trees, copying, moving, comparison policies, and bulk construction.
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include "AVLSet.hpp"
+
+
+namespace
+{
+    std::vector<int> shuffledRange(int count, unsigned int seed)
+    {
+        std::vector<int> values(count);
+        for (int i = 0; i < count; ++i)
+            values[i] = i;
+
+        std::shuffle(values.begin(), values.end(), std::mt19937{seed});
+        return values;
+    }
+
+
+    // Runs a function on a thread whose stack is far smaller than the usual
+    // one, so that anything that recurses once per level of a deep tree
+    // overflows it rather than passing by luck.
+    void runWithSmallStack(std::function<void()> function)
+    {
+        pthread_attr_t attributes;
+        pthread_attr_init(&attributes);
+        pthread_attr_setstacksize(&attributes, 256 * 1024);
+
+        pthread_t thread;
+        auto run = [](void* f) -> void*
+        {
+            (*static_cast<std::function<void()>*>(f))();
+            return nullptr;
+        };
+
+        ASSERT_EQ(0, pthread_create(&thread, &attributes, run, &function));
+        pthread_join(thread, nullptr);
+        pthread_attr_destroy(&attributes);
+    }
+
+
+    struct DescendingComparison
+    {
+        static int compare(int a, int b)
+        {
+            return (b > a) - (b < a);
+        }
+    };
+
+
+    struct CaseInsensitiveComparison
+    {
+        static int compare(const std::string& a, const std::string& b)
+        {
+            for (unsigned int i = 0; i < a.size() && i < b.size(); ++i)
+            {
+                int x = std::tolower(static_cast<unsigned char>(a[i]));
+                int y = std::tolower(static_cast<unsigned char>(b[i]));
+                if (x != y)
+                    return x - y;
+            }
+
+            return (a.size() > b.size()) - (a.size() < b.size());
+        }
+    };
+
+
+    // CountingComparison counts how many times it's asked to compare.
+    struct CountingComparison
+    {
+        static unsigned int comparisons;
+
+        static int compare(int a, int b)
+        {
+            ++comparisons;
+            return (a > b) - (a < b);
+        }
+    };
+
+    unsigned int CountingComparison::comparisons = 0;
+
+
+    // CountingAllocator counts how many times it allocates, so that a
+    // std::basic_string using it shows whether a lookup builds a string.
+    unsigned long long allocations = 0;
+
+    template <typename T>
+    struct CountingAllocator
+    {
+        using value_type = T;
+
+        CountingAllocator() = default;
+
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>&) noexcept
+        {
+        }
+
+        T* allocate(std::size_t n)
+        {
+            ++allocations;
+            return std::allocator<T>{}.allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept
+        {
+            std::allocator<T>{}.deallocate(p, n);
+        }
+
+        template <typename U>
+        bool operator==(const CountingAllocator<U>&) const noexcept
+        {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const CountingAllocator<U>&) const noexcept
+        {
+            return false;
+        }
+    };
+
+    using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+}
+
+
+TEST(AVLSetTests, staysBalancedWithManyElements)
+{
+    AVLSet<int> s;
+    for (int i : shuffledRange(10000, 46))
+        s.add(i);
+
+    EXPECT_EQ(10000, s.size());
+
+    // An AVL tree with n nodes is never taller than about 1.44 log2(n).
+    EXPECT_LE(s.height(), 19);
+
+    for (int i = 0; i < 10000; ++i)
+        EXPECT_TRUE(s.contains(i));
+
+    EXPECT_FALSE(s.contains(-1));
+    EXPECT_FALSE(s.contains(10000));
+}
+
+
+TEST(AVLSetTests, staysBalancedWhenElementsAreAddedInOrder)
+{
+    AVLSet<int> ascending;
+    AVLSet<int> descending;
+    for (int i = 0; i < 1023; ++i)
+    {
+        ascending.add(i);
+        descending.add(1022 - i);
+    }
+
+    EXPECT_EQ(9, ascending.height());
+    EXPECT_EQ(9, descending.height());
+}
+
+
+TEST(AVLSetTests, addingDuplicatesHasNoEffect)
+{
+    AVLSet<std::string> s;
+    s.add("Boo");
+    s.add("is");
+    s.add("Boo");
+
+    EXPECT_EQ(2, s.size());
+}
+
+
+TEST(AVLSetTests, copiesHaveTheSameShapeAndAreIndependent)
+{
+    AVLSet<std::string> s1;
+    for (int i : shuffledRange(100, 1))
+        s1.add(std::to_string(i));
+
+    AVLSet<std::string> s2{s1};
+    EXPECT_EQ(s1.size(), s2.size());
+    EXPECT_EQ(s1.height(), s2.height());
+
+    std::vector<std::string> pre1;
+    std::vector<std::string> pre2;
+    s1.preorder([&](const std::string& e) { pre1.push_back(e); });
+    s2.preorder([&](const std::string& e) { pre2.push_back(e); });
+    EXPECT_EQ(pre1, pre2);
+
+    // The copy's parent pointers and balance factors must be right for it
+    // to keep balancing itself.
+    for (int i = 100; i < 1000; ++i)
+        s2.add(std::to_string(i));
+
+    EXPECT_EQ(100, s1.size());
+    EXPECT_EQ(1000, s2.size());
+    EXPECT_FALSE(s1.contains("500"));
+    EXPECT_TRUE(s2.contains("500"));
+    EXPECT_LE(s2.height(), 14);
+}
+
+
+TEST(AVLSetTests, deepUnbalancedTreesCanBeCopiedWithoutRecursing)
+{
+    AVLSet<int> s{false};
+    for (int i = 0; i < 10000; ++i)
+        s.add(i);
+
+    int height = 0;
+    int copiedHeight = 0;
+    int assignedHeight = 0;
+    std::vector<int> preorder;
+
+    runWithSmallStack([&]
+    {
+        height = s.height();
+
+        AVLSet<int> copied{s};
+        copiedHeight = copied.height();
+        copied.preorder([&](int e) { preorder.push_back(e); });
+
+        AVLSet<int> assigned;
+        assigned.add(-1);
+        assigned = copied;
+        assignedHeight = assigned.height();
+    });
+
+    EXPECT_EQ(9999, height);
+    EXPECT_EQ(9999, copiedHeight);
+    EXPECT_EQ(9999, assignedHeight);
+
+    std::vector<int> expected(10000);
+    for (int i = 0; i < 10000; ++i)
+        expected[i] = i;
+
+    EXPECT_EQ(expected, preorder);
+}
+
+
+TEST(AVLSetTests, movingTransfersElements)
+{
+    AVLSet<int> s1;
+    s1.add(1);
+    s1.add(2);
+
+    AVLSet<int> s2{std::move(s1)};
+    EXPECT_EQ(2, s2.size());
+    EXPECT_TRUE(s2.contains(1));
+
+    AVLSet<int> s3;
+    s3.add(3);
+    s3 = std::move(s2);
+    EXPECT_EQ(2, s3.size());
+    EXPECT_TRUE(s3.contains(2));
+    EXPECT_FALSE(s3.contains(3));
+}
+
+
+TEST(AVLSetTests, canLookUpStringViews)
+{
+    AVLSet<std::string> s;
+    s.add("Boo");
+    s.add("is");
+    s.add("happy");
+
+    std::string buffer = "Boo is happy today";
+    EXPECT_TRUE(s.contains(std::string_view{buffer}.substr(0, 3)));
+    EXPECT_TRUE(s.contains(std::string_view{buffer}.substr(4, 2)));
+    EXPECT_TRUE(s.contains(std::string_view{buffer}.substr(7, 5)));
+    EXPECT_FALSE(s.contains(std::string_view{buffer}.substr(13, 5)));
+    EXPECT_FALSE(s.contains(std::string_view{buffer}.substr(0, 2)));
+}
+
+
+TEST(AVLSetTests, removedElementsAreNoLongerContained)
+{
+    AVLSet<std::string> s;
+    s.add("Boo");
+    s.add("is");
+    s.add("happy");
+
+    s.remove("is");
+    EXPECT_EQ(2, s.size());
+    EXPECT_FALSE(s.contains("is"));
+    EXPECT_TRUE(s.contains("Boo"));
+    EXPECT_TRUE(s.contains("happy"));
+
+    s.remove("today");
+    EXPECT_EQ(2, s.size());
+
+    s.remove("Boo");
+    s.remove("happy");
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(-1, s.height());
+
+    s.add("again");
+    EXPECT_TRUE(s.contains("again"));
+}
+
+
+TEST(AVLSetTests, staysBalancedWhileElementsAreRemoved)
+{
+    AVLSet<int> s;
+    for (int i : shuffledRange(10000, 46))
+        s.add(i);
+
+    // Removing every element but the multiples of 10 leaves 1000 elements,
+    // which an AVL tree holds in a height of at most about 1.44 log2(1000).
+    for (int i : shuffledRange(10000, 47))
+    {
+        if (i % 10 != 0)
+            s.remove(i);
+    }
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_LE(s.height(), 14);
+
+    std::vector<int> inorder;
+    s.inorder([&](const int& i) { inorder.push_back(i); });
+    ASSERT_EQ(1000, inorder.size());
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(i * 10, inorder[i]);
+
+    // The balance factors must still be right for adding to keep the tree
+    // balanced.
+    for (int i = 0; i < 10000; ++i)
+        s.add(i);
+
+    EXPECT_EQ(10000, s.size());
+    EXPECT_LE(s.height(), 19);
+}
+
+
+TEST(AVLSetTests, removingFromAnUnbalancedTreeKeepsItsShape)
+{
+    AVLSet<int> s{false};
+    for (int i = 0; i < 10; ++i)
+        s.add(i);
+
+    s.remove(0);
+    s.remove(5);
+    s.remove(9);
+
+    EXPECT_EQ(7, s.size());
+    EXPECT_EQ(6, s.height());
+    EXPECT_FALSE(s.contains(5));
+    EXPECT_TRUE(s.contains(6));
+}
+
+
+TEST(AVLSetTests, iteratorsVisitElementsInAscendingOrder)
+{
+    AVLSet<int> empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+
+    for (bool shouldBalance : {true, false})
+    {
+        AVLSet<int> s{shouldBalance};
+        for (int i : shuffledRange(1000, 46))
+            s.add(i);
+
+        int expected = 0;
+        for (int i : s)
+        {
+            EXPECT_EQ(expected, i);
+            ++expected;
+        }
+
+        EXPECT_EQ(1000, expected);
+        EXPECT_EQ(1000, std::distance(s.begin(), s.end()));
+        EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+    }
+}
+
+
+TEST(AVLSetTests, iteratorsCanVisitElementsInDescendingOrder)
+{
+    AVLSet<int> s;
+    for (int i : shuffledRange(1000, 46))
+        s.add(i);
+
+    int expected = 999;
+    for (auto i = s.rbegin(); i != s.rend(); ++i)
+    {
+        EXPECT_EQ(expected, *i);
+        --expected;
+    }
+
+    EXPECT_EQ(-1, expected);
+
+    auto last = s.end();
+    --last;
+    EXPECT_EQ(999, *last);
+    last--;
+    EXPECT_EQ(998, *last);
+    ++last;
+    EXPECT_EQ(999, *last);
+
+    auto first = s.begin();
+    ++first;
+    --first;
+    EXPECT_TRUE(first == s.begin());
+}
+
+
+TEST(AVLSetTests, traversalsOfAnUnbalancedTreeFollowItsShape)
+{
+    AVLSet<int> s{false};
+    for (int i : {5, 3, 8, 1, 4, 7, 9, 2, 6})
+        s.add(i);
+
+    std::vector<int> pre;
+    std::vector<int> in;
+    std::vector<int> post;
+    s.preorder([&](const int& i) { pre.push_back(i); });
+    s.inorder([&](const int& i) { in.push_back(i); });
+    s.postorder([&](const int& i) { post.push_back(i); });
+
+    EXPECT_EQ((std::vector<int>{5, 3, 1, 2, 4, 8, 7, 6, 9}), pre);
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9}), in);
+    EXPECT_EQ((std::vector<int>{2, 1, 4, 3, 6, 7, 9, 8, 5}), post);
+
+    // A VisitFunction can still be passed, too.
+    int sum = 0;
+    AVLSet<int>::VisitFunction add = [&](const int& i) { sum += i; };
+    s.postorder(add);
+    EXPECT_EQ(45, sum);
+
+    AVLSet<int> empty;
+    empty.preorder([](const int&) { FAIL(); });
+    empty.inorder([](const int&) { FAIL(); });
+    empty.postorder([](const int&) { FAIL(); });
+}
+
+
+TEST(AVLSetTests, traversalsOfBalancedAndUnbalancedTreesAgree)
+{
+    AVLSet<int> balanced;
+    AVLSet<int> unbalanced{false};
+    for (int i : {4, 2, 6, 1, 3, 5, 7})
+    {
+        balanced.add(i);
+        unbalanced.add(i);
+    }
+
+    // Both trees have the same perfect shape, but they're traversed in
+    // different ways.
+    std::vector<int> balancedOrder;
+    std::vector<int> unbalancedOrder;
+
+    balanced.preorder([&](const int& i) { balancedOrder.push_back(i); });
+    unbalanced.preorder([&](const int& i) { unbalancedOrder.push_back(i); });
+    EXPECT_EQ((std::vector<int>{4, 2, 1, 3, 6, 5, 7}), balancedOrder);
+    EXPECT_EQ(balancedOrder, unbalancedOrder);
+
+    balancedOrder.clear();
+    unbalancedOrder.clear();
+    balanced.postorder([&](const int& i) { balancedOrder.push_back(i); });
+    unbalanced.postorder([&](const int& i) { unbalancedOrder.push_back(i); });
+    EXPECT_EQ((std::vector<int>{1, 3, 2, 5, 7, 6, 4}), balancedOrder);
+    EXPECT_EQ(balancedOrder, unbalancedOrder);
+
+    AVLSet<int> large;
+    for (int i : shuffledRange(10000, 46))
+        large.add(i);
+
+    int expected = 0;
+    large.inorder([&](const int& i) { EXPECT_EQ(expected++, i); });
+    EXPECT_EQ(10000, expected);
+
+    unsigned int count = 0;
+    large.preorder([&](const int&) { ++count; });
+    large.postorder([&](const int&) { ++count; });
+    EXPECT_EQ(20000, count);
+}
+
+
+TEST(AVLSetTests, elementsAreOrderedByTheComparisonPolicy)
+{
+    AVLSet<int, DescendingComparison> s;
+    for (int i : shuffledRange(100, 46))
+        s.add(i);
+
+    EXPECT_EQ(100, s.size());
+    EXPECT_TRUE(s.contains(0));
+    EXPECT_TRUE(s.contains(99));
+    EXPECT_FALSE(s.contains(100));
+
+    int expected = 99;
+    s.inorder([&](const int& i) { EXPECT_EQ(expected--, i); });
+    EXPECT_EQ(-1, expected);
+
+    s.remove(50);
+    EXPECT_FALSE(s.contains(50));
+    EXPECT_EQ(99, s.size());
+}
+
+
+TEST(AVLSetTests, elementsThatThePolicyConsidersEquivalentAreDuplicates)
+{
+    AVLSet<std::string, CaseInsensitiveComparison> s;
+    s.add("Boo");
+    s.add("BOO");
+    s.add("is");
+    s.add("happy");
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_TRUE(s.contains("boo"));
+    EXPECT_TRUE(s.contains("HAPPY"));
+    EXPECT_FALSE(s.contains("happier"));
+
+    s.remove("IS");
+    EXPECT_FALSE(s.contains("is"));
+}
+
+
+TEST(AVLSetTests, lookupsCompareOncePerLevel)
+{
+    AVLSet<int, CountingComparison> s;
+    for (int i = 0; i < 1023; ++i)
+        s.add(i);
+
+    ASSERT_EQ(9, s.height());
+
+    // A perfect tree of height 9 has 10 levels, so no lookup, successful
+    // or not, ever needs more than 10 comparisons.
+    for (int i = -1; i <= 1023; ++i)
+    {
+        CountingComparison::comparisons = 0;
+        s.contains(i);
+        EXPECT_LE(CountingComparison::comparisons, 10u);
+    }
+}
+
+
+TEST(AVLSetTests, lookupsDoNotAllocate)
+{
+    // The words are long enough that copying one allocates.
+    std::vector<CountedString> words;
+    for (int i = 0; i < 200; ++i)
+        words.push_back(CountedString{"a word long enough to be on the heap "} + std::to_string(i).c_str());
+
+    AVLSet<CountedString> s;
+    for (int i = 0; i < 100; ++i)
+        s.add(words[i]);
+
+    unsigned long long before = allocations;
+    int found = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        found += s.contains(words[i]);
+        found += s.contains(std::string_view{words[i]});
+    }
+
+    EXPECT_EQ(before, allocations);
+    EXPECT_EQ(200, found);
+}
+
+
+TEST(AVLSetTests, canBeBuiltFromSortedElements)
+{
+    std::vector<int> sorted(1000);
+    for (int i = 0; i < 1000; ++i)
+        sorted[i] = i * 2;
+
+    AVLSet<int> s{sorted.begin(), sorted.end()};
+    EXPECT_EQ(1000, s.size());
+
+    // 1000 elements fit in a perfectly balanced tree of height 9.
+    EXPECT_EQ(9, s.height());
+    EXPECT_TRUE(std::equal(s.begin(), s.end(), sorted.begin(), sorted.end()));
+    EXPECT_TRUE(s.contains(998));
+    EXPECT_FALSE(s.contains(999));
+
+    // The balance factors and parent pointers have to be right for adding
+    // and removing to keep the tree balanced afterward.
+    for (int i = 0; i < 1000; ++i)
+        s.add(i * 2 + 1);
+
+    for (int i = 0; i < 1500; ++i)
+        s.remove(i);
+
+    EXPECT_EQ(500, s.size());
+    EXPECT_LE(s.height(), 12);
+
+    int expected = 1500;
+    for (int i : s)
+        EXPECT_EQ(expected++, i);
+
+    EXPECT_EQ(2000, expected);
+}
+
+
+TEST(AVLSetTests, unsortedElementsAreSortedBeforeBuilding)
+{
+    std::vector<int> values = shuffledRange(1000, 46);
+    values.insert(values.end(), values.begin(), values.begin() + 100);
+
+    AVLSet<int> s{values.begin(), values.end()};
+    EXPECT_EQ(1000, s.size());
+    EXPECT_EQ(9, s.height());
+
+    int expected = 0;
+    for (int i : s)
+        EXPECT_EQ(expected++, i);
+
+    // A range that can only be traversed once is always sorted first.
+    std::istringstream in{"is Boo happy Boo today"};
+    AVLSet<std::string> words{
+        std::istream_iterator<std::string>{in}, std::istream_iterator<std::string>{}};
+
+    EXPECT_EQ((std::vector<std::string>{"Boo", "happy", "is", "today"}),
+        (std::vector<std::string>{words.begin(), words.end()}));
+}
+
+
+TEST(AVLSetTests, assignSortedReplacesTheElements)
+{
+    AVLSet<std::string> s;
+    s.add("Boo");
+    s.add("zzz");
+
+    std::vector<std::string> words{"alpha", "bravo", "charlie", "delta", "echo"};
+    s.assignSorted(words.begin(), words.end());
+
+    EXPECT_EQ(5, s.size());
+    EXPECT_EQ(2, s.height());
+    EXPECT_FALSE(s.contains("Boo"));
+    EXPECT_TRUE(s.contains("charlie"));
+    EXPECT_TRUE(std::equal(s.begin(), s.end(), words.begin(), words.end()));
+
+    s.assignSorted(words.begin(), words.begin());
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(-1, s.height());
+    EXPECT_TRUE(s.begin() == s.end());
+}
+
+
+TEST(AVLSetTests, rankAndSelectAgreeWithAscendingOrder)
+{
+    for (bool shouldBalance : {true, false})
+    {
+        AVLSet<int> s{shouldBalance};
+        for (int i : shuffledRange(2000, 46))
+            s.add(i * 2);
+
+        // Removing elements rotates nodes in different ways than adding
+        // them does, and the sizes have to stay right through both.
+        for (int i : shuffledRange(1000, 47))
+            s.remove(i * 4);
+
+        std::vector<int> ascending{s.begin(), s.end()};
+        ASSERT_EQ(1000, ascending.size());
+
+        for (unsigned int i = 0; i < ascending.size(); ++i)
+        {
+            EXPECT_EQ(ascending[i], s.select(i));
+            EXPECT_EQ(i, s.rank(ascending[i]));
+
+            // A key that isn't in the set ranks after everything less.
+            EXPECT_EQ(i, s.rank(ascending[i] - 1));
+        }
+
+        EXPECT_EQ(0, s.rank(-1));
+        EXPECT_EQ(1000, s.rank(4000));
+    }
+}
+
+
+TEST(AVLSetTests, canCountElementsInARange)
+{
+    std::vector<int> sorted(1000);
+    for (int i = 0; i < 1000; ++i)
+        sorted[i] = i * 3;
+
+    AVLSet<int> s;
+    s.assignSorted(sorted.begin(), sorted.end());
+
+    EXPECT_EQ(1000, s.countInRange(0, 2997));
+    EXPECT_EQ(1000, s.countInRange(-100, 5000));
+    EXPECT_EQ(4, s.countInRange(3, 12));
+    EXPECT_EQ(3, s.countInRange(4, 12));
+    EXPECT_EQ(1, s.countInRange(6, 6));
+    EXPECT_EQ(0, s.countInRange(7, 8));
+    EXPECT_EQ(0, s.countInRange(12, 3));
+
+    EXPECT_EQ(500, s.select(500) / 3);
+
+    AVLSet<std::string> words;
+    for (const char* word : {"apple", "banana", "boo", "cherry", "date"})
+        words.add(word);
+
+    EXPECT_EQ(2, words.countInRange(std::string_view{"b"}, std::string_view{"c"}));
+    EXPECT_EQ(3, words.rank("c"));
+    EXPECT_EQ("cherry", words.select(3));
+}
+
+
+TEST(AVLSetTests, boundsFindWhereKeysBelong)
+{
+    AVLSet<int> s;
+    for (int i : shuffledRange(500, 46))
+        s.add(i * 2);
+
+    EXPECT_EQ(10, *s.lowerBound(10));
+    EXPECT_EQ(12, *s.upperBound(10));
+    EXPECT_EQ(12, *s.lowerBound(11));
+    EXPECT_EQ(12, *s.upperBound(11));
+    EXPECT_EQ(0, *s.lowerBound(-5));
+    EXPECT_TRUE(s.lowerBound(999) == s.end());
+    EXPECT_TRUE(s.upperBound(998) == s.end());
+
+    // Bounds are ordinary Iterators that can be walked in either direction.
+    auto i = s.lowerBound(501);
+    EXPECT_EQ(502, *i);
+    --i;
+    EXPECT_EQ(500, *i);
+
+    AVLSet<int> empty;
+    EXPECT_TRUE(empty.lowerBound(0) == empty.end());
+}
+
+
+TEST(AVLSetTests, rangesVisitOnlyTheElementsBetweenTheirBounds)
+{
+    AVLSet<std::string> s;
+    for (const char* word : {"INTER", "INTERN", "INTERNAL", "INTO", "IN", "BOO", "ZEBRA"})
+        s.add(word);
+
+    std::vector<std::string> visited;
+    s.forEachInRange(std::string_view{"INTER"}, std::string_view{"INTERZ"},
+        [&](const std::string& word) { visited.push_back(word); });
+
+    EXPECT_EQ((std::vector<std::string>{"INTER", "INTERN", "INTERNAL"}), visited);
+
+    auto [first, last] = s.range(std::string{"IN"}, std::string{"INTO"});
+    EXPECT_EQ((std::vector<std::string>{"IN", "INTER", "INTERN", "INTERNAL", "INTO"}),
+        (std::vector<std::string>{first, last}));
+
+    // A range with nothing in it, including one whose bounds are backward,
+    // is empty.
+    auto [emptyFirst, emptyLast] = s.range(std::string{"C"}, std::string{"D"});
+    EXPECT_TRUE(emptyFirst == emptyLast);
+
+    auto [backwardFirst, backwardLast] = s.range(std::string{"Z"}, std::string{"A"});
+    EXPECT_TRUE(backwardFirst == backwardLast);
+
+    s.forEachInRange(std::string{"Z"}, std::string{"A"}, [](const std::string&) { FAIL(); });
+}
+
+
+TEST(AVLSetTests, setOperationsMatchAddingAndRemovingOneAtATime)
+{
+    std::vector<int> first = shuffledRange(30000, 46);
+    std::vector<int> second = shuffledRange(30000, 47);
+    first.resize(20000);
+    second.resize(5000);
+
+    AVLSet<int> a{first.begin(), first.end()};
+    AVLSet<int> b{second.begin(), second.end()};
+
+    for (unsigned int threads : {1u, 4u})
+    {
+        AVLSet<int> united{a};
+        AVLSet<int> intersected{a};
+        AVLSet<int> subtracted{a};
+        united.unionWith(b, threads);
+        intersected.intersectWith(b, threads);
+        subtracted.differenceWith(b, threads);
+
+        AVLSet<int> expectedUnion{a};
+        AVLSet<int> expectedIntersection;
+        AVLSet<int> expectedDifference{a};
+        for (int i : b)
+        {
+            expectedUnion.add(i);
+            expectedDifference.remove(i);
+
+            if (a.contains(i))
+                expectedIntersection.add(i);
+        }
+
+        EXPECT_TRUE(std::equal(united.begin(), united.end(), expectedUnion.begin(), expectedUnion.end()));
+        EXPECT_TRUE(std::equal(
+            intersected.begin(), intersected.end(), expectedIntersection.begin(), expectedIntersection.end()));
+        EXPECT_TRUE(std::equal(
+            subtracted.begin(), subtracted.end(), expectedDifference.begin(), expectedDifference.end()));
+
+        EXPECT_EQ(expectedUnion.size(), united.size());
+        EXPECT_EQ(expectedIntersection.size(), intersected.size());
+        EXPECT_EQ(expectedDifference.size(), subtracted.size());
+
+        // The results have to be balanced, with the right sizes, balance
+        // factors, and parent pointers, to keep working afterward.
+        EXPECT_LE(united.height(), 21);
+        EXPECT_EQ(united.size() / 2, united.rank(united.select(united.size() / 2)));
+
+        for (int i = 0; i < 30000; ++i)
+        {
+            subtracted.add(i);
+            intersected.remove(i);
+        }
+
+        EXPECT_EQ(30000, subtracted.size());
+        EXPECT_LE(subtracted.height(), 21);
+        EXPECT_EQ(0, intersected.size());
+    }
+}
+
+
+TEST(AVLSetTests, setOperationsWorkOnUnbalancedSetsAndTheSetItself)
+{
+    AVLSet<int> unbalanced{false};
+    for (int i = 0; i < 10; ++i)
+        unbalanced.add(i);
+
+    AVLSet<int> evens;
+    for (int i = 0; i < 20; i += 2)
+        evens.add(i);
+
+    AVLSet<int> united{unbalanced};
+    united.unionWith(evens);
+    EXPECT_EQ(15, united.size());
+
+    AVLSet<int> intersected{unbalanced};
+    intersected.intersectWith(evens);
+    EXPECT_EQ((std::vector<int>{0, 2, 4, 6, 8}), (std::vector<int>{intersected.begin(), intersected.end()}));
+
+    evens.differenceWith(unbalanced);
+    EXPECT_EQ((std::vector<int>{10, 12, 14, 16, 18}), (std::vector<int>{evens.begin(), evens.end()}));
+
+    evens.unionWith(evens);
+    evens.intersectWith(evens);
+    EXPECT_EQ(5, evens.size());
+
+    evens.differenceWith(evens);
+    EXPECT_EQ(0, evens.size());
+    EXPECT_TRUE(evens.begin() == evens.end());
+}
@@ -0,0 +1,104 @@
+// BloomFilterTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the BloomFilter.
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "BloomFilter.hpp"
+
+
+namespace
+{
+    std::vector<std::string> numberedWords(unsigned int count, const std::string& prefix)
+    {
+        std::vector<std::string> words;
+        for (unsigned int i = 0; i < count; ++i)
+            words.push_back(prefix + std::to_string(i));
+        return words;
+    }
+}
+
+
+TEST(BloomFilterTests, emptyFilterContainsNothing)
+{
+    BloomFilter f{0};
+    EXPECT_FALSE(f.mightContain("Boo"));
+    EXPECT_FALSE(f.mightContain(""));
+    EXPECT_EQ(64, f.memoryUsage());
+}
+
+
+TEST(BloomFilterTests, containsEverythingThatWasAdded)
+{
+    std::vector<std::string> words = numberedWords(10000, "WORD");
+    BloomFilter f{words.begin(), words.end()};
+
+    for (const std::string& word : words)
+        EXPECT_TRUE(f.mightContain(word));
+
+    f.add("Boo");
+    EXPECT_TRUE(f.mightContain("Boo"));
+}
+
+
+TEST(BloomFilterTests, fewWordsThatWereNeverAddedAreFalsePositives)
+{
+    std::vector<std::string> words = numberedWords(100000, "WORD");
+    BloomFilter f{words.begin(), words.end()};
+
+    unsigned int falsePositives = 0;
+    for (const std::string& word : numberedWords(100000, "NOPE"))
+        falsePositives += f.mightContain(word) ? 1 : 0;
+
+    // About 0.5% is expected with 12 bits per word.
+    EXPECT_LT(falsePositives, 1000);
+    EXPECT_EQ((100000 * 12 + 511) / 512 * 64, f.memoryUsage());
+}
+
+
+TEST(BloomFilterTests, moreBitsPerElementGiveFewerFalsePositives)
+{
+    std::vector<std::string> words = numberedWords(50000, "WORD");
+    std::vector<std::string> absent = numberedWords(50000, "NOPE");
+
+    BloomFilter small{words.begin(), words.end(), 6};
+    BloomFilter large{words.begin(), words.end(), 20};
+
+    unsigned int smallFalsePositives = 0;
+    unsigned int largeFalsePositives = 0;
+    for (const std::string& word : absent)
+    {
+        smallFalsePositives += small.mightContain(word) ? 1 : 0;
+        largeFalsePositives += large.mightContain(word) ? 1 : 0;
+    }
+
+    EXPECT_LT(largeFalsePositives, smallFalsePositives);
+}
+
+
+TEST(BloomFilterTests, copiesAndMovesHaveTheSameContents)
+{
+    std::vector<std::string> words = numberedWords(1000, "WORD");
+    BloomFilter f{words.begin(), words.end()};
+
+    BloomFilter copy{f};
+    BloomFilter assigned{0};
+    assigned = copy;
+    BloomFilter moved{std::move(copy)};
+
+    copy = BloomFilter{0};
+    EXPECT_FALSE(copy.mightContain("WORD0"));
+
+    for (const std::string& word : words)
+    {
+        EXPECT_TRUE(assigned.mightContain(word));
+        EXPECT_TRUE(moved.mightContain(word));
+    }
+
+    EXPECT_EQ(f.memoryUsage(), moved.memoryUsage());
+}
@@ -0,0 +1,140 @@
+// ConcurrentHashSetTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the ConcurrentHashSet, including ones that add and look
+// up elements from several threads at once.
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ConcurrentHashSet.hpp"
+
+
+namespace
+{
+    template <typename T>
+    unsigned int zeroHash(const T&)
+    {
+        return 0;
+    }
+
+
+    unsigned int identityHash(const int& i)
+    {
+        return static_cast<unsigned int>(i);
+    }
+
+
+    constexpr int THREAD_COUNT = 8;
+}
+
+
+TEST(ConcurrentHashSetTests, behavesLikeASetOnOneThread)
+{
+    ConcurrentHashSet<std::string> s{zeroHash<std::string>};
+    Set<std::string>& ss = s;
+    ss.add("Boo");
+    ss.add("is");
+    ss.add("Boo");
+
+    EXPECT_TRUE(ss.isImplemented());
+    EXPECT_EQ(2, ss.size());
+    EXPECT_TRUE(ss.contains("is"));
+    EXPECT_FALSE(ss.contains("happy"));
+    EXPECT_EQ(2, s.elementsAtIndex(0));
+    EXPECT_TRUE(s.isElementAtIndex("Boo", 0));
+    EXPECT_FALSE(s.isElementAtIndex("Boo", 1));
+}
+
+
+TEST(ConcurrentHashSetTests, resizesAsElementsAreAdded)
+{
+    ConcurrentHashSet<int> s{identityHash};
+
+    for (int i = 0; i < 1000; ++i)
+        s.add(i);
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_GE(s.capacity() * 4, s.size() * 5);
+    EXPECT_EQ(0, s.capacity() % ConcurrentHashSet<int>::STRIPE_COUNT);
+
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_TRUE(s.isElementAtIndex(i, i % s.capacity()));
+
+    ConcurrentHashSet<int> copy{s};
+    EXPECT_EQ(1000, copy.size());
+    EXPECT_TRUE(copy.contains(999));
+}
+
+
+TEST(ConcurrentHashSetTests, concurrentAddsAreAllKept)
+{
+    ConcurrentHashSet<int> s{identityHash};
+    std::vector<std::thread> threads;
+
+    // Every thread adds the same 10000 elements, plus 1000 of its own.
+    for (int t = 0; t < THREAD_COUNT; ++t)
+    {
+        threads.emplace_back([&s, t]
+        {
+            for (int i = 0; i < 10000; ++i)
+            {
+                s.add(i);
+                if (i % 10 == 0)
+                    s.add(100000 + t * 1000 + i / 10);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(10000 + THREAD_COUNT * 1000, s.size());
+
+    for (int i = 0; i < 10000; ++i)
+        EXPECT_TRUE(s.contains(i));
+
+    for (int i = 0; i < THREAD_COUNT * 1000; ++i)
+        EXPECT_TRUE(s.contains(100000 + i));
+}
+
+
+TEST(ConcurrentHashSetTests, readersSeeElementsAddedBeforeThemDuringResizes)
+{
+    ConcurrentHashSet<int> s{identityHash};
+    for (int i = 0; i < 100; ++i)
+        s.add(i);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::vector<std::thread> readers;
+
+    for (int t = 0; t < THREAD_COUNT / 2; ++t)
+    {
+        readers.emplace_back([&]
+        {
+            while (!done.load())
+            {
+                for (int i = 0; i < 100; ++i)
+                {
+                    if (!s.contains(i))
+                        ++misses;
+                }
+            }
+        });
+    }
+
+    for (int i = 100; i < 50000; ++i)
+        s.add(i);
+
+    done.store(true);
+    for (std::thread& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(0, misses.load());
+    EXPECT_EQ(50000, s.size());
+}
@@ -0,0 +1,88 @@
+// EpochReclaimerTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the EpochReclaimer.
+
+#include <atomic>
+#include <thread>
+#include <gtest/gtest.h>
+#include "EpochReclaimer.hpp"
+
+
+namespace
+{
+    void deleteInt(void* p)
+    {
+        delete static_cast<int*>(p);
+    }
+}
+
+
+TEST(EpochReclaimerTests, retiredObjectsAreDeletedOnceUnpinned)
+{
+    EpochReclaimer reclaimer;
+    reclaimer.retire(new int{1}, deleteInt);
+
+    // With no readers, two more epochs pass after a couple of collections.
+    reclaimer.collect();
+    reclaimer.collect();
+    EXPECT_EQ(0, reclaimer.pendingCount());
+}
+
+
+TEST(EpochReclaimerTests, pinnedReaderDelaysDeletion)
+{
+    EpochReclaimer reclaimer;
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> release{false};
+
+    std::thread reader{[&]
+    {
+        EpochReclaimer::Guard guard = reclaimer.pin();
+        pinned.store(true);
+        while (!release.load())
+            std::this_thread::yield();
+    }};
+
+    while (!pinned.load())
+        std::this_thread::yield();
+
+    reclaimer.retire(new int{1}, deleteInt);
+    for (int i = 0; i < 10; ++i)
+        reclaimer.collect();
+
+    EXPECT_EQ(1, reclaimer.pendingCount());
+
+    release.store(true);
+    reader.join();
+
+    for (int i = 0; i < 3; ++i)
+        reclaimer.collect();
+
+    EXPECT_EQ(0, reclaimer.pendingCount());
+}
+
+
+TEST(EpochReclaimerTests, guardsCanBeNested)
+{
+    EpochReclaimer reclaimer;
+    {
+        EpochReclaimer::Guard outer = reclaimer.pin();
+        {
+            EpochReclaimer::Guard inner = reclaimer.pin();
+        }
+
+        reclaimer.retire(new int{1}, deleteInt);
+        for (int i = 0; i < 10; ++i)
+            reclaimer.collect();
+
+        EXPECT_EQ(1, reclaimer.pendingCount());
+    }
+
+    for (int i = 0; i < 3; ++i)
+        reclaimer.collect();
+
+    EXPECT_EQ(0, reclaimer.pendingCount());
+}
@@ -0,0 +1,140 @@
+// FastHashTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the FastHash functions, including how evenly they spread
+// keys across the cells of a HashSet.
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <gtest/gtest.h>
+#include "FastHash.hpp"
+#include "HashSet.hpp"
+
+
+namespace
+{
+    // Returns the length of the longest list in the given HashSet.
+    template <typename SetType>
+    unsigned int longestChain(const SetType& s)
+    {
+        unsigned int longest = 0;
+        for (unsigned int i = 0; i < s.capacity(); ++i)
+        {
+            unsigned int length = s.elementsAtIndex(i);
+            if (length > longest)
+                longest = length;
+        }
+
+        return longest;
+    }
+
+
+    // Returns the number of cells in the given HashSet with nothing in them.
+    template <typename SetType>
+    unsigned int emptyCells(const SetType& s)
+    {
+        unsigned int empty = 0;
+        for (unsigned int i = 0; i < s.capacity(); ++i)
+        {
+            if (s.elementsAtIndex(i) == 0)
+                ++empty;
+        }
+
+        return empty;
+    }
+}
+
+
+TEST(FastHashTests, sameInputAndSeedGiveSameHash)
+{
+    std::string s = "spellcheck";
+    EXPECT_EQ(fastHash64(s.data(), s.size(), 46), fastHash64(s.data(), s.size(), 46));
+    EXPECT_EQ(FastHash<std::string>{}(s), FastHash<std::string>{}(std::string_view{s}));
+}
+
+
+TEST(FastHashTests, differentSeedsGiveDifferentHashes)
+{
+    FastHash<std::string> h1{1};
+    FastHash<std::string> h2{2};
+    EXPECT_NE(h1("spellcheck"), h2("spellcheck"));
+
+    FastHash<int> i1{1};
+    FastHash<int> i2{2};
+    EXPECT_NE(i1(46), i2(46));
+}
+
+
+TEST(FastHashTests, everyLengthAndEveryByteMatters)
+{
+    // Strings of every length up to 100, each differing from the one before
+    // it in a single byte or a single extra byte, so that every code path
+    // in the hash (including the ones with overlapping reads) is covered.
+    std::unordered_set<std::uint64_t> seen;
+    std::string s;
+
+    for (unsigned int length = 0; length <= 100; ++length)
+    {
+        EXPECT_TRUE(seen.insert(fastHash64(s.data(), s.size())).second);
+
+        for (unsigned int i = 0; i < s.size(); ++i)
+        {
+            std::string changed = s;
+            changed[i] = 'B';
+            EXPECT_TRUE(seen.insert(fastHash64(changed.data(), changed.size())).second);
+        }
+
+        s.push_back('A');
+    }
+}
+
+
+TEST(FastHashTests, isHashSetsDefaultHash)
+{
+    HashSet<std::string> s;
+    s.add("Boo");
+    s.add("is");
+    s.add("happy");
+
+    FastHash<std::string> hash;
+    EXPECT_TRUE(s.isElementAtIndex("Boo", hash("Boo") % s.capacity()));
+    EXPECT_TRUE(s.contains("is"));
+    EXPECT_FALSE(s.contains("sad"));
+}
+
+
+TEST(FastHashTests, spreadsSimilarWordsEvenly)
+{
+    // Words that differ only in their last few characters are the worst
+    // case for hashes that mix one byte at a time.
+    HashSet<std::string, FastHash<std::string>> s{FastHash<std::string>{}};
+    s.reserve(20000);
+    for (unsigned int i = 0; i < 20000; ++i)
+        s.add("WORD" + std::to_string(i));
+
+    // With n elements in c cells, about c * e^(-n/c) cells should be empty
+    // and the longest list should be short.
+    double expectedEmpty = s.capacity() * std::exp(-20000.0 / s.capacity());
+    EXPECT_NEAR(expectedEmpty, emptyCells(s), expectedEmpty * 0.1);
+    EXPECT_LE(longestChain(s), 10);
+}
+
+
+TEST(FastHashTests, spreadsStridedIntegersEvenly)
+{
+    // Multiples of a power of two would all land in a few cells under the
+    // identity hash.
+    HashSet<int, FastHash<int>> s{FastHash<int>{}};
+    s.reserve(4096);
+    for (int i = 0; i < 4096; ++i)
+        s.add(i * 1024);
+
+    double expectedEmpty = s.capacity() * std::exp(-4096.0 / s.capacity());
+    EXPECT_NEAR(expectedEmpty, emptyCells(s), expectedEmpty * 0.1);
+    EXPECT_LE(longestChain(s), 10);
+}
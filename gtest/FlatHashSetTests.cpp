@@ -0,0 +1,118 @@
+// FlatHashSetTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the FlatHashSet, covering growth past several doublings
+// and the bookkeeping behind elementsAtIndex() and isElementAtIndex().
+
+#include <string>
+#include <gtest/gtest.h>
+#include "FlatHashSet.hpp"
+
+
+namespace
+{
+    template <typename T>
+    unsigned int zeroHash(const T&)
+    {
+        return 0;
+    }
+
+
+    unsigned int identityHash(const int& i)
+    {
+        return static_cast<unsigned int>(i);
+    }
+}
+
+
+TEST(FlatHashSetTests, inheritFromSet)
+{
+    FlatHashSet<std::string> s{zeroHash<std::string>};
+    Set<std::string>& ss = s;
+    EXPECT_TRUE(ss.isImplemented());
+    EXPECT_EQ(0, ss.size());
+}
+
+
+TEST(FlatHashSetTests, containsElementsAfterGrowing)
+{
+    FlatHashSet<int> s{identityHash};
+
+    for (int i = 0; i < 1000; ++i)
+        s.add(i * 7);
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_GE(s.capacity() * 7, s.size() * 8);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i * 7));
+        EXPECT_FALSE(s.contains(i * 7 + 1));
+    }
+}
+
+
+TEST(FlatHashSetTests, addingDuplicatesHasNoEffect)
+{
+    FlatHashSet<std::string> s{zeroHash<std::string>};
+    s.add("Boo");
+    s.add("is");
+    s.add("Boo");
+
+    EXPECT_EQ(2, s.size());
+}
+
+
+TEST(FlatHashSetTests, collidingElementsSpillIntoOtherGroups)
+{
+    FlatHashSet<int> s{zeroHash<int>};
+
+    for (int i = 0; i < 100; ++i)
+        s.add(i);
+
+    EXPECT_EQ(100, s.size());
+    EXPECT_EQ(100, s.elementsAtIndex(0));
+    EXPECT_EQ(0, s.elementsAtIndex(1));
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+        EXPECT_TRUE(s.isElementAtIndex(i, 0));
+        EXPECT_FALSE(s.isElementAtIndex(i, 1));
+    }
+
+    EXPECT_FALSE(s.contains(100));
+}
+
+
+TEST(FlatHashSetTests, copiesAreIndependent)
+{
+    FlatHashSet<int> s1{identityHash};
+    s1.add(1);
+    s1.add(2);
+
+    FlatHashSet<int> s2{s1};
+    s2.add(3);
+
+    EXPECT_EQ(2, s1.size());
+    EXPECT_FALSE(s1.contains(3));
+    EXPECT_EQ(3, s2.size());
+    EXPECT_TRUE(s2.contains(1));
+}
+
+
+TEST(FlatHashSetTests, movedFromSetCanStillBeUsed)
+{
+    FlatHashSet<int> s1{identityHash};
+    s1.add(1);
+
+    FlatHashSet<int> s2{std::move(s1)};
+    EXPECT_TRUE(s2.contains(1));
+
+    s1 = FlatHashSet<int>{identityHash};
+    s1.add(5);
+    EXPECT_TRUE(s1.contains(5));
+    EXPECT_EQ(1, s1.size());
+}
@@ -0,0 +1,169 @@
+// FrozenAVLSetTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the FrozenAVLSet, mostly built by freezing an AVLSet,
+// covering every size of tree up to a few levels, so that the last level
+// is sometimes full and sometimes not.
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AVLSet.hpp"
+#include "FrozenAVLSet.hpp"
+
+
+namespace
+{
+    struct DescendingComparison
+    {
+        static int compare(int a, int b)
+        {
+            return (b > a) - (b < a);
+        }
+    };
+}
+
+
+TEST(FrozenAVLSetTests, emptySetContainsNothing)
+{
+    FrozenAVLSet<int> s;
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(0));
+    EXPECT_EQ(0, s.memoryUsage());
+
+    AVLSet<int> empty;
+    FrozenAVLSet<int> t = empty.freeze();
+    EXPECT_EQ(0, t.size());
+    EXPECT_FALSE(t.contains(0));
+}
+
+
+TEST(FrozenAVLSetTests, containsExactlyTheElementsOfEverySizeOfTree)
+{
+    // Only odd numbers are added, so every even number, including the ones
+    // below and above all of them, falls between two elements.
+    for (int count = 1; count <= 70; ++count)
+    {
+        AVLSet<int> a;
+        for (int i = 0; i < count; ++i)
+            a.add(2 * i + 1);
+
+        FrozenAVLSet<int> s = a.freeze();
+        ASSERT_EQ(count, s.size());
+
+        for (int i = 0; i <= 2 * count; ++i)
+            ASSERT_EQ(i % 2 != 0, s.contains(i)) << "count " << count << ", element " << i;
+    }
+}
+
+
+TEST(FrozenAVLSetTests, containsTheSameElementsAsALargeTree)
+{
+    std::vector<int> values(100000);
+    for (int i = 0; i < 100000; ++i)
+        values[i] = i * 3;
+
+    std::shuffle(values.begin(), values.end(), std::mt19937{46});
+
+    AVLSet<int> a;
+    for (int value : values)
+        a.add(value);
+
+    FrozenAVLSet<int> s = a.freeze();
+    ASSERT_EQ(a.size(), s.size());
+
+    for (int i = -1; i < 300001; ++i)
+        ASSERT_EQ(a.contains(i), s.contains(i)) << i;
+}
+
+
+TEST(FrozenAVLSetTests, isUnaffectedByChangesToTheTree)
+{
+    AVLSet<std::string> a;
+    a.add("Boo");
+    a.add("is");
+    a.add("happy");
+
+    FrozenAVLSet<std::string> s = a.freeze();
+    a.remove("Boo");
+    a.add("today");
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_TRUE(s.contains("Boo"));
+    EXPECT_FALSE(s.contains("today"));
+}
+
+
+TEST(FrozenAVLSetTests, addingThrowsAndChangesNothing)
+{
+    std::vector<std::string> words{"Boo", "happy", "is"};
+    FrozenAVLSet<std::string> s{words.begin(), words.end()};
+
+    EXPECT_THROW(s.add("today"), std::logic_error);
+    EXPECT_THROW(s.add("Boo"), std::logic_error);
+    EXPECT_EQ(3, s.size());
+    EXPECT_FALSE(s.contains("today"));
+}
+
+
+TEST(FrozenAVLSetTests, canLookUpStringViews)
+{
+    std::vector<std::string> words{"Boo", "happy", "is", "today"};
+    FrozenAVLSet<std::string> s{words.begin(), words.end()};
+
+    std::string text = "Boo is happy";
+    EXPECT_TRUE(s.contains(std::string_view{text}.substr(0, 3)));
+    EXPECT_TRUE(s.contains(std::string_view{text}.substr(4, 2)));
+    EXPECT_FALSE(s.contains(std::string_view{text}.substr(0, 2)));
+    EXPECT_FALSE(s.contains(std::string_view{text}));
+}
+
+
+TEST(FrozenAVLSetTests, keepsTheTreesComparisonPolicy)
+{
+    AVLSet<int, DescendingComparison> a;
+    for (int i = 0; i < 20; ++i)
+        a.add(i * 2);
+
+    FrozenAVLSet<int, DescendingComparison> s = a.freeze();
+
+    for (int i = -1; i < 41; ++i)
+        EXPECT_EQ(i % 2 == 0 && i < 40, s.contains(i)) << i;
+}
+
+
+TEST(FrozenAVLSetTests, copiesAndMovesAreIndependent)
+{
+    std::vector<std::string> words;
+    for (int i = 0; i < 100; ++i)
+        words.push_back("a longer word than fits inside a std::string " + std::to_string(1000 + i));
+
+    FrozenAVLSet<std::string> s{words.begin(), words.end()};
+
+    FrozenAVLSet<std::string> copied{s};
+    FrozenAVLSet<std::string> moved{std::move(s)};
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(words[0]));
+
+    FrozenAVLSet<std::string> assigned;
+    assigned = copied;
+    s = std::move(moved);
+
+    for (const std::string& word : words)
+    {
+        EXPECT_TRUE(copied.contains(word));
+        EXPECT_TRUE(assigned.contains(word));
+        EXPECT_TRUE(s.contains(word));
+    }
+
+    assigned = assigned;
+    EXPECT_EQ(100, assigned.size());
+    EXPECT_TRUE(assigned.contains(words[50]));
+}
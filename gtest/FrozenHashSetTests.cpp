@@ -0,0 +1,368 @@
+// FrozenHashSetTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the FrozenHashSet, including building one from each of
+// the other kinds of sets.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AVLSet.hpp"
+#include "FastHash.hpp"
+#include "FrozenHashSet.hpp"
+#include "HashSet.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    std::vector<std::string> numberedWords(unsigned int count, const std::string& prefix)
+    {
+        std::vector<std::string> words;
+        for (unsigned int i = 0; i < count; ++i)
+            words.push_back(prefix + std::to_string(i));
+        return words;
+    }
+}
+
+
+TEST(FrozenHashSetTests, emptySetContainsNothing)
+{
+    FrozenHashSet s;
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains("Boo"));
+    EXPECT_FALSE(s.contains(""));
+    EXPECT_EQ(0, s.memoryUsage());
+
+    std::vector<std::string> none;
+    FrozenHashSet t{none.begin(), none.end()};
+    EXPECT_EQ(0, t.size());
+    EXPECT_FALSE(t.contains("Boo"));
+}
+
+
+TEST(FrozenHashSetTests, containsEveryElementOfTheRange)
+{
+    std::vector<std::string> words{"Boo", "is", "happy", "today", ""};
+    FrozenHashSet s{words.begin(), words.end()};
+
+    EXPECT_EQ(5, s.size());
+    for (const std::string& word : words)
+        EXPECT_TRUE(s.contains(word));
+
+    EXPECT_FALSE(s.contains("sad"));
+    EXPECT_FALSE(s.contains("Bo"));
+    EXPECT_FALSE(s.contains("Booo"));
+    EXPECT_FALSE(s.contains("boo"));
+}
+
+
+TEST(FrozenHashSetTests, duplicatesAreOnlyIncludedOnce)
+{
+    std::vector<std::string> words{"Boo", "is", "Boo", "happy", "is", "Boo"};
+    FrozenHashSet s{words.begin(), words.end()};
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_TRUE(s.contains("Boo"));
+    EXPECT_TRUE(s.contains("is"));
+    EXPECT_TRUE(s.contains("happy"));
+}
+
+
+TEST(FrozenHashSetTests, addingThrowsAndChangesNothing)
+{
+    std::vector<std::string> words{"Boo"};
+    FrozenHashSet s{words.begin(), words.end()};
+    EXPECT_THROW(s.add("happy"), std::logic_error);
+    EXPECT_THROW(s.add("Boo"), std::logic_error);
+
+    EXPECT_EQ(1, s.size());
+    EXPECT_FALSE(s.contains("happy"));
+}
+
+
+TEST(FrozenHashSetTests, canBeBuiltFromAHashSet)
+{
+    std::vector<std::string> words = numberedWords(5000, "WORD");
+    HashSet<std::string> source{FastHash<std::string>{}, 1};
+    for (const std::string& word : words)
+        source.add(word);
+
+    FrozenHashSet s{source};
+    EXPECT_EQ(source.size(), s.size());
+    for (const std::string& word : words)
+        EXPECT_TRUE(s.contains(word));
+
+    for (const std::string& word : numberedWords(5000, "NOPE"))
+        EXPECT_FALSE(s.contains(word));
+}
+
+
+TEST(FrozenHashSetTests, canBeBuiltFromAnAVLSet)
+{
+    std::vector<std::string> words = numberedWords(1000, "WORD");
+    AVLSet<std::string> source;
+    for (const std::string& word : words)
+        source.add(word);
+
+    FrozenHashSet s{source};
+    EXPECT_EQ(1000, s.size());
+    for (const std::string& word : words)
+        EXPECT_TRUE(s.contains(word));
+
+    EXPECT_FALSE(s.contains("WORD1000"));
+}
+
+
+TEST(FrozenHashSetTests, canLookUpStringViews)
+{
+    std::vector<std::string> words{"Boo", "is", "happy"};
+    FrozenHashSet s{words.begin(), words.end()};
+
+    std::string sentence = "Boo is happy today";
+    std::string_view view{sentence};
+    EXPECT_TRUE(s.contains(view.substr(0, 3)));
+    EXPECT_TRUE(s.contains(view.substr(4, 2)));
+    EXPECT_TRUE(s.contains(view.substr(7, 5)));
+    EXPECT_FALSE(s.contains(view.substr(13, 5)));
+}
+
+
+TEST(FrozenHashSetTests, copiesAndMovesAreIndependent)
+{
+    std::vector<std::string> words = numberedWords(100, "WORD");
+    FrozenHashSet s{words.begin(), words.end()};
+
+    FrozenHashSet copy{s};
+    FrozenHashSet assigned;
+    assigned = copy;
+    FrozenHashSet moved{std::move(copy)};
+
+    EXPECT_EQ(0, copy.size());
+    EXPECT_FALSE(copy.contains("WORD0"));
+
+    for (const std::string& word : words)
+    {
+        EXPECT_TRUE(s.contains(word));
+        EXPECT_TRUE(assigned.contains(word));
+        EXPECT_TRUE(moved.contains(word));
+    }
+
+    EXPECT_EQ(s.memoryUsage(), moved.memoryUsage());
+}
+
+
+TEST(FrozenHashSetTests, usesLittleMoreMemoryThanTheCharacters)
+{
+    std::vector<std::string> words = numberedWords(100000, "WORD");
+    FrozenHashSet s{words.begin(), words.end()};
+
+    std::size_t characters = 0;
+    for (const std::string& word : words)
+    {
+        characters += word.size();
+        ASSERT_TRUE(s.contains(word));
+    }
+
+    for (const std::string& word : numberedWords(100000, "NOPE"))
+        ASSERT_FALSE(s.contains(word));
+
+    // Eight bytes per slot, plus the pilots and redirects, which together
+    // come to about one more byte per element.
+    EXPECT_EQ(100000, s.size());
+    EXPECT_LE(s.memoryUsage(), characters + 10 * words.size());
+}
+
+
+TEST(FrozenHashSetTests, givesAWordCheckerTheSameSuggestions)
+{
+    std::vector<std::string> dictionary{
+        "EHLO", "HELLO", "HEL", "HALO", "HE", "LO", "HELP", "HOLE", "HELD"};
+
+    AVLSet<std::string> tree;
+    for (const std::string& w : dictionary)
+        tree.add(w);
+
+    FrozenHashSet frozen{tree};
+
+    WordChecker one{tree};
+    WordChecker other{frozen};
+
+    for (const char* word : {"HELO", "HLEP", "HOEL", "HELPLO", "X", ""})
+        EXPECT_EQ(one.findSuggestions(word), other.findSuggestions(word));
+}
+
+
+TEST(FrozenHashSetTests, savedImagesCanBeMapped)
+{
+    std::string path = testing::TempDir() + "FrozenHashSetTests.img";
+    std::vector<std::string> words = numberedWords(10000, "WORD");
+
+    {
+        FrozenHashSet s{words.begin(), words.end()};
+        ASSERT_TRUE(s.saveImage(path));
+    }
+
+    FrozenHashSet mapped;
+    ASSERT_TRUE(mapped.mapImage(path));
+    EXPECT_TRUE(mapped.isMapped());
+    EXPECT_EQ(10000, mapped.size());
+
+    for (const std::string& word : words)
+        EXPECT_TRUE(mapped.contains(word));
+
+    for (const std::string& word : numberedWords(10000, "NOPE"))
+        EXPECT_FALSE(mapped.contains(word));
+
+    // A copy of a mapped set is an ordinary one, and a moved one stays
+    // mapped.
+    FrozenHashSet copy{mapped};
+    EXPECT_FALSE(copy.isMapped());
+    EXPECT_TRUE(copy.contains("WORD9999"));
+
+    FrozenHashSet moved{std::move(mapped)};
+    EXPECT_TRUE(moved.isMapped());
+    EXPECT_FALSE(mapped.isMapped());
+    EXPECT_TRUE(moved.contains("WORD0"));
+
+    std::remove(path.c_str());
+}
+
+
+TEST(FrozenHashSetTests, emptySetsCanBeSavedAndMapped)
+{
+    std::string path = testing::TempDir() + "FrozenHashSetTests.img";
+
+    FrozenHashSet empty;
+    ASSERT_TRUE(empty.saveImage(path));
+
+    FrozenHashSet mapped;
+    ASSERT_TRUE(mapped.mapImage(path));
+    EXPECT_EQ(0, mapped.size());
+    EXPECT_FALSE(mapped.contains(""));
+
+    std::remove(path.c_str());
+}
+
+
+TEST(FrozenHashSetTests, damagedImagesAreNotMapped)
+{
+    std::string path = testing::TempDir() + "FrozenHashSetTests.img";
+    std::vector<std::string> words = numberedWords(1000, "WORD");
+    FrozenHashSet s{words.begin(), words.end()};
+    ASSERT_TRUE(s.saveImage(path));
+
+    std::string image;
+    {
+        std::ifstream in{path, std::ios::binary};
+        image.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    }
+
+    auto writeImage = [&](const std::string& bytes)
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(bytes.data(), bytes.size());
+    };
+
+    FrozenHashSet mapped;
+
+    // One changed character is only caught by the checksum.
+    std::string changed = image;
+    changed[changed.size() - 1] ^= 1;
+    writeImage(changed);
+    EXPECT_FALSE(mapped.mapImage(path));
+    EXPECT_TRUE(mapped.mapImage(path, false));
+
+    writeImage(image.substr(0, image.size() - 1));
+    EXPECT_FALSE(mapped.mapImage(path, false));
+    EXPECT_EQ(0, mapped.size());
+
+    std::string wrongMagic = image;
+    wrongMagic[0] = 'X';
+    writeImage(wrongMagic);
+    EXPECT_FALSE(mapped.mapImage(path, false));
+
+    writeImage("");
+    EXPECT_FALSE(mapped.mapImage(path, false));
+
+    std::remove(path.c_str());
+    EXPECT_FALSE(mapped.mapImage(path));
+    EXPECT_FALSE(mapped.contains("WORD0"));
+}
+
+
+TEST(FrozenHashSetTests, damagedHeadersAreCaughtByTheChecksum)
+{
+    std::string path = testing::TempDir() + "FrozenHashSetTests.img";
+    std::vector<std::string> words = numberedWords(1000, "WORD");
+    FrozenHashSet s{words.begin(), words.end()};
+    ASSERT_TRUE(s.saveImage(path));
+
+    std::string image;
+    {
+        std::ifstream in{path, std::ios::binary};
+        image.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    }
+
+    // The seed is the eight bytes after the magic, version, and byte order;
+    // with a different seed, every lookup would go to the wrong slot.
+    image[16] ^= 1;
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(image.data(), image.size());
+    }
+
+    FrozenHashSet mapped;
+    EXPECT_FALSE(mapped.mapImage(path));
+    EXPECT_EQ(0, mapped.size());
+
+    std::remove(path.c_str());
+}
+
+
+TEST(FrozenHashSetTests, redirectsOutsideTheSlotsAreNotMapped)
+{
+    std::string path = testing::TempDir() + "FrozenHashSetTests.img";
+    std::vector<std::string> words = numberedWords(1000, "WORD");
+    FrozenHashSet s{words.begin(), words.end()};
+    ASSERT_TRUE(s.saveImage(path));
+
+    std::string image;
+    {
+        std::ifstream in{path, std::ios::binary};
+        image.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    }
+
+    // The redirects' offset follows the magic, version, byte order, seed,
+    // four sizes, and the pilots' offset.
+    std::uint64_t redirectsOffset;
+    std::memcpy(&redirectsOffset, image.data() + 48, sizeof(redirectsOffset));
+    ASSERT_LT(redirectsOffset + sizeof(std::uint32_t), image.size());
+
+    std::uint32_t farAway = 0xffffffff;
+    std::memcpy(&image[redirectsOffset], &farAway, sizeof(farAway));
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(image.data(), image.size());
+    }
+
+    FrozenHashSet mapped;
+    EXPECT_FALSE(mapped.mapImage(path));
+    EXPECT_FALSE(mapped.mapImage(path, false));
+    EXPECT_EQ(0, mapped.size());
+
+    for (const std::string& word : words)
+        EXPECT_FALSE(mapped.contains(word));
+
+    std::remove(path.c_str());
+}
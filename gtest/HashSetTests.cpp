@@ -0,0 +1,791 @@
+// HashSetTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the HashSet beyond the sanity checks, covering resizing
+// (both all at once and incrementally), copying, moving, and building a
+// HashSet from a range of elements.
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "HashSet.hpp"
+
+
+namespace
+{
+    template <typename T>
+    unsigned int zeroHash(const T&)
+    {
+        return 0;
+    }
+
+
+    unsigned int identityHash(const int& i)
+    {
+        return static_cast<unsigned int>(i);
+    }
+}
+
+
+TEST(HashSetTests, containsElementsAfterResizing)
+{
+    HashSet<int> s{identityHash};
+
+    for (int i = 0; i < 500; ++i)
+        s.add(i);
+
+    EXPECT_EQ(500, s.size());
+    EXPECT_FALSE(s.isResizing());
+
+    for (int i = 0; i < 500; ++i)
+        EXPECT_TRUE(s.contains(i));
+
+    EXPECT_FALSE(s.contains(500));
+}
+
+
+TEST(HashSetTests, incrementalResizeFinishesAfterEnoughAdds)
+{
+    HashSet<int> s{identityHash, 1};
+
+    for (int i = 0; i < 8; ++i)
+        s.add(i);
+
+    EXPECT_FALSE(s.isResizing());
+
+    // The ninth element would make the set more than 80% full, so it
+    // starts a resize, which moves one cell per add.
+    s.add(8);
+    EXPECT_TRUE(s.isResizing());
+    EXPECT_EQ(20, s.capacity());
+
+    for (int i = 0; i <= 8; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+        EXPECT_TRUE(s.isElementAtIndex(i, i % 20));
+        EXPECT_EQ(1, s.elementsAtIndex(i % 20));
+    }
+
+    for (int i = 9; i < 18; ++i)
+        s.add(i);
+
+    EXPECT_FALSE(s.isResizing());
+    EXPECT_EQ(18, s.size());
+
+    for (int i = 0; i < 18; ++i)
+        EXPECT_TRUE(s.contains(i));
+}
+
+
+TEST(HashSetTests, addingDuplicatesDuringResizeHasNoEffect)
+{
+    HashSet<int> s{identityHash, 1};
+
+    for (int i = 0; i < 11; ++i)
+        s.add(i);
+
+    ASSERT_TRUE(s.isResizing());
+
+    for (int i = 0; i < 11; ++i)
+        s.add(i);
+
+    EXPECT_EQ(11, s.size());
+}
+
+
+TEST(HashSetTests, copiesAreIndependent)
+{
+    HashSet<std::string> s1{zeroHash<std::string>};
+    s1.add("Boo");
+    s1.add("is");
+
+    HashSet<std::string> s2{s1};
+    s2.add("happy");
+
+    EXPECT_EQ(2, s1.size());
+    EXPECT_FALSE(s1.contains("happy"));
+    EXPECT_EQ(3, s2.size());
+    EXPECT_TRUE(s2.contains("Boo"));
+
+    HashSet<std::string> s3{zeroHash<std::string>};
+    s3 = s2;
+    EXPECT_EQ(3, s3.size());
+    EXPECT_TRUE(s3.contains("is"));
+}
+
+
+TEST(HashSetTests, copyingDuringResizeCopiesEverything)
+{
+    HashSet<int> s1{identityHash, 1};
+
+    for (int i = 0; i < 11; ++i)
+        s1.add(i);
+
+    ASSERT_TRUE(s1.isResizing());
+
+    HashSet<int> s2{s1};
+    EXPECT_FALSE(s2.isResizing());
+    EXPECT_EQ(11, s2.size());
+
+    for (int i = 0; i < 11; ++i)
+        EXPECT_TRUE(s2.contains(i));
+}
+
+
+TEST(HashSetTests, movingTransfersElements)
+{
+    HashSet<int> s1{identityHash};
+    s1.add(1);
+    s1.add(2);
+
+    HashSet<int> s2{std::move(s1)};
+    EXPECT_EQ(2, s2.size());
+    EXPECT_TRUE(s2.contains(1));
+
+    HashSet<int> s3{identityHash};
+    s3.add(3);
+    s3 = std::move(s2);
+    EXPECT_EQ(2, s3.size());
+    EXPECT_TRUE(s3.contains(2));
+    EXPECT_FALSE(s3.contains(3));
+}
+
+
+TEST(HashSetTests, resizingDoesNotRehashElements)
+{
+    unsigned int hashCalls = 0;
+    HashSet<int> s{[&](const int& i) { ++hashCalls; return static_cast<unsigned int>(i); }};
+
+    for (int i = 0; i < 1000; ++i)
+        s.add(i);
+
+    EXPECT_EQ(1000, hashCalls);
+
+    HashSet<int> copy{s};
+    EXPECT_EQ(1000, hashCalls);
+
+    EXPECT_TRUE(copy.contains(999));
+    EXPECT_EQ(1001, hashCalls);
+}
+
+
+namespace
+{
+    struct ModuloHash
+    {
+        unsigned int operator()(const int& i) const
+        {
+            return static_cast<unsigned int>(i) % 7;
+        }
+    };
+}
+
+
+TEST(HashSetTests, canUseFunctionObjectTypeAsHash)
+{
+    HashSet<int, ModuloHash> s{ModuloHash{}};
+
+    for (int i = 0; i < 100; ++i)
+        s.add(i);
+
+    EXPECT_EQ(100, s.size());
+    EXPECT_TRUE(s.contains(42));
+    EXPECT_FALSE(s.contains(100));
+    EXPECT_TRUE(s.isElementAtIndex(42, 0));
+
+    HashSet<int, ModuloHash> copy{s};
+    EXPECT_TRUE(copy.contains(99));
+}
+
+
+namespace
+{
+    struct TransparentStringHash
+    {
+        using is_transparent = void;
+
+        unsigned int operator()(std::string_view s) const
+        {
+            unsigned int hash = 0;
+            for (char c : s)
+                hash = hash * 31 + static_cast<unsigned char>(c);
+            return hash;
+        }
+    };
+}
+
+
+TEST(HashSetTests, canLookUpStringViewsWithTransparentHash)
+{
+    HashSet<std::string, TransparentStringHash> s{TransparentStringHash{}};
+    s.add("Boo");
+    s.add("is");
+    s.add("happy");
+
+    std::string buffer = "Boo is happy today";
+    EXPECT_TRUE(s.contains(std::string_view{buffer}.substr(0, 3)));
+    EXPECT_TRUE(s.contains(std::string_view{buffer}.substr(4, 2)));
+    EXPECT_TRUE(s.contains(std::string_view{buffer}.substr(7, 5)));
+    EXPECT_FALSE(s.contains(std::string_view{buffer}.substr(13, 5)));
+    EXPECT_FALSE(s.contains(std::string_view{buffer}.substr(0, 2)));
+}
+
+
+TEST(HashSetTests, containsManyMatchesContains)
+{
+    HashSet<int> s{identityHash, 1};
+
+    for (int i = 0; i < 11; ++i)
+        s.add(i);
+
+    // Some elements are still in the old array.
+    ASSERT_TRUE(s.isResizing());
+
+    int keys[40];
+    bool results[40];
+    for (int i = 0; i < 40; ++i)
+        keys[i] = 39 - i;
+
+    s.containsMany(keys, 40, results);
+
+    for (int i = 0; i < 40; ++i)
+        EXPECT_EQ(s.contains(keys[i]), results[i]);
+}
+
+
+TEST(HashSetTests, reserveAvoidsResizingWhileAdding)
+{
+    HashSet<int> s{identityHash};
+    s.reserve(1000);
+
+    unsigned int capacity = s.capacity();
+    EXPECT_GE(capacity, 1250);
+
+    for (int i = 0; i < 1000; ++i)
+        s.add(i);
+
+    EXPECT_EQ(capacity, s.capacity());
+    EXPECT_EQ(1000, s.size());
+
+    // Reserving less than the set already has room for does nothing.
+    s.reserve(10);
+    EXPECT_EQ(capacity, s.capacity());
+}
+
+
+TEST(HashSetTests, reserveFinishesAnIncrementalResize)
+{
+    HashSet<int> s{identityHash, 1};
+
+    for (int i = 0; i < 11; ++i)
+        s.add(i);
+
+    ASSERT_TRUE(s.isResizing());
+
+    s.reserve(100);
+    EXPECT_FALSE(s.isResizing());
+
+    for (int i = 0; i < 11; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+        EXPECT_TRUE(s.isElementAtIndex(i, i % s.capacity()));
+    }
+}
+
+
+TEST(HashSetTests, canBeBuiltFromARange)
+{
+    std::vector<std::string> words{"Boo", "is", "happy", "today", "is", "Boo"};
+    HashSet<std::string> s{words.begin(), words.end(), zeroHash<std::string>};
+
+    EXPECT_EQ(4, s.size());
+    for (const std::string& word : words)
+        EXPECT_TRUE(s.contains(word));
+}
+
+
+TEST(HashSetTests, rangesOfUniqueElementsCanBeHashedInParallel)
+{
+    std::vector<int> elements;
+    for (int i = 0; i < 1000; ++i)
+        elements.push_back(i * 3);
+
+    HashSet<int> s{elements.begin(), elements.end(), identityHash, true, 4};
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_FALSE(s.isResizing());
+
+    for (int i = 0; i < 3000; ++i)
+        EXPECT_EQ(i % 3 == 0, s.contains(i));
+}
+
+
+TEST(HashSetTests, canBeBuiltFromAnInputStream)
+{
+    std::istringstream in{"Boo is happy today Boo"};
+    HashSet<std::string> s{
+        std::istream_iterator<std::string>{in}, std::istream_iterator<std::string>{},
+        zeroHash<std::string>};
+
+    EXPECT_EQ(4, s.size());
+    EXPECT_TRUE(s.contains("today"));
+}
+
+
+TEST(HashSetTests, staysWithinTheMaxLoadFactor)
+{
+    HashSet<int> s{identityHash};
+    EXPECT_DOUBLE_EQ(0.8, s.maxLoadFactor());
+
+    s.setMaxLoadFactor(0.5);
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+        EXPECT_LE(s.loadFactor(), 0.5);
+    }
+
+    s.setMaxLoadFactor(4.0);
+    unsigned int capacity = s.capacity();
+    for (int i = 1000; i < 4000; ++i)
+        s.add(i);
+
+    EXPECT_EQ(capacity, s.capacity());
+    EXPECT_GT(s.loadFactor(), 1.0);
+}
+
+
+namespace
+{
+    struct IdentityHash
+    {
+        unsigned int operator()(const int& i) const
+        {
+            return static_cast<unsigned int>(i);
+        }
+    };
+
+
+    // Adds elements to the given HashSet, checking after each one that its
+    // capacity is one the sizing policy allows and that every element so
+    // far is at the index the policy says it should be.
+    template <typename Sizing>
+    void expectSizingPolicyIsFollowed(unsigned int migrationBudget)
+    {
+        HashSet<int, IdentityHash, Sizing> s{IdentityHash{}, migrationBudget};
+
+        for (int i = 0; i < 200; ++i)
+        {
+            int element = i * 40503;
+            s.add(element);
+
+            EXPECT_EQ(s.capacity(), Sizing::capacityAtLeast(s.capacity()));
+            unsigned int index = Sizing::indexFor(static_cast<unsigned int>(element), s.capacity());
+            EXPECT_TRUE(s.isElementAtIndex(element, index));
+        }
+
+        unsigned int total = 0;
+        for (unsigned int i = 0; i < s.capacity(); ++i)
+            total += s.elementsAtIndex(i);
+
+        EXPECT_EQ(200, total);
+    }
+}
+
+
+TEST(HashSetTests, powerOfTwoSizingMasksTheHash)
+{
+    EXPECT_EQ(16, (HashSet<int, IdentityHash, PowerOfTwoSizing>{IdentityHash{}}.capacity()));
+    expectSizingPolicyIsFollowed<PowerOfTwoSizing>(0);
+    expectSizingPolicyIsFollowed<PowerOfTwoSizing>(1);
+}
+
+
+TEST(HashSetTests, fastRangeSizingUsesTheHighBitsOfTheHash)
+{
+    EXPECT_EQ(0, FastRangeSizing::indexFor(12345, 10));
+    EXPECT_EQ(9, FastRangeSizing::indexFor(0xffffffffu, 10));
+    expectSizingPolicyIsFollowed<FastRangeSizing>(0);
+    expectSizingPolicyIsFollowed<FastRangeSizing>(1);
+}
+
+
+TEST(HashSetTests, primeSizingUsesPrimeCapacities)
+{
+    HashSet<int, IdentityHash, PrimeSizing> s{IdentityHash{}};
+    EXPECT_EQ(11, s.capacity());
+
+    for (int i = 0; i < 10; ++i)
+        s.add(i);
+
+    EXPECT_EQ(23, s.capacity());
+
+    expectSizingPolicyIsFollowed<PrimeSizing>(0);
+    expectSizingPolicyIsFollowed<PrimeSizing>(1);
+}
+
+
+TEST(HashSetTests, longListsAreTurnedIntoTrees)
+{
+    HashSet<int> s{zeroHash<int>};
+
+    for (int i = 0; i < 1000; ++i)
+        s.add(i);
+
+    EXPECT_EQ(1, s.treeCount());
+    EXPECT_EQ(1000, s.size());
+    EXPECT_EQ(1000, s.elementsAtIndex(0));
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+        EXPECT_TRUE(s.isElementAtIndex(i, 0));
+    }
+
+    EXPECT_FALSE(s.contains(1000));
+
+    s.add(500);
+    EXPECT_EQ(1000, s.size());
+
+    HashSet<int> copy{s};
+    EXPECT_EQ(1, copy.treeCount());
+    EXPECT_EQ(1000, copy.size());
+    EXPECT_TRUE(copy.contains(999));
+}
+
+
+TEST(HashSetTests, treesCanBeLookedUpWithStringViews)
+{
+    HashSet<std::string, TransparentStringHash> s{TransparentStringHash{}};
+    s.setTreeifyThreshold(1);
+
+    // "Aa" and "BB" have the same hash, so they share a cell.
+    s.add("Aa");
+    s.add("BB");
+    ASSERT_EQ(1, s.treeCount());
+
+    std::string buffer = "AaBB";
+    EXPECT_TRUE(s.contains(std::string_view{buffer}.substr(0, 2)));
+    EXPECT_TRUE(s.contains(std::string_view{buffer}.substr(2, 2)));
+    EXPECT_FALSE(s.contains(std::string_view{buffer}.substr(1, 2)));
+}
+
+
+namespace
+{
+    unsigned int timesTenHash(const int& i)
+    {
+        return static_cast<unsigned int>(i) * 10;
+    }
+}
+
+
+TEST(HashSetTests, treesGoBackToListsWhenAResizeSpreadsThemOut)
+{
+    for (unsigned int migrationBudget : {0u, 1u})
+    {
+        HashSet<int> s{timesTenHash, migrationBudget};
+        s.setTreeifyThreshold(2);
+
+        // With 10 cells, every element lands in cell 0.
+        for (int i = 0; i < 4; ++i)
+            s.add(i);
+
+        ASSERT_EQ(10, s.capacity());
+        EXPECT_EQ(1, s.treeCount());
+
+        s.reserve(100);
+        EXPECT_EQ(0, s.treeCount());
+
+        for (int i = 0; i < 4; ++i)
+        {
+            EXPECT_TRUE(s.contains(i));
+            EXPECT_TRUE(s.isElementAtIndex(i, i * 10 % s.capacity()));
+            EXPECT_EQ(1, s.elementsAtIndex(i * 10 % s.capacity()));
+        }
+    }
+}
+
+
+TEST(HashSetTests, treesAreMigratedIncrementally)
+{
+    HashSet<int> s{zeroHash<int>, 1};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+
+        for (int j = 0; j <= i; ++j)
+            ASSERT_TRUE(s.contains(j));
+    }
+
+    EXPECT_EQ(100, s.elementsAtIndex(0));
+}
+
+
+TEST(HashSetTests, listsStayListsWhenTreeifyingIsTurnedOff)
+{
+    HashSet<int> s{zeroHash<int>};
+    s.setTreeifyThreshold(0);
+
+    for (int i = 0; i < 100; ++i)
+        s.add(i);
+
+    EXPECT_EQ(0, s.treeCount());
+    EXPECT_TRUE(s.contains(99));
+}
+
+
+namespace
+{
+    // Points can be compared with ==, but not with <.
+    struct Point
+    {
+        int x;
+        int y;
+
+        bool operator==(const Point& other) const
+        {
+            return x == other.x && y == other.y;
+        }
+    };
+
+
+    unsigned int pointHash(const Point&)
+    {
+        return 0;
+    }
+}
+
+
+TEST(HashSetTests, listsOfUnorderedElementsStayLists)
+{
+    EXPECT_FALSE(HashSet<Point>::CAN_TREEIFY);
+
+    HashSet<Point> s{pointHash};
+    for (int i = 0; i < 20; ++i)
+        s.add(Point{i, -i});
+
+    EXPECT_EQ(0, s.treeCount());
+    EXPECT_EQ(20, s.size());
+    EXPECT_TRUE(s.contains(Point{19, -19}));
+    EXPECT_FALSE(s.contains(Point{19, 19}));
+}
+
+
+TEST(HashSetTests, forEachVisitsEveryElementOnce)
+{
+    HashSet<int> s{zeroHash<int>, 1};
+
+    for (int i = 0; i < 50; ++i)
+        s.add(i);
+
+    // Some elements are in a tree, and some are still in the old array.
+    ASSERT_TRUE(s.isResizing());
+    ASSERT_EQ(1, s.treeCount());
+
+    int visits[50] = {};
+    s.forEach([&](const int& i) { ++visits[i]; });
+
+    for (int i = 0; i < 50; ++i)
+        EXPECT_EQ(1, visits[i]);
+}
+
+
+TEST(HashSetTests, removedElementsAreNoLongerContained)
+{
+    HashSet<std::string> s;
+    s.add("Boo");
+    s.add("is");
+    s.add("happy");
+
+    s.remove("is");
+    EXPECT_EQ(2, s.size());
+    EXPECT_FALSE(s.contains("is"));
+    EXPECT_TRUE(s.contains("Boo"));
+    EXPECT_TRUE(s.contains("happy"));
+
+    s.remove("today");
+    EXPECT_EQ(2, s.size());
+
+    s.add("is");
+    EXPECT_EQ(3, s.size());
+    EXPECT_TRUE(s.contains("is"));
+}
+
+
+TEST(HashSetTests, canRemoveFromListsAndTrees)
+{
+    HashSet<int> s{zeroHash<int>};
+    s.setMinLoadFactor(0.0);
+
+    for (int i = 0; i < 100; ++i)
+        s.add(i);
+
+    ASSERT_EQ(1, s.treeCount());
+
+    for (int i = 0; i < 100; i += 2)
+        s.remove(i);
+
+    EXPECT_EQ(50, s.size());
+    EXPECT_EQ(50, s.elementsAtIndex(0));
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(i % 2 != 0, s.contains(i));
+
+    // A tree that shrinks to half the treeify threshold goes back to being
+    // a list.
+    for (int i = 1; i < 91; i += 2)
+        s.remove(i);
+
+    EXPECT_EQ(5, s.size());
+    EXPECT_EQ(1, s.treeCount());
+
+    s.remove(91);
+    EXPECT_EQ(4, s.size());
+    EXPECT_EQ(0, s.treeCount());
+    EXPECT_EQ(4, s.elementsAtIndex(0));
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(i > 91 && i % 2 != 0, s.contains(i));
+
+    for (int i = 93; i < 100; i += 2)
+        s.remove(i);
+
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(0, s.elementsAtIndex(0));
+}
+
+
+TEST(HashSetTests, canRemoveDuringAnIncrementalResize)
+{
+    HashSet<int> s{identityHash, 1};
+
+    for (int i = 0; i < 11; ++i)
+        s.add(i);
+
+    ASSERT_TRUE(s.isResizing());
+
+    for (int i = 0; i < 11; i += 2)
+        s.remove(i);
+
+    EXPECT_EQ(5, s.size());
+    for (int i = 0; i < 11; ++i)
+        EXPECT_EQ(i % 2 != 0, s.contains(i));
+}
+
+
+TEST(HashSetTests, shrinksWhenEnoughElementsAreRemoved)
+{
+    for (unsigned int migrationBudget : {0u, 16u})
+    {
+        HashSet<int> s{identityHash, migrationBudget};
+
+        for (int i = 0; i < 1000; ++i)
+            s.add(i);
+
+        unsigned int fullCapacity = s.capacity();
+
+        for (int i = 0; i < 990; ++i)
+        {
+            s.remove(i);
+            ASSERT_TRUE(s.contains(999));
+        }
+
+        EXPECT_EQ(10, s.size());
+        EXPECT_LT(s.capacity(), fullCapacity / 4);
+        EXPECT_GE(s.capacity(), HashSet<int>::DEFAULT_CAPACITY);
+
+        for (int i = 990; i < 1000; ++i)
+            EXPECT_TRUE(s.contains(i));
+    }
+}
+
+
+TEST(HashSetTests, doesNotShrinkWithoutAMinLoadFactor)
+{
+    HashSet<int> s{identityHash};
+    s.setMinLoadFactor(0.0);
+
+    for (int i = 0; i < 1000; ++i)
+        s.add(i);
+
+    unsigned int fullCapacity = s.capacity();
+
+    for (int i = 0; i < 1000; ++i)
+        s.remove(i);
+
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(fullCapacity, s.capacity());
+}
+
+
+TEST(HashSetTests, shrinkToFitKeepsEveryElement)
+{
+    HashSet<std::string> s{zeroHash<std::string>, 1};
+    s.setMinLoadFactor(0.0);
+
+    for (int i = 0; i < 200; ++i)
+        s.add(std::to_string(i));
+
+    ASSERT_TRUE(s.isResizing());
+
+    for (int i = 0; i < 190; ++i)
+        s.remove(std::to_string(i));
+
+    s.shrinkToFit();
+    EXPECT_FALSE(s.isResizing());
+    // Holding 10 elements within a load factor of 0.8 takes 13 cells.
+    EXPECT_EQ(13, s.capacity());
+    EXPECT_EQ(10, s.size());
+
+    for (int i = 0; i < 200; ++i)
+        EXPECT_EQ(i >= 190, s.contains(std::to_string(i)));
+
+    s.add("Boo");
+    EXPECT_EQ(11, s.size());
+}
+
+
+TEST(HashSetTests, iteratorsVisitEveryElementOnce)
+{
+    HashSet<int> empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+
+    HashSet<int> s{zeroHash<int>, 1};
+    for (int i = 0; i < 50; ++i)
+        s.add(i);
+
+    // Some elements are in a tree, and some are still in the old array.
+    ASSERT_TRUE(s.isResizing());
+    ASSERT_EQ(1, s.treeCount());
+
+    int visits[50] = {};
+    for (int i : s)
+        ++visits[i];
+
+    for (int i = 0; i < 50; ++i)
+        EXPECT_EQ(1, visits[i]);
+}
+
+
+TEST(HashSetTests, iteratorsWorkWithStandardAlgorithms)
+{
+    HashSet<std::string> s;
+    s.add("Boo");
+    s.add("is");
+    s.add("happy");
+    s.add("today");
+
+    std::vector<std::string> elements(s.begin(), s.end());
+    std::sort(elements.begin(), elements.end());
+    EXPECT_EQ((std::vector<std::string>{"Boo", "happy", "is", "today"}), elements);
+
+    EXPECT_EQ(4, std::distance(s.begin(), s.end()));
+    EXPECT_EQ(2, std::count_if(s.begin(), s.end(), [](const std::string& e) { return e.size() > 3; }));
+    EXPECT_TRUE(std::find(s.begin(), s.end(), "is") != s.end());
+    EXPECT_EQ((*s.begin()).size(), s.begin()->size());
+}
@@ -0,0 +1,85 @@
+// NodePoolTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the NodePool.
+
+#include <string>
+#include <gtest/gtest.h>
+#include "NodePool.hpp"
+
+
+namespace
+{
+    struct Node
+    {
+        std::string key;
+        Node* next;
+
+        Node(const std::string& key, Node* next)
+            : key{key}, next{next}
+        {
+        }
+    };
+}
+
+
+TEST(NodePoolTests, slabsGrowGeometrically)
+{
+    NodePool<Node> pool;
+    EXPECT_EQ(0, pool.slabCount());
+
+    Node* list = nullptr;
+    for (int i = 0; i < 16; ++i)
+        list = pool.create(std::to_string(i), list);
+
+    EXPECT_EQ(1, pool.slabCount());
+
+    // 16 + 32 + 64 + 128 nodes fit in four slabs.
+    for (int i = 16; i < 240; ++i)
+        list = pool.create(std::to_string(i), list);
+
+    EXPECT_EQ(4, pool.slabCount());
+    EXPECT_EQ("239", list->key);
+    EXPECT_EQ("238", list->next->key);
+
+    while (list != nullptr)
+    {
+        Node* next = list->next;
+        pool.discard(list);
+        list = next;
+    }
+
+    pool.release();
+    EXPECT_EQ(0, pool.slabCount());
+}
+
+
+TEST(NodePoolTests, destroyedNodesAreReused)
+{
+    NodePool<Node> pool;
+    Node* first = pool.create("Boo", nullptr);
+    pool.destroy(first);
+
+    Node* second = pool.create("is happy", nullptr);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ("is happy", second->key);
+    EXPECT_EQ(1, pool.slabCount());
+
+    pool.destroy(second);
+}
+
+
+TEST(NodePoolTests, movingKeepsNodesInPlace)
+{
+    NodePool<Node> pool1;
+    Node* node = pool1.create("Boo", nullptr);
+
+    NodePool<Node> pool2{std::move(pool1)};
+    EXPECT_EQ(0, pool1.slabCount());
+    EXPECT_EQ(1, pool2.slabCount());
+    EXPECT_EQ("Boo", node->key);
+
+    pool2.destroy(node);
+}
@@ -0,0 +1,126 @@
+// ReadMostlyHashSetTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the ReadMostlyHashSet, including a stress test with
+// readers running while writers add elements and resize the table.
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ReadMostlyHashSet.hpp"
+
+
+namespace
+{
+    template <typename T>
+    unsigned int zeroHash(const T&)
+    {
+        return 0;
+    }
+
+
+    unsigned int identityHash(const int& i)
+    {
+        return static_cast<unsigned int>(i);
+    }
+}
+
+
+TEST(ReadMostlyHashSetTests, behavesLikeASetOnOneThread)
+{
+    ReadMostlyHashSet<std::string> s{zeroHash<std::string>};
+    Set<std::string>& ss = s;
+    ss.add("Boo");
+    ss.add("is");
+    ss.add("Boo");
+
+    EXPECT_TRUE(ss.isImplemented());
+    EXPECT_EQ(2, ss.size());
+    EXPECT_TRUE(ss.contains("is"));
+    EXPECT_FALSE(ss.contains("happy"));
+    EXPECT_EQ(2, s.elementsAtIndex(0));
+    EXPECT_TRUE(s.isElementAtIndex("Boo", 0));
+    EXPECT_FALSE(s.isElementAtIndex("Boo", 1));
+}
+
+
+TEST(ReadMostlyHashSetTests, oldTablesAreReclaimedAfterResizing)
+{
+    ReadMostlyHashSet<int> s{identityHash};
+
+    for (int i = 0; i < 1000; ++i)
+        s.add(i);
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_GE(s.capacity() * 4, s.size() * 5);
+    EXPECT_LE(s.retiredCount(), 2);
+
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_TRUE(s.isElementAtIndex(i, i % s.capacity()));
+
+    ReadMostlyHashSet<int> copy{s};
+    EXPECT_EQ(1000, copy.size());
+    EXPECT_TRUE(copy.contains(999));
+}
+
+
+TEST(ReadMostlyHashSetTests, readersAndWritersCanRunConcurrently)
+{
+    ReadMostlyHashSet<int> s{identityHash};
+    for (int i = 0; i < 100; ++i)
+        s.add(i);
+
+    constexpr int READER_COUNT = 4;
+    constexpr int WRITER_COUNT = 2;
+    constexpr int PER_WRITER = 20000;
+
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::atomic<int> falsePositives{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < READER_COUNT; ++t)
+    {
+        threads.emplace_back([&]
+        {
+            while (!done.load())
+            {
+                for (int i = 0; i < 100; ++i)
+                {
+                    if (!s.contains(i))
+                        ++misses;
+                    if (s.contains(-1 - i))
+                        ++falsePositives;
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < WRITER_COUNT; ++w)
+    {
+        writers.emplace_back([&s, w]
+        {
+            for (int i = 0; i < PER_WRITER; ++i)
+                s.add(100 + w * PER_WRITER + i);
+        });
+    }
+
+    for (std::thread& writer : writers)
+        writer.join();
+
+    done.store(true);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(0, misses.load());
+    EXPECT_EQ(0, falsePositives.load());
+    EXPECT_EQ(100 + WRITER_COUNT * PER_WRITER, s.size());
+
+    for (int i = 0; i < 100 + WRITER_COUNT * PER_WRITER; ++i)
+        ASSERT_TRUE(s.contains(i));
+}
@@ -0,0 +1,113 @@
+// WordCheckerTests.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Unit tests for the WordChecker beyond the sanity checks, covering each
+// of the ways that suggestions are generated.
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AVLSet.hpp"
+#include "BloomFilter.hpp"
+#include "HashSet.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    unsigned int stringHash(const std::string& s)
+    {
+        unsigned int hash = 0;
+        for (char c : s)
+            hash = hash * 31 + static_cast<unsigned char>(c);
+        return hash;
+    }
+
+
+    std::vector<std::string> suggestionsFor(const std::string& word, const std::vector<std::string>& dictionary)
+    {
+        AVLSet<std::string> set;
+        for (const std::string& w : dictionary)
+            set.add(w);
+
+        WordChecker checker{set};
+        return checker.findSuggestions(word);
+    }
+}
+
+
+TEST(WordCheckerTests, suggestsEachKindOfEdit)
+{
+    std::vector<std::string> suggestions = suggestionsFor(
+        "HELO", {"EHLO", "HELLO", "HEL", "HALO", "HE", "LO", "ZZZ"});
+
+    std::vector<std::string> expected{"EHLO", "HELLO", "HEL", "HALO", "HE LO"};
+    EXPECT_EQ(expected, suggestions);
+}
+
+
+TEST(WordCheckerTests, suggestionsAreNotRepeated)
+{
+    // Inserting an L either before or after the existing one gives HELLO.
+    std::vector<std::string> suggestions = suggestionsFor("HELO", {"HELLO"});
+
+    ASSERT_EQ(1, suggestions.size());
+    EXPECT_EQ("HELLO", suggestions[0]);
+}
+
+
+TEST(WordCheckerTests, handlesVeryShortWords)
+{
+    EXPECT_TRUE(suggestionsFor("", {"ZZZ"}).empty());
+
+    std::vector<std::string> suggestions = suggestionsFor("A", {"AN", "I"});
+    std::vector<std::string> expected{"AN", "I"};
+    EXPECT_EQ(expected, suggestions);
+}
+
+
+TEST(WordCheckerTests, batchLookupsGiveTheSameSuggestions)
+{
+    std::vector<std::string> dictionary{
+        "EHLO", "HELLO", "HEL", "HALO", "HE", "LO", "HELP", "HOLE", "HELD"};
+
+    AVLSet<std::string> tree;
+    HashSet<std::string> table{stringHash};
+    for (const std::string& w : dictionary)
+    {
+        tree.add(w);
+        table.add(w);
+    }
+
+    WordChecker one{tree};
+    WordChecker many{table};
+
+    for (const char* word : {"HELO", "HLEP", "HOEL", "HELPLO", "X", ""})
+        EXPECT_EQ(one.findSuggestions(word), many.findSuggestions(word));
+}
+
+
+TEST(WordCheckerTests, bloomFilterGivesTheSameSuggestions)
+{
+    std::vector<std::string> dictionary{
+        "EHLO", "HELLO", "HEL", "HALO", "HE", "LO", "HELP", "HOLE", "HELD"};
+
+    AVLSet<std::string> tree;
+    for (const std::string& w : dictionary)
+        tree.add(w);
+
+    BloomFilter filter{dictionary.begin(), dictionary.end()};
+
+    WordChecker unfiltered{tree};
+    WordChecker filtered{tree, filter};
+
+    for (const std::string& word : dictionary)
+        EXPECT_TRUE(filtered.wordExists(word));
+
+    EXPECT_FALSE(filtered.wordExists("HELO"));
+
+    for (const char* word : {"HELO", "HLEP", "HOEL", "HELPLO", "X", ""})
+        EXPECT_EQ(unfiltered.findSuggestions(word), filtered.findSuggestions(word));
+}
@@ -0,0 +1,56 @@
+// main.cpp
+//
+// ICS 46 Winter 2019
+// Project #3: Set the Controls for the Heart of the Sun
+//
+// Writes a dictionary image: reads a word list (one word per line) and
+// saves it as a FrozenHashSet image, which a program can then load with
+// FrozenHashSet::mapImage() instead of building its own set of words.
+//
+//     tool WORDLIST IMAGE
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "FrozenHashSet.hpp"
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout << "usage: " << argv[0] << " WORDLIST IMAGE" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in{argv[1]};
+    if (!in)
+    {
+        std::cout << "ERROR: Cannot open word list " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> words;
+    std::string word;
+    while (std::getline(in, word))
+    {
+        if (!word.empty() && word.back() == '\r')
+            word.pop_back();
+
+        if (!word.empty())
+            words.push_back(word);
+    }
+
+    FrozenHashSet dictionary{words.begin(), words.end()};
+
+    if (!dictionary.saveImage(argv[2]))
+    {
+        std::cout << "ERROR: Cannot write image " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << dictionary.size() << " words, " << dictionary.memoryUsage()
+              << " bytes, written to " << argv[2] << std::endl;
+    return 0;
+}